@@ -0,0 +1,112 @@
+/*
+ * C interface for datepp.
+ *
+ * Stable ABI for calling datepp from C and through FFI (Go, Rust, ...).
+ * Formats and time zones are compiled once into opaque handles, and the batch functions
+ * work on caller-provided arrays, so the cost of crossing the language boundary is paid once per batch.
+ *
+ * The implementation lives in `datepp.hpp`. The CMake project builds it into libdatepp.so / libdatepp.a
+ * (src/datepp.cpp); without CMake, build it into a library with:
+ *
+ *     // datepp_c.cpp
+ *     #define DATEPP_C_API
+ *     #include "datepp.hpp"
+ *
+ *     $ g++ -std=c++11 -O2 -shared -fPIC datepp_c.cpp -o libdatepp.so
+ *
+ * No function throws or keeps pointers to the arrays it's given.
+ * Handles are immutable after creation and can be shared between threads.
+ */
+
+#ifndef DATEPP_H
+#define DATEPP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DATEPP_ABI_VERSION 2
+
+typedef struct datepp_format datepp_format;
+typedef struct datepp_zone datepp_zone;
+
+typedef enum datepp_status {
+    DATEPP_OK = 0,
+    DATEPP_INVALID_ARGUMENT = 1,
+    DATEPP_BUFFER_TOO_SMALL = 2,
+    DATEPP_PARSE_ERROR = 3,
+    DATEPP_OUT_OF_MEMORY = 4,
+    DATEPP_ZONE_NOT_FOUND = 5
+} datepp_status;
+
+/*
+ * Months and days are zero-based (January = 0, first day = 0), like in the C++ API.
+ */
+typedef struct datepp_fields {
+    int64_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t dotw;      /* 0 = Sunday, ..., 6 = Saturday */
+    double utc_offset; /* In hours */
+} datepp_fields;
+
+/* Returns DATEPP_ABI_VERSION of the library, to check it against the header at runtime. */
+uint32_t datepp_abi_version(void);
+
+/* `pattern` uses the same syntax as `beliumgl::DateTimeFormat`. */
+datepp_status datepp_format_create(const char* pattern, datepp_format** out);
+void datepp_format_destroy(datepp_format* format);
+
+/* Fixed UTC offset in hours, up to 99 either way. */
+datepp_status datepp_zone_create_fixed(double utc_offset, datepp_zone** out);
+/*
+ * Zone `name` of the IANA database (e.g. "Europe/Berlin"), read from the directory in $TZDIR or /usr/share/zoneinfo.
+ * Returns DATEPP_ZONE_NOT_FOUND if the file is missing or isn't valid TZif data.
+ */
+datepp_status datepp_zone_create_named(const char* name, datepp_zone** out);
+/* Contents of a TZif file (RFC 8536), e.g. embedded in the program. `name` may be NULL. */
+datepp_status datepp_zone_create_tzif(const char* name, const void* data, size_t size, datepp_zone** out);
+void datepp_zone_destroy(datepp_zone* zone);
+
+/*
+ * `zone` may be NULL for UTC. With a named zone, sorted timestamps are converted fastest:
+ * every run between two transitions of the zone gets one offset.
+ */
+datepp_status datepp_decompose_batch(const datepp_zone* zone, const int64_t* unix_times, size_t count,
+                                     datepp_fields* out);
+
+/*
+ * Formats `count` timestamps back to back into `buffer`, each one null-terminated;
+ * `offsets[i]` receives the position of the i-th string.
+ *
+ * `*written` receives how many timestamps were formatted. If `buffer` is full,
+ * DATEPP_BUFFER_TOO_SMALL is returned and the call can be repeated for the rest of the input.
+ */
+datepp_status datepp_format_batch(const datepp_format* format, const datepp_zone* zone,
+                                  const int64_t* unix_times, size_t count,
+                                  char* buffer, size_t buffer_size, size_t* offsets, size_t* written);
+
+/*
+ * Parses `count` strings produced with `format`. String i is `data[offsets[i]]..data[offsets[i + 1]]`,
+ * so `offsets` has `count + 1` elements (the layout of Arrow string columns).
+ * `zone` (may be NULL for UTC) is used for strings without a UTC offset. In a named zone, local times
+ * repeated by a transition get the offset in effect before it, and skipped ones are moved forward by the gap.
+ *
+ * Strings that fail to parse get 0 in `out` and 0 in `ok` (which may be NULL), and
+ * DATEPP_PARSE_ERROR is returned after the whole batch is processed.
+ */
+datepp_status datepp_parse_batch(const datepp_format* format, const datepp_zone* zone,
+                                 const char* data, const size_t* offsets, size_t count,
+                                 int64_t* out, uint8_t* ok);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,9 +12,202 @@
 #include <string>
 #include <stdexcept>
 #include <array>
-#include <unordered_map>
-#include <unordered_set>
 #include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <iterator>
+#include <ctime>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+// Only the out-of-line implementations read files and print with "%f".
+#if !defined(DATEPP_SEPARATE_COMPILATION) || defined(DATEPP_IMPLEMENTATION)
+#include <cstdio>
+#endif
+
+/*
+ * By default the library is header-only: everything is `inline`, so the header can be included
+ * from any number of translation units.
+ *
+ * Heavier functions (constructors, `toString`, format parsing, ...) can be compiled once instead:
+ * define `DATEPP_SEPARATE_COMPILATION` everywhere (e.g. with `-DDATEPP_SEPARATE_COMPILATION`),
+ * and additionally `DATEPP_IMPLEMENTATION` in exactly one translation unit:
+ *
+ *     // datepp.cpp
+ *     #define DATEPP_IMPLEMENTATION
+ *     #include "datepp.hpp"
+ *     #include "datepp_leapseconds.hpp" // If LeapSecondTable or TimeZone is used
+ *     #include "datepp_zones.hpp"
+ *
+ * The calendar core, the formatting engine, accessors and operators stay in the header either way,
+ * so they can still be inlined (build with `-flto` to inline the rest too).
+ */
+#ifdef DATEPP_SEPARATE_COMPILATION
+#define DATEPP_DECL
+#else
+#define DATEPP_DECL inline
+#endif
+
+/*
+ * ---------------
+ * INSTRUMENTATION
+ * ---------------
+ *
+ * Define `DATEPP_INSTRUMENTATION` (for the whole project) to count what the library does:
+ * DateTime constructions (with the distance of the converted year from 1970), format pattern parses,
+ * `toString` calls and heap allocations made by the library, plus latency histograms
+ * of those operations, measured on every `DATEPP_INSTRUMENTATION_SAMPLE_RATE`-th call of each thread.
+ *
+ * Read the numbers with `beliumgl::instrumentation::snapshot()`. Without the macro,
+ * the hooks expand to nothing.
+ */
+#ifdef DATEPP_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+
+#ifndef DATEPP_INSTRUMENTATION_SAMPLE_RATE
+#define DATEPP_INSTRUMENTATION_SAMPLE_RATE 64
+#endif
+
+namespace beliumgl {
+    namespace instrumentation {
+        enum class Counter { DateTimeConstructions, FormatParses, ToStringCalls, HeapAllocations };
+        enum class Histogram { DateTimeConstruction, FormatParse, ToString };
+
+        constexpr size_t counterCount = 4;
+        constexpr size_t histogramCount = 3;
+        // Distance of the year from 1970: < 1, < 10, < 100, < 1000 and >= 1000 years.
+        constexpr size_t yearDistanceBuckets = 5;
+        // Bucket i counts samples which took [2^i, 2^(i + 1)) nanoseconds.
+        constexpr size_t histogramBuckets = 32;
+
+        struct Snapshot {
+            unsigned long long counters[counterCount] = {};
+            unsigned long long parseUnixByYearDistance[yearDistanceBuckets] = {};
+            unsigned long long histograms[histogramCount][histogramBuckets] = {};
+
+            unsigned long long get(Counter counter) const { return this->counters[static_cast<size_t>(counter)]; }
+            const unsigned long long* get(Histogram histogram) const { return this->histograms[static_cast<size_t>(histogram)]; }
+        };
+
+        struct State {
+            std::atomic<unsigned long long> counters[counterCount];
+            std::atomic<unsigned long long> parseUnixByYearDistance[yearDistanceBuckets];
+            std::atomic<unsigned long long> histograms[histogramCount][histogramBuckets];
+        };
+
+        inline State& state() {
+            static State instance{};
+            return instance;
+        }
+
+        inline void count(Counter counter) {
+            state().counters[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        inline void countParseUnix(long long year) {
+            long long distance = year >= 1970 ? year - 1970 : 1970 - year;
+            size_t bucket = distance < 1 ? 0 : distance < 10 ? 1 : distance < 100 ? 2 : distance < 1000 ? 3 : 4;
+            state().parseUnixByYearDistance[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Counts the string as an allocation if it doesn't fit into the small string buffer.
+        inline void countString(const std::string& str) {
+            if (str.capacity() > std::string().capacity())
+                count(Counter::HeapAllocations);
+        }
+
+        class ScopedTimer {
+        public:
+            explicit ScopedTimer(Histogram histogram) : histogram(histogram) {
+                static thread_local unsigned calls = 0;
+                this->sampled = ++calls % DATEPP_INSTRUMENTATION_SAMPLE_RATE == 0;
+                if (this->sampled)
+                    this->start = std::chrono::steady_clock::now();
+            }
+
+            ~ScopedTimer() {
+                if (!this->sampled)
+                    return;
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->start).count();
+                size_t bucket = 0;
+                while (bucket + 1 < histogramBuckets && (1LL << (bucket + 1)) <= elapsed)
+                    ++bucket;
+                state().histograms[static_cast<size_t>(this->histogram)][bucket].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+        private:
+            Histogram histogram;
+            bool sampled;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        inline Snapshot snapshot() {
+            Snapshot result;
+            State& current = state();
+            for (size_t i = 0; i < counterCount; ++i)
+                result.counters[i] = current.counters[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < yearDistanceBuckets; ++i)
+                result.parseUnixByYearDistance[i] = current.parseUnixByYearDistance[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < histogramCount; ++i)
+                for (size_t j = 0; j < histogramBuckets; ++j)
+                    result.histograms[i][j] = current.histograms[i][j].load(std::memory_order_relaxed);
+            return result;
+        }
+
+        inline void reset() {
+            State& current = state();
+            for (auto& counter : current.counters) counter.store(0, std::memory_order_relaxed);
+            for (auto& counter : current.parseUnixByYearDistance) counter.store(0, std::memory_order_relaxed);
+            for (auto& histogram : current.histograms)
+                for (auto& counter : histogram) counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#define DATEPP_COUNT(counter) ::beliumgl::instrumentation::count(::beliumgl::instrumentation::Counter::counter)
+#define DATEPP_COUNT_PARSE_UNIX(year) ::beliumgl::instrumentation::countParseUnix(year)
+#define DATEPP_COUNT_STRING(str) ::beliumgl::instrumentation::countString(str)
+#define DATEPP_TIME(histogram) ::beliumgl::instrumentation::ScopedTimer datepp_timer_(::beliumgl::instrumentation::Histogram::histogram)
+#else
+#define DATEPP_COUNT(counter) ((void)0)
+#define DATEPP_COUNT_PARSE_UNIX(year) ((void)0)
+#define DATEPP_COUNT_STRING(str) ((void)0)
+#define DATEPP_TIME(histogram) ((void)0)
+#endif
+
+/*
+ * Allocation accounting: define `DATEPP_ALLOCATION_TRACKING` in exactly one translation unit
+ * to replace the global `operator new` / `operator delete` with versions that count allocations
+ * per thread. AllocationScope then tells how many allocations a piece of code made, e.g.:
+ *
+ *     beliumgl::instrumentation::AllocationScope scope;
+ *     format.toString(...);
+ *     assert(scope.allocations() == 0);
+ *
+ * Without the replacement operators, the count stays 0.
+ */
+namespace beliumgl {
+    namespace instrumentation {
+        inline unsigned long long& threadAllocations() {
+            static thread_local unsigned long long allocations = 0;
+            return allocations;
+        }
+
+        class AllocationScope {
+        public:
+            AllocationScope() : start(threadAllocations()) {}
+            unsigned long long allocations() const { return threadAllocations() - this->start; }
+        private:
+            unsigned long long start;
+        };
+    }
+}
 
 /*
  * Because the `unsigned char` type is not commonly used,
@@ -32,6 +225,487 @@ using timezone_offset_t = double;
 using year_t = short;
 
 namespace beliumgl {
+    /*
+     * -------------
+     * CALENDAR CORE
+     * -------------
+     *
+     * Conversions between "days since 01.01.1970" and civil dates in O(1)
+     * (no loops over years or months), based on the proleptic Gregorian calendar.
+     * The calendar repeats every 400 years (146097 days), so every date is split into
+     * an era and a day of that era.
+     *
+     * Like the rest of the library, months and days are zero-based (January = 0, first day = 0).
+     * Years are `long long` here, so the core never overflows; DateTime narrows them to `year_t`.
+     *
+     * Everything here (except the output-parameter `civilFromDays`) is `constexpr`, even in C++11,
+     * so it can build compile-time tables and be checked with `static_assert`, e.g.:
+     *
+     *     static_assert(beliumgl::daysFromCivil(2000, 0, 0) == 10957, "");
+     *     static_assert(beliumgl::civilDateFromDays(10957).year == 2000, "");
+     *     static_assert(beliumgl::weekdayFromDays(0) == 4, "");
+     */
+    struct CivilDate {
+        long long year;
+        month_t month;
+        day_t day;
+    };
+
+    // Steps of the conversions, split into single expressions for C++11 `constexpr`.
+    namespace detail {
+        constexpr long long eraOfYear(long long year) {
+            return (year >= 0 ? year : year - 399) / 400;
+        }
+
+        constexpr long long eraOfDays(long long days) {
+            return (days >= 0 ? days : days - 146096) / 146097;
+        }
+
+        // `year` starts in March (so January and February belong to the previous year).
+        constexpr long long daysFromMarchYear(long long year, long long era, unsigned dayOfYear) {
+            return era * 146097 + static_cast<long long>(static_cast<unsigned>(year - era * 400) * 365
+                 + static_cast<unsigned>(year - era * 400) / 4 - static_cast<unsigned>(year - era * 400) / 100 + dayOfYear) - 719468;
+        }
+
+        constexpr unsigned yearOfEra(unsigned dayOfEra) {
+            return (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        }
+
+        constexpr CivilDate civilFromMarchMonth(long long year, unsigned marchMonth, unsigned dayOfYear) {
+            return CivilDate{year + (marchMonth >= 10),
+                             static_cast<month_t>(marchMonth < 10 ? marchMonth + 2 : marchMonth - 10),
+                             static_cast<day_t>(dayOfYear - (153 * marchMonth + 2) / 5)};
+        }
+
+        constexpr CivilDate civilFromDayOfYear(long long year, unsigned dayOfYear) {
+            return civilFromMarchMonth(year, (5 * dayOfYear + 2) / 153, dayOfYear);
+        }
+
+        constexpr CivilDate civilFromYearOfEra(long long era, unsigned dayOfEra, unsigned yearOfEra) {
+            return civilFromDayOfYear(static_cast<long long>(yearOfEra) + era * 400,
+                                      dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100));
+        }
+
+        constexpr CivilDate civilFromShiftedDays(long long days, long long era) {
+            return civilFromYearOfEra(era, static_cast<unsigned>(days - era * 146097),
+                                      yearOfEra(static_cast<unsigned>(days - era * 146097)));
+        }
+    }
+
+    constexpr long long daysFromCivil(long long year, month_t month, day_t day) {
+        return detail::daysFromMarchYear(year - (month <= 1), detail::eraOfYear(year - (month <= 1)),
+                                         (153u * (month > 1 ? month - 2u : month + 10u) + 2) / 5 + day);
+    }
+
+    constexpr CivilDate civilDateFromDays(long long days) {
+        return detail::civilFromShiftedDays(days + 719468, detail::eraOfDays(days + 719468));
+    }
+
+    inline void civilFromDays(long long days, long long& year, month_t& month, day_t& day) {
+        const CivilDate date = civilDateFromDays(days);
+        year = date.year;
+        month = date.month;
+        day = date.day;
+    }
+
+    constexpr bool isLeapYear(long long year) {
+        return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+    }
+
+    // 31 for even months until July and odd months from August.
+    constexpr day_t daysInMonth(long long year, month_t month) {
+        return month == 1 ? (isLeapYear(year) ? 29 : 28) : static_cast<day_t>(30 + (month + (month >= 7) + 1) % 2);
+    }
+
+    // 0 = Sunday, ..., 6 = Saturday (01.01.1970 was a Thursday).
+    constexpr unsigned char weekdayFromDays(long long days) {
+        return static_cast<unsigned char>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+    }
+
+    inline const char* dotwName(unsigned char dotw) {
+        static const char* const names[7] = {
+            "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+        };
+        return names[dotw];
+    }
+
+    inline const char* monthName(month_t month) {
+        static const char* const names[12] = {
+            "January", "February", "March", "April", "May", "June",
+            "July", "August", "September", "October", "November", "December"
+        };
+        return names[month];
+    }
+
+    /*
+     * -----------
+     * EPOCH BASES
+     * -----------
+     *
+     * Conversions from other epochs and time scales to unix timestamps (and back).
+     * Integer inputs are converted exactly (results are floored to whole seconds);
+     * fractional days (Excel, Julian Day) are rounded to the nearest second.
+     *
+     * Each conversion also has a batch form working on arrays, which compiles into simple
+     * loops the compiler can vectorize; the results can be passed straight to `decompose`.
+     */
+    constexpr long long ntpEpochOffset = 2208988800LL;        // 01.01.1900
+    constexpr long long gpsEpochOffset = 315964800LL;         // 06.01.1980
+    constexpr long long fileTimeEpochOffset = 11644473600LL;  // 01.01.1601
+    constexpr long long fileTimeTicksPerSecond = 10000000LL;  // 100 ns ticks
+    constexpr long long excelEpochDays = 25569LL;             // Days between 30.12.1899 and 01.01.1970
+    constexpr double julianDayEpoch = 2440587.5;              // Julian Day of 01.01.1970 00:00:00
+
+    constexpr long long floorDiv(long long a, long long b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    // `std::floor` and `std::llround` for values that fit a long long, without <cmath>.
+    namespace detail {
+        inline long long floorToInteger(double value) {
+            long long result = static_cast<long long>(value);
+            return value < static_cast<double>(result) ? result - 1 : result;
+        }
+
+        // Halfway cases are rounded away from zero.
+        inline long long roundToInteger(double value) {
+            long long result = static_cast<long long>(value);
+            if (value - static_cast<double>(result) >= 0.5) ++result;
+            else if (static_cast<double>(result) - value >= 0.5) --result;
+            return result;
+        }
+    }
+
+    /*
+     * NTP timestamps: 32 bits of seconds since 1900 and 32 bits of fraction.
+     * As recommended by RFC 4330, seconds with the highest bit clear are in the next era (from 2036),
+     * so timestamps between 1968 and 2104 are supported.
+     */
+    inline long long ntpToUnix(unsigned long long ntp) {
+        unsigned long long seconds = ntp >> 32;
+        long long era = (seconds & 0x80000000ULL) ? 0 : 1;
+        return static_cast<long long>(seconds) + (era << 32) - ntpEpochOffset;
+    }
+
+    inline unsigned long long unixToNtp(long long _unix) {
+        return static_cast<unsigned long long>(_unix + ntpEpochOffset) << 32;
+    }
+
+    /*
+     * GPS time: continuous seconds since 06.01.1980, or weeks and seconds of the week.
+     * Leap seconds are not applied here (GPS time is ahead of UTC by the leap seconds inserted since 1980).
+     */
+    inline long long gpsToUnix(long long gps) {
+        return gps + gpsEpochOffset;
+    }
+
+    inline long long gpsToUnix(long long week, long long secondsOfWeek) {
+        return week * 604800 + secondsOfWeek + gpsEpochOffset;
+    }
+
+    inline long long unixToGps(long long _unix) {
+        return _unix - gpsEpochOffset;
+    }
+
+    // Windows FILETIME: 100 ns ticks since 01.01.1601. The remaining nanoseconds can be stored in `nanoseconds`.
+    inline long long fileTimeToUnix(long long ticks, long long* nanoseconds = nullptr) {
+        long long seconds = floorDiv(ticks, fileTimeTicksPerSecond);
+        if (nanoseconds != nullptr)
+            *nanoseconds = (ticks - seconds * fileTimeTicksPerSecond) * 100;
+        return seconds - fileTimeEpochOffset;
+    }
+
+    inline long long unixToFileTime(long long _unix, long long nanoseconds = 0) {
+        return (_unix + fileTimeEpochOffset) * fileTimeTicksPerSecond + nanoseconds / 100;
+    }
+
+    /*
+     * Excel serial dates (the 1900 date system): days since 30.12.1899 with the time as the fraction.
+     * Excel counts the nonexistent 29.02.1900 (serial 60), so serials below 61 are shifted by one day
+     * to match what Excel shows; serial 60 itself becomes 01.03.1900.
+     */
+    inline long long excelToUnix(double serial) {
+        long long wholeDays = detail::floorToInteger(serial);
+        long long seconds = detail::roundToInteger((serial - static_cast<double>(wholeDays)) * 86400.0);
+        if (wholeDays < 61)
+            wholeDays += 1;
+        return (wholeDays - excelEpochDays) * 86400 + seconds;
+    }
+
+    inline double unixToExcel(long long _unix) {
+        long long days = floorDiv(_unix, 86400) + excelEpochDays;
+        double fraction = static_cast<double>(_unix - floorDiv(_unix, 86400) * 86400) / 86400.0;
+        if (days < 61)
+            days -= 1;
+        return static_cast<double>(days) + fraction;
+    }
+
+    // Julian Day (days since noon of 01.01.4713 BC, Julian calendar) and Modified Julian Day (days since 17.11.1858).
+    inline long long julianDayToUnix(double julianDay) {
+        return detail::roundToInteger((julianDay - julianDayEpoch) * 86400.0);
+    }
+
+    inline double unixToJulianDay(long long _unix) {
+        return static_cast<double>(_unix) / 86400.0 + julianDayEpoch;
+    }
+
+    inline long long modifiedJulianDayToUnix(double modifiedJulianDay) {
+        return detail::roundToInteger((modifiedJulianDay - 40587.0) * 86400.0);
+    }
+
+    inline void ntpToUnix(const unsigned long long* ntp, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = ntpToUnix(ntp[i]);
+    }
+
+    inline void gpsToUnix(const long long* gps, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = gps[i] + gpsEpochOffset;
+    }
+
+    inline void fileTimeToUnix(const long long* ticks, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = fileTimeToUnix(ticks[i]);
+    }
+
+    inline void excelToUnix(const double* serials, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = excelToUnix(serials[i]);
+    }
+
+    inline void julianDayToUnix(const double* julianDays, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = julianDayToUnix(julianDays[i]);
+    }
+
+    /*
+     * ------------------
+     * LIBC COMPATIBILITY
+     * ------------------
+     *
+     * Allocation- and lock-free equivalents of `gmtime_r`, `timegm` and `strftime`
+     * built on the calendar core. They are used by the LD_PRELOAD shim (see `DATEPP_LIBC_SHIM`
+     * at the end of this file), but can be called directly as well.
+     */
+
+    // Same as `gmtime_r`. Returns false if the year doesn't fit into `tm_year`.
+    inline bool unixToTm(long long _unix, std::tm& out) {
+        constexpr int secondsInDay = 86400;
+
+        long long days = _unix / secondsInDay;
+        int remainderSeconds = static_cast<int>(_unix % secondsInDay);
+        if (remainderSeconds < 0) {
+            remainderSeconds += secondsInDay;
+            days -= 1;
+        }
+
+        long long year;
+        month_t month;
+        day_t day;
+        civilFromDays(days, year, month, day);
+        if (year - 1900 > std::numeric_limits<int>::max() || year - 1900 < std::numeric_limits<int>::min())
+            return false;
+
+        out.tm_year = static_cast<int>(year - 1900);
+        out.tm_mon = month;
+        out.tm_mday = day + 1;
+        out.tm_hour = remainderSeconds / 3600;
+        out.tm_min = remainderSeconds / 60 % 60;
+        out.tm_sec = remainderSeconds % 60;
+        out.tm_wday = weekdayFromDays(days);
+        out.tm_yday = static_cast<int>(days - daysFromCivil(year, 0, 0));
+        out.tm_isdst = 0;
+#if defined(__GLIBC__) && defined(__USE_MISC)
+        out.tm_gmtoff = 0;
+        out.tm_zone = "GMT";
+#endif
+        return true;
+    }
+
+    // Same as `timegm`: out-of-range fields are allowed and `tm` is normalized in place.
+    inline long long tmToUnix(std::tm& tm) {
+        long long year = 1900LL + tm.tm_year + tm.tm_mon / 12;
+        int month = tm.tm_mon % 12;
+        if (month < 0) {
+            month += 12;
+            year -= 1;
+        }
+
+        long long days = daysFromCivil(year, static_cast<month_t>(month), 0) + tm.tm_mday - 1;
+        long long result = days * 86400 + tm.tm_hour * 3600LL + tm.tm_min * 60LL + tm.tm_sec;
+        if (!unixToTm(result, tm))
+            throw std::overflow_error("Year doesn't fit into `tm_year`.");
+        return result;
+    }
+
+    /*
+     * Same as `strftime` in the "C" locale.
+     *
+     * Only conversions whose output doesn't depend on the locale or on the local time zone are handled;
+     * names (%a, %b, %p, ...) are handled too if `DATEPP_SHIM_ASSUME_C_LOCALE` is defined.
+     * Flags, field widths, E/O modifiers, %s and years outside of 1000..9999 aren't supported.
+     *
+     * Returns the length of the result like `strftime` does (0 if it doesn't fit),
+     * or `static_cast<size_t>(-1)` if the format or `tm` isn't supported, so the caller can fall back to libc.
+     */
+    inline size_t formatTm(char* buffer, size_t size, const char* format, const std::tm& tm) {
+        constexpr size_t unsupported = static_cast<size_t>(-1);
+        const long long year = 1900LL + tm.tm_year;
+        if (year < 1000 || year > 9999 || tm.tm_mon < 0 || tm.tm_mon > 11 || tm.tm_wday < 0 || tm.tm_wday > 6
+            || tm.tm_yday < 0 || tm.tm_yday > 365 || tm.tm_mday < 1 || tm.tm_mday > 31
+            || tm.tm_hour < 0 || tm.tm_hour > 23 || tm.tm_min < 0 || tm.tm_min > 59 || tm.tm_sec < 0 || tm.tm_sec > 60)
+            return unsupported;
+
+        size_t length = 0;
+        bool overflow = false;
+        auto put = [&](char c) {
+            if (length + 1 < size) buffer[length] = c;
+            else overflow = true;
+            ++length;
+        };
+        auto putNumber = [&](long long num, int width, char pad) {
+            char digits[20];
+            int count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + num % 10);
+                num /= 10;
+            } while (num > 0);
+            for (int i = count; i < width; ++i) put(pad);
+            while (count > 0) put(digits[--count]);
+        };
+        auto putString = [&](const char* str, size_t n) {
+            for (size_t i = 0; i < n && str[i] != '\0'; ++i) put(str[i]);
+        };
+
+        // ISO 8601 week-based year and week number (%G, %g, %V).
+        auto isoWeek = [&](long long& isoYear) {
+            int isoWday = (tm.tm_wday + 6) % 7; // Monday = 0
+            int week = (tm.tm_yday - isoWday + 10) / 7;
+            isoYear = year;
+            if (week < 1) {
+                isoYear -= 1;
+                long long prevDays = daysFromCivil(year, 0, 0) - daysFromCivil(isoYear, 0, 0);
+                week = static_cast<int>((tm.tm_yday + prevDays - isoWday + 10) / 7);
+            } else if (week == 53) {
+                long long daysInYear = daysFromCivil(year + 1, 0, 0) - daysFromCivil(year, 0, 0);
+                if (tm.tm_yday - isoWday + 3 >= daysInYear) {
+                    isoYear += 1;
+                    week = 1;
+                }
+            }
+            return week;
+        };
+
+        for (const char* c = format; *c != '\0'; ++c) {
+            if (*c != '%') {
+                put(*c);
+                continue;
+            }
+
+            int hours12 = tm.tm_hour % 12 == 0 ? 12 : tm.tm_hour % 12;
+            long long isoYear;
+            switch (*++c) {
+                case 'Y': putNumber(year, 0, '0'); break;
+                case 'C': putNumber(year / 100, 2, '0'); break;
+                case 'y': putNumber(year % 100, 2, '0'); break;
+                case 'm': putNumber(tm.tm_mon + 1, 2, '0'); break;
+                case 'd': putNumber(tm.tm_mday, 2, '0'); break;
+                case 'e': putNumber(tm.tm_mday, 2, ' '); break;
+                case 'j': putNumber(tm.tm_yday + 1, 3, '0'); break;
+                case 'H': putNumber(tm.tm_hour, 2, '0'); break;
+                case 'k': putNumber(tm.tm_hour, 2, ' '); break;
+                case 'I': putNumber(hours12, 2, '0'); break;
+                case 'l': putNumber(hours12, 2, ' '); break;
+                case 'M': putNumber(tm.tm_min, 2, '0'); break;
+                case 'S': putNumber(tm.tm_sec, 2, '0'); break;
+                case 'u': putNumber(tm.tm_wday == 0 ? 7 : tm.tm_wday, 1, '0'); break;
+                case 'w': putNumber(tm.tm_wday, 1, '0'); break;
+                case 'U': putNumber((tm.tm_yday + 7 - tm.tm_wday) / 7, 2, '0'); break;
+                case 'W': putNumber((tm.tm_yday + 7 - (tm.tm_wday + 6) % 7) / 7, 2, '0'); break;
+                case 'V': putNumber(isoWeek(isoYear), 2, '0'); break;
+                case 'G': isoWeek(isoYear); putNumber(isoYear, 0, '0'); break;
+                case 'g': isoWeek(isoYear); putNumber(isoYear % 100, 2, '0'); break;
+                case 'D':
+                    putNumber(tm.tm_mon + 1, 2, '0'); put('/');
+                    putNumber(tm.tm_mday, 2, '0'); put('/');
+                    putNumber(year % 100, 2, '0');
+                    break;
+                case 'F':
+                    putNumber(year, 0, '0'); put('-');
+                    putNumber(tm.tm_mon + 1, 2, '0'); put('-');
+                    putNumber(tm.tm_mday, 2, '0');
+                    break;
+                case 'R':
+                case 'T':
+                    putNumber(tm.tm_hour, 2, '0'); put(':');
+                    putNumber(tm.tm_min, 2, '0');
+                    if (*c == 'T') {
+                        put(':');
+                        putNumber(tm.tm_sec, 2, '0');
+                    }
+                    break;
+                case 'n': put('\n'); break;
+                case 't': put('\t'); break;
+                case '%': put('%'); break;
+#if defined(__GLIBC__) && defined(__USE_MISC)
+                case 'z': {
+                    long offset = tm.tm_gmtoff;
+                    put(offset < 0 ? '-' : '+');
+                    if (offset < 0) offset = -offset;
+                    putNumber(offset / 3600, 2, '0');
+                    putNumber(offset / 60 % 60, 2, '0');
+                    break;
+                }
+                case 'Z':
+                    if (tm.tm_zone == nullptr) return unsupported;
+                    putString(tm.tm_zone, static_cast<size_t>(-1));
+                    break;
+#endif
+#ifdef DATEPP_SHIM_ASSUME_C_LOCALE
+                case 'a': putString(dotwName(static_cast<unsigned char>(tm.tm_wday)), 3); break;
+                case 'A': putString(dotwName(static_cast<unsigned char>(tm.tm_wday)), static_cast<size_t>(-1)); break;
+                case 'b':
+                case 'h': putString(monthName(static_cast<month_t>(tm.tm_mon)), 3); break;
+                case 'B': putString(monthName(static_cast<month_t>(tm.tm_mon)), static_cast<size_t>(-1)); break;
+                case 'p': putString(tm.tm_hour < 12 ? "AM" : "PM", 2); break;
+                case 'P': putString(tm.tm_hour < 12 ? "am" : "pm", 2); break;
+                case 'c':
+                    putString(dotwName(static_cast<unsigned char>(tm.tm_wday)), 3); put(' ');
+                    putString(monthName(static_cast<month_t>(tm.tm_mon)), 3); put(' ');
+                    putNumber(tm.tm_mday, 2, ' '); put(' ');
+                    putNumber(tm.tm_hour, 2, '0'); put(':');
+                    putNumber(tm.tm_min, 2, '0'); put(':');
+                    putNumber(tm.tm_sec, 2, '0'); put(' ');
+                    putNumber(year, 0, '0');
+                    break;
+                case 'x':
+                    putNumber(tm.tm_mon + 1, 2, '0'); put('/');
+                    putNumber(tm.tm_mday, 2, '0'); put('/');
+                    putNumber(year % 100, 2, '0');
+                    break;
+                case 'X':
+                    putNumber(tm.tm_hour, 2, '0'); put(':');
+                    putNumber(tm.tm_min, 2, '0'); put(':');
+                    putNumber(tm.tm_sec, 2, '0');
+                    break;
+                case 'r':
+                    putNumber(hours12, 2, '0'); put(':');
+                    putNumber(tm.tm_min, 2, '0'); put(':');
+                    putNumber(tm.tm_sec, 2, '0'); put(' ');
+                    putString(tm.tm_hour < 12 ? "AM" : "PM", 2);
+                    break;
+#endif
+                default:
+                    return unsupported;
+            }
+        }
+
+        if (overflow || size == 0)
+            return 0;
+        buffer[length] = '\0';
+        return length;
+    }
+
     class DateTimeFormat {
     private:
         /*
@@ -62,7 +736,7 @@ namespace beliumgl {
          * HELPERS
          * -------
          */
-        inline std::string toLowercase(std::string str) {
+        static std::string toLowercase(std::string str) {
             try {
                 std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c){ return std::tolower(c); });
                 return str;
@@ -70,22 +744,6 @@ namespace beliumgl {
                 throw std::runtime_error("Failed to `lowercase` a string.");
             }
         }
-
-        inline void removeAll(std::string& str, char token) {
-            str.erase(std::remove(str.begin(), str.end(), token), str.end());
-        }
-
-        inline void removeDuplicates(std::string& str) {
-            std::unordered_set<char> seen;
-            std::string output;
-            output.reserve(str.size());
-            for (char c : str) {
-                if (seen.insert(c).second) {
-                    output.push_back(c);
-                }
-            }
-            str = std::move(output);
-        }
     public:
         /*
          * How does my string format work?
@@ -138,42 +796,1583 @@ namespace beliumgl {
         bool getAlphabeticalMonth() const { return this->alphabeticalMonth; }
         bool get12HourFormat() const { return this->_12Hours; }
         bool getFullNames() const { return this->fullNames; }
-        std::string getOrder() const { return this->order; }
+        const std::string& getOrder() const { return this->order; }
     };
 
-    class DateTime {
-    private:
+    /*
+     * -----------------
+     * FORMATTING ENGINE
+     * -----------------
+     *
+     * DateTime keeps a lot of state around (the unix timestamp string, name tables, etc.),
+     * which is too heavy when you only need to convert a column of timestamps.
+     * CivilTime is the bare result of a conversion, and the functions below work on it
+     * without any heap allocations, so they can be used in batches and from the C API (see `datepp.h`).
+     */
+    struct CivilTime {
+        long long year = 1970;
+        month_t month = 0;
+        day_t day = 0;
+        hour_t hour = 0;
+        minute_t minute = 0;
+        second_t second = 0;
+        unsigned char dotw = 4; // 0 = Sunday, ..., 6 = Saturday
+        timezone_offset_t timezoneOffset = 0.0;
+
+        CivilTime() = default;
+        constexpr CivilTime(const CivilDate& date, int secondsOfDay, unsigned char dotw, timezone_offset_t timezoneOffset)
+        : year(date.year), month(date.month), day(date.day), hour(static_cast<hour_t>(secondsOfDay / 3600)),
+        minute(static_cast<minute_t>(secondsOfDay % 3600 / 60)), second(static_cast<second_t>(secondsOfDay % 60)),
+        dotw(dotw), timezoneOffset(timezoneOffset) {}
+    };
+
+    // Splits a unix timestamp into the local day number (days since 01.01.1970) and the seconds since midnight.
+    inline long long splitUnix(long long _unix, timezone_offset_t timezoneOffset, int& secondsOfDay) {
+        constexpr int secondsInDay = 86400;
+        constexpr int secondsInHour = 3600;
+
+        long long timezoneSeconds = static_cast<long long>(timezoneOffset * secondsInHour);
+        long long adjustedUnix = _unix + timezoneSeconds;
+        long long days = adjustedUnix / secondsInDay;
+        secondsOfDay = static_cast<int>(adjustedUnix % secondsInDay);
+
+        if (secondsOfDay < 0) {
+            secondsOfDay += secondsInDay;
+            days -= 1;
+        }
+        return days;
+    }
+
+    inline void setTimeOfDay(CivilTime& time, int secondsOfDay) {
+        constexpr int secondsInHour = 3600;
+        constexpr int secondsInMinute = 60;
+
+        time.hour = static_cast<hour_t>(secondsOfDay / secondsInHour);
+        time.minute = static_cast<minute_t>(secondsOfDay % secondsInHour / secondsInMinute);
+        time.second = static_cast<second_t>(secondsOfDay % secondsInMinute);
+    }
+
+    namespace detail {
+        // Unsigned, so `days * 86400` may wrap (near the ends of `long long`) and the difference is still right.
+        constexpr CivilTime civilTimeFromLocal(long long localSeconds, long long days, timezone_offset_t timezoneOffset) {
+            return CivilTime(civilDateFromDays(days),
+                             static_cast<int>(static_cast<unsigned long long>(localSeconds) - static_cast<unsigned long long>(days) * 86400ULL),
+                             weekdayFromDays(days), timezoneOffset);
+        }
+
+        constexpr CivilTime civilTimeFromLocal(long long localSeconds, timezone_offset_t timezoneOffset) {
+            return civilTimeFromLocal(localSeconds, floorDiv(localSeconds, 86400), timezoneOffset);
+        }
+    }
+
+    // `constexpr`, like the calendar core.
+    constexpr CivilTime decompose(long long _unix, timezone_offset_t timezoneOffset = 0.0) {
+        return detail::civilTimeFromLocal(_unix + static_cast<long long>(timezoneOffset * 3600), timezoneOffset);
+    }
+
+    namespace detail {
+        // `value` written with "%f" (out of line, so only the implementation includes <cstdio>).
+        DATEPP_DECL void printFixed(char* buffer, size_t size, double value);
+
+        inline bool isNegativeZero(double value) {
+            unsigned long long bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits == 0x8000000000000000ULL;
+        }
+    }
+
+    /*
+     * Writes `time` in the specified format, exactly like `DateTime::toString` does.
+     *
+     * Works like `snprintf`: at most `size - 1` characters are written, the result is always
+     * null-terminated (if `size` isn't 0), and the full length of the result is returned,
+     * so if it's `>= size`, the output was truncated.
+     */
+    inline size_t formatTo(char* buffer, size_t size, const CivilTime& time, const DateTimeFormat& format) {
+        constexpr char dayToken = 'd', monthToken = 'm', yearToken = 'y', alphabeticalMonthToken = 'a';
+        constexpr size_t shortStrLength = 3;
+
+        size_t length = 0;
+        auto put = [&](char c) {
+            if (length < size) buffer[length] = c;
+            ++length;
+        };
+        auto putString = [&](const char* str, size_t n) {
+            for (size_t i = 0; i < n && str[i] != '\0'; ++i) put(str[i]);
+        };
+        auto putNumber = [&](long long num, bool fillZeros) {
+            char digits[24];
+            int count = 0;
+            unsigned long long value = num < 0 ? 0ULL - static_cast<unsigned long long>(num) : static_cast<unsigned long long>(num);
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            if (num < 0) put('-');
+            else if (fillZeros && num < 10) put('0');
+            while (count > 0) put(digits[--count]);
+        };
+
+        if (format.getShowDotw()) {
+            putString(dotwName(time.dotw), format.getFullNames() ? static_cast<size_t>(-1) : shortStrLength);
+            putString(", ", 2);
+        }
+
+        const std::string& order = format.getOrder();
+        for (size_t i = 0; i < order.length(); ++i) {
+            switch (order[i]) {
+                case dayToken:
+                    putNumber(time.day + 1, format.getFillZeros());
+                    break;
+                case monthToken:
+                    putNumber(time.month + 1, format.getFillZeros());
+                    break;
+                case alphabeticalMonthToken:
+                    putString(monthName(time.month), format.getFullNames() ? static_cast<size_t>(-1) : shortStrLength);
+                    break;
+                case yearToken:
+                    putNumber(time.year, false);
+                    break;
+            }
+            put(format.getDelimiter());
+        }
+        if (length > 0 && length - 1 < size)
+            buffer[length - 1] = ' '; // Replace the last delimiter with space
+
+        if (format.getShowTime()) {
+            hour_t hours12 = time.hour % 12;
+            if (hours12 == 0) hours12 = 12;
+
+            putNumber(format.get12HourFormat() ? hours12 : time.hour, format.getFillZeros());
+            put(':');
+            putNumber(time.minute, format.getFillZeros());
+            put(':');
+            putNumber(time.second, format.getFillZeros());
+            put(' ');
+
+            if (format.get12HourFormat())
+                putString(time.hour < 12 ? "AM " : "PM ", 3);
+        }
+
+        if (format.getShowUTCoffset()) {
+            // Six decimals, like "%f". When filling with zeros, the integer part is padded to two digits after the sign.
+            timezone_offset_t offset = time.timezoneOffset;
+            char offsetStr[512];
+
+            if (offset >= 0)
+                put('+');
+            if (format.getFillZeros()) {
+                if (offset >= 0 && offset < 10)
+                    put('0');
+                else if (offset < 0 && offset > -10)
+                    putString("-0", 2);
+                if (!(offset >= 0)) // The sign is already written. NaN is negated too, which flips the sign "%f" prints for it
+                    offset = -offset;
+            }
+
+            // Whole quarters of an hour (every real-world offset) are written directly, anything else goes through "%f".
+            double quarters = offset * 4;
+            if (quarters > -1e12 && quarters < 1e12 && quarters == static_cast<double>(static_cast<long long>(quarters)) && !detail::isNegativeZero(offset)) {
+                static const char* const fractions[4] = {".000000", ".250000", ".500000", ".750000"};
+                long long wholeQuarters = static_cast<long long>(quarters);
+                if (wholeQuarters < 0) {
+                    put('-');
+                    wholeQuarters = -wholeQuarters;
+                }
+                putNumber(wholeQuarters / 4, false);
+                putString(fractions[wholeQuarters % 4], 7);
+            } else {
+                detail::printFixed(offsetStr, sizeof(offsetStr), offset);
+                putString(offsetStr, sizeof(offsetStr));
+            }
+            putString(" UTC", 4);
+        }
+
+        if (size > 0)
+            buffer[length < size ? length : size - 1] = '\0';
+        return length;
+    }
+
+    /*
+     * The opposite of `formatTo`: reads a string produced with the specified format
+     * and returns it as a unix timestamp.
+     *
+     * If the format doesn't show the UTC offset, `timezoneOffset` is used instead.
+     * The day of the week is skipped and not validated. Returns false if the string doesn't match the format,
+     * or if the year is beyond 10^9 or the offset beyond 99 hours either way (where the result could overflow).
+     */
+    inline bool parseFormatted(const char* str, size_t length, const DateTimeFormat& format, long long& out,
+                               timezone_offset_t timezoneOffset = 0.0) {
+        constexpr char dayToken = 'd', monthToken = 'm', yearToken = 'y', alphabeticalMonthToken = 'a';
+        constexpr size_t shortStrLength = 3;
+        constexpr long long maxYear = 1000000000;
+        constexpr timezone_offset_t maxOffset = 99.0;
+
+        const char* p = str;
+        const char* end = str + length;
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        auto isAlpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+        auto lower = [](char c) { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); };
+        auto expect = [&](char c) {
+            if (p == end || *p != c) return false;
+            ++p;
+            return true;
+        };
+        // Fields are separated by a space, which may be missing at the end of the string.
+        auto separator = [&]() { return p == end || expect(' '); };
+        auto readNumber = [&](long long& num) {
+            bool negative = p != end && *p == '-';
+            if (negative) ++p;
+            if (p == end || !isDigit(*p)) return false;
+            num = 0;
+            for (int digits = 0; p != end && isDigit(*p); ++p, ++digits) {
+                if (digits == 18) return false;
+                num = num * 10 + (*p - '0');
+            }
+            if (negative) num = -num;
+            return true;
+        };
+
+        if (format.getShowDotw()) {
+            while (p != end && isAlpha(*p)) ++p;
+            if (!expect(',') || !expect(' ')) return false;
+        }
+
+        long long year = 1970, month = 1, day = 1;
+        const std::string& order = format.getOrder();
+        for (size_t i = 0; i < order.length(); ++i) {
+            switch (order[i]) {
+                case dayToken:
+                    if (!readNumber(day)) return false;
+                    break;
+                case monthToken:
+                    if (!readNumber(month)) return false;
+                    break;
+                case alphabeticalMonthToken: {
+                    // The form the format writes is tried first (with an alphabetic delimiter, "July" may be "Jul" + 'y').
+                    auto startsWith = [&](const char* name, size_t n) {
+                        size_t j = 0;
+                        while (j < n && p + j != end && lower(p[j]) == lower(name[j])) ++j;
+                        return j == n;
+                    };
+                    month = 0;
+                    for (month_t m = 0; m < 12 && month == 0; ++m) {
+                        const char* name = monthName(m);
+                        size_t fullLength = std::char_traits<char>::length(name);
+                        size_t first = format.getFullNames() ? fullLength : shortStrLength;
+                        size_t second = format.getFullNames() ? shortStrLength : fullLength;
+                        if (startsWith(name, first)) p += first;
+                        else if (startsWith(name, second)) p += second;
+                        else continue;
+                        month = m + 1;
+                    }
+                    if (month == 0) return false;
+                    break;
+                }
+                case yearToken:
+                    if (!readNumber(year)) return false;
+                    break;
+            }
+            if (i + 1 < order.length() ? !expect(format.getDelimiter()) : !separator())
+                return false;
+        }
+
+        long long hour = 0, minute = 0, second = 0;
+        if (format.getShowTime() && p != end) {
+            if (!readNumber(hour) || !expect(':') || !readNumber(minute) || !expect(':') || !readNumber(second) || !separator())
+                return false;
+            if (format.get12HourFormat()) {
+                if (hour < 1 || hour > 12 || end - p < 2) return false;
+                char meridiem = lower(*p);
+                if ((meridiem != 'a' && meridiem != 'p') || lower(p[1]) != 'm') return false;
+                p += 2;
+                hour = hour % 12 + (meridiem == 'p' ? 12 : 0);
+                if (!separator()) return false;
+            }
+        }
+
+        if (format.getShowUTCoffset() && p != end) {
+            bool negative = false;
+            if (*p == '+' || *p == '-') negative = *p++ == '-';
+            if (p == end || !isDigit(*p)) return false;
+
+            timezone_offset_t offset = 0.0, scale = 1.0;
+            for (; p != end && isDigit(*p); ++p) offset = offset * 10 + (*p - '0');
+            if (offset > maxOffset) return false;
+            if (p != end && *p == '.')
+                for (++p; p != end && isDigit(*p); ++p) offset += (*p - '0') * (scale /= 10);
+            timezoneOffset = negative ? -offset : offset;
+
+            if (p != end && (!expect(' ') || !expect('U') || !expect('T') || !expect('C')))
+                return false;
+        }
+
+        if (p != end || month < 1 || month > 12 || day < 1 || hour > 23 || minute > 59 || second > 59)
+            return false;
+        if (hour < 0 || minute < 0 || second < 0 || year > maxYear || year < -maxYear)
+            return false;
+        long long daysInMonth = daysFromCivil(month == 12 ? year + 1 : year, static_cast<month_t>(month % 12), 0)
+                              - daysFromCivil(year, static_cast<month_t>(month - 1), 0);
+        if (day > daysInMonth)
+            return false;
+
+        long long days = daysFromCivil(year, static_cast<month_t>(month - 1), static_cast<day_t>(day - 1));
+        out = days * 86400 + hour * 3600 + minute * 60 + second - static_cast<long long>(timezoneOffset * 3600);
+        return true;
+    }
+
+    /*
+     * ---------------------
+     * FIXED-CAPACITY STRING
+     * ---------------------
+     *
+     * Result of formatting that lives entirely inside the object, so it can be returned by value
+     * without touching the heap (`std::string` allocates once the result is longer than its SSO buffer,
+     * e.g. for "Thursday, January 01 1970 12:00:00 AM +00.000000 UTC").
+     */
+    template<size_t N>
+    class FixedString {
+    public:
+        FixedString() { this->buffer[0] = '\0'; }
+
+        // Copies at most N characters of `str`.
+        FixedString(const char* str, size_t length) {
+            this->length_ = length < N ? length : N;
+            std::memcpy(this->buffer, str, this->length_);
+            this->buffer[this->length_] = '\0';
+        }
+
+        const char* c_str() const { return this->buffer; }
+        const char* data() const { return this->buffer; }
+        size_t size() const { return this->length_; }
+        size_t length() const { return this->length_; }
+        bool empty() const { return this->length_ == 0; }
+        static constexpr size_t capacity() { return N; }
+        // True if the formatted result was longer than N characters and was cut.
+        bool truncated() const { return this->truncated_; }
+
+        const char* begin() const { return this->buffer; }
+        const char* end() const { return this->buffer + this->length_; }
+        char operator[](size_t i) const { return this->buffer[i]; }
+
+        std::string str() const { return std::string(this->buffer, this->length_); }
+        explicit operator std::string() const { return this->str(); }
+#if __cplusplus >= 201703L
+        operator std::string_view() const { return std::string_view(this->buffer, this->length_); }
+#endif
+
+        bool operator==(const FixedString& other) const {
+            return this->length_ == other.length_ && std::memcmp(this->buffer, other.buffer, this->length_) == 0;
+        }
+        bool operator!=(const FixedString& other) const { return !(*this == other); }
+
+        // Formats `time` into a new string, see `formatTo`.
+        static FixedString format(const CivilTime& time, const DateTimeFormat& format) {
+            FixedString result;
+            size_t length = formatTo(result.buffer, N + 1, time, format);
+            result.length_ = length < N ? length : N;
+            result.truncated_ = length > N;
+            return result;
+        }
+    private:
+        char buffer[N + 1];
+        size_t length_ = 0;
+        bool truncated_ = false;
+    };
+
+    /*
+     * The longest output of any format for a DateTime: "Wednesday, " + "September", a `year_t` year
+     * ("-32768") and a 2-digit number with their delimiters + "12:00:00 AM " + an offset
+     * below 10^6 hours ("+" or "-0" and "%f") + " UTC". Longer results are truncated.
+     */
+    constexpr size_t maxFormattedLength = 11 + 20 + 12 + 15 + 4;
+    using FormattedDateTime = FixedString<maxFormattedLength>;
+
+    /*
+     * -------------------
+     * TIMESTAMP DETECTION
+     * -------------------
+     *
+     * Parsers for common timestamp representations, and TimestampParser, which finds out
+     * which one a stream of timestamps uses. All of them return unix timestamps (whole seconds,
+     * fractions are dropped) and return false instead of throwing if the string doesn't match.
+     */
+
+    /*
+     * Integer unix timestamp. The unit is guessed from the number of digits:
+     * up to 11 - seconds, 12-14 - milliseconds, 15-17 - microseconds, 18-19 - nanoseconds
+     * (so milliseconds before 03.03.1973 are taken as seconds). `digits` receives the number of digits.
+     */
+    inline bool parseEpoch(const char* str, size_t length, long long& out, size_t& digits) {
+        const char* p = str;
+        const char* end = str + length;
+        bool negative = p != end && *p == '-';
+        if (negative) ++p;
+        digits = static_cast<size_t>(end - p);
+        if (digits == 0 || digits > 19)
+            return false;
+
+        unsigned long long value = 0;
+        for (; p != end; ++p) {
+            if (*p < '0' || *p > '9')
+                return false;
+            value = value * 10 + static_cast<unsigned long long>(*p - '0');
+        }
+        if (value > static_cast<unsigned long long>(std::numeric_limits<long long>::max()))
+            return false;
+
+        static const long long divisors[4] = {1, 1000, 1000000, 1000000000};
+        long long signedValue = negative ? -static_cast<long long>(value) : static_cast<long long>(value);
+        out = floorDiv(signedValue, divisors[digits <= 11 ? 0 : (digits - 9) / 3]);
+        return true;
+    }
+
+    /*
+     * ISO 8601 / RFC 3339 in the extended format: "YYYY-MM-DD", optionally followed by
+     * 'T' (or a space) and "HH:MM", ":SS", ".fraction", and 'Z' or an offset ("+HH:MM", "+HHMM", "+HH").
+     * Without an offset, the time is taken as UTC.
+     */
+    inline bool parseISO8601(const char* str, size_t length, long long& out) {
+        const char* p = str;
+        const char* end = str + length;
+        auto digits = [&](int count, int& value) {
+            if (end - p < count) return false;
+            value = 0;
+            for (int i = 0; i < count; ++i, ++p) {
+                if (*p < '0' || *p > '9') return false;
+                value = value * 10 + (*p - '0');
+            }
+            return true;
+        };
+        auto expect = [&](char c) {
+            if (p == end || *p != c) return false;
+            ++p;
+            return true;
+        };
+
+        int year, month, day, hour = 0, minute = 0, second = 0;
+        if (!digits(4, year) || !expect('-') || !digits(2, month) || !expect('-') || !digits(2, day))
+            return false;
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, static_cast<month_t>(month - 1)))
+            return false;
+
+        long long offsetSeconds = 0;
+        if (p != end) {
+            if (*p != 'T' && *p != 't' && *p != ' ')
+                return false;
+            ++p;
+            if (!digits(2, hour) || !expect(':') || !digits(2, minute))
+                return false;
+            if (p != end && *p == ':') {
+                ++p;
+                if (!digits(2, second)) return false;
+                if (p != end && (*p == '.' || *p == ',')) {
+                    ++p;
+                    if (p == end || *p < '0' || *p > '9') return false;
+                    while (p != end && *p >= '0' && *p <= '9') ++p;
+                }
+            }
+            if (hour > 23 || minute > 59 || second > 60)
+                return false;
+
+            if (p != end) {
+                if (*p == 'Z' || *p == 'z') {
+                    ++p;
+                } else if (*p == '+' || *p == '-') {
+                    bool negative = *p++ == '-';
+                    int offsetHours, offsetMinutes = 0;
+                    if (!digits(2, offsetHours)) return false;
+                    if (p != end && *p == ':') ++p;
+                    if (p != end && !digits(2, offsetMinutes)) return false;
+                    if (offsetHours > 23 || offsetMinutes > 59) return false;
+                    offsetSeconds = (offsetHours * 3600LL + offsetMinutes * 60LL) * (negative ? -1 : 1);
+                } else {
+                    return false;
+                }
+            }
+        }
+        if (p != end)
+            return false;
+
+        long long days = daysFromCivil(year, static_cast<month_t>(month - 1), static_cast<day_t>(day - 1));
+        out = days * 86400 + hour * 3600LL + minute * 60LL + second - offsetSeconds;
+        return true;
+    }
+
+    /*
+     * RFC 2822 (e-mail and HTTP) dates: "[Thu, ]01 Jan 1970 00:00[:00] +0000".
+     * The zone may also be "UT", "GMT", "Z" or a North American zone name ("EST", "PDT", ...).
+     */
+    inline bool parseRFC2822(const char* str, size_t length, long long& out) {
+        const char* p = str;
+        const char* end = str + length;
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        auto isAlpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+        auto lower = [](char c) { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); };
+        auto skipSpaces = [&]() {
+            const char* start = p;
+            while (p != end && (*p == ' ' || *p == '\t')) ++p;
+            return p != start;
+        };
+        auto number = [&](int minDigits, int maxDigits, int& value) {
+            int count = 0;
+            value = 0;
+            for (; p != end && isDigit(*p) && count < maxDigits; ++p, ++count)
+                value = value * 10 + (*p - '0');
+            return count >= minDigits && (p == end || !isDigit(*p));
+        };
+        auto word = [&](const char*& begin) {
+            begin = p;
+            while (p != end && isAlpha(*p)) ++p;
+            return static_cast<size_t>(p - begin);
+        };
+        auto equals = [&](const char* w, size_t n, const char* name) {
+            size_t i = 0;
+            for (; i < n && name[i] != '\0'; ++i)
+                if (lower(w[i]) != lower(name[i])) return false;
+            return i == n && name[i] == '\0';
+        };
+
+        skipSpaces();
+        const char* w;
+        if (p != end && isAlpha(*p)) {
+            size_t n = word(w);
+            bool found = false;
+            for (unsigned char d = 0; d < 7 && !found; ++d) {
+                char shortName[4] = {dotwName(d)[0], dotwName(d)[1], dotwName(d)[2], '\0'};
+                found = equals(w, n, shortName);
+            }
+            if (!found || p == end || *p != ',') return false;
+            ++p;
+            skipSpaces();
+        }
+
+        int day, year, hour, minute, second = 0;
+        if (!number(1, 2, day) || !skipSpaces())
+            return false;
+
+        size_t n = word(w);
+        int month = -1;
+        for (month_t m = 0; m < 12 && month < 0; ++m) {
+            char shortName[4] = {monthName(m)[0], monthName(m)[1], monthName(m)[2], '\0'};
+            if (equals(w, n, shortName)) month = m;
+        }
+        if (month < 0 || !skipSpaces() || !number(4, 4, year) || !skipSpaces())
+            return false;
+        if (!number(2, 2, hour) || p == end || *p++ != ':' || !number(2, 2, minute))
+            return false;
+        if (p != end && *p == ':') {
+            ++p;
+            if (!number(2, 2, second)) return false;
+        }
+        if (day < 1 || day > daysInMonth(year, static_cast<month_t>(month)) || hour > 23 || minute > 59 || second > 60)
+            return false;
+
+        long long offsetSeconds = 0;
+        if (!skipSpaces())
+            return false;
+        if (p != end && (*p == '+' || *p == '-')) {
+            bool negative = *p++ == '-';
+            int offset;
+            if (!number(4, 4, offset) || offset % 100 > 59) return false;
+            offsetSeconds = (offset / 100 * 3600LL + offset % 100 * 60LL) * (negative ? -1 : 1);
+        } else {
+            static const struct { const char* name; int hours; } zones[] = {
+                {"UT", 0}, {"GMT", 0}, {"Z", 0}, {"EST", -5}, {"EDT", -4}, {"CST", -6},
+                {"CDT", -5}, {"MST", -7}, {"MDT", -6}, {"PST", -8}, {"PDT", -7}
+            };
+            n = word(w);
+            bool found = false;
+            for (const auto& zone : zones) {
+                if (equals(w, n, zone.name)) {
+                    offsetSeconds = zone.hours * 3600LL;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return false;
+        }
+        skipSpaces();
+        if (p != end)
+            return false;
+
+        long long days = daysFromCivil(year, static_cast<month_t>(month), static_cast<day_t>(day - 1));
+        out = days * 86400 + hour * 3600LL + minute * 60LL + second - offsetSeconds;
+        return true;
+    }
+
+    /*
+     * -------------
+     * SERIALIZATION
+     * -------------
+     *
+     * Timestamps as {seconds, nanoseconds} in the wire formats services exchange them in:
+     * RFC 3339 strings, JSON (RFC 3339 strings or epoch numbers) and the protobuf
+     * `google.protobuf.Timestamp` message. Like the protobuf type, `nanoseconds` is always
+     * in [0, 999999999] and counts forward from `seconds` (so -1.5 s is {-2, 500000000}).
+     *
+     * The writers work like `formatTo`: at most `size` bytes are written and the full length is returned
+     * (0 if `nanoseconds` is out of range). The text writers also null-terminate the result if it fits.
+     * The parsers read straight from the caller's buffer and return false if the input doesn't match.
+     */
+    namespace detail {
+        // "00" to "99", to write two digits at once.
+        constexpr char twoDigits[201] =
+            "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+            "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+        // Fractions are written with 3, 6 or 9 digits, whichever is the shortest exact one (like protobuf's JSON mapping).
+        inline size_t writeFraction(char* out, int nanoseconds) {
+            if (nanoseconds == 0) return 0;
+            int digits = nanoseconds % 1000000 == 0 ? 3 : nanoseconds % 1000 == 0 ? 6 : 9;
+            int value = digits == 3 ? nanoseconds / 1000000 : digits == 6 ? nanoseconds / 1000 : nanoseconds;
+            out[0] = '.';
+            for (int i = digits; i > 0; --i, value /= 10)
+                out[i] = static_cast<char>('0' + value % 10);
+            return static_cast<size_t>(digits) + 1;
+        }
+
+        inline size_t writeInteger(char* out, unsigned long long value) {
+            char digits[20];
+            size_t count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            for (size_t i = 0; i < count; ++i)
+                out[i] = digits[count - 1 - i];
+            return count;
+        }
+
+        // Copies `length` bytes of `data` into the caller's buffer like `formatTo` does.
+        inline size_t finishText(char* buffer, size_t size, const char* data, size_t length) {
+            if (size > 0) {
+                size_t copied = length < size ? length : size - 1;
+                std::memcpy(buffer, data, copied);
+                buffer[copied] = '\0';
+            }
+            return length;
+        }
+
+        // Up to 9 digits of a fraction (after the '.') as nanoseconds; further digits are dropped.
+        inline bool readFraction(const char*& p, const char* end, int& nanoseconds) {
+            if (p == end || *p < '0' || *p > '9') return false;
+            int scale = 100000000;
+            nanoseconds = 0;
+            for (; p != end && *p >= '0' && *p <= '9'; ++p, scale /= 10)
+                if (scale > 0) nanoseconds += (*p - '0') * scale;
+            return true;
+        }
+    }
+
+    /*
+     * "2024-01-02T03:04:05.250Z", or with the UTC offset ("+05:30") if it isn't 0 (it's rounded to minutes).
+     * Years outside 0000-9999 get a sign and at least 4 digits ("-0044", "+12345").
+     * Offsets of 100 hours or more don't fit "+HH:MM" and give 0.
+     */
+    inline size_t writeRFC3339(char* buffer, size_t size, long long seconds, int nanoseconds = 0, timezone_offset_t timezoneOffset = 0.0) {
+        constexpr long long maxOffsetMinutes = 99 * 60 + 59;
+        if (nanoseconds < 0 || nanoseconds > 999999999) return 0;
+        if (!(timezoneOffset > -100.0 && timezoneOffset < 100.0)) return 0;
+
+        const long long offsetMinutes = detail::roundToInteger(timezoneOffset * 60);
+        if (offsetMinutes > maxOffsetMinutes || offsetMinutes < -maxOffsetMinutes) return 0;
+        if ((offsetMinutes > 0 && seconds > std::numeric_limits<long long>::max() - offsetMinutes * 60)
+            || (offsetMinutes < 0 && seconds < std::numeric_limits<long long>::min() - offsetMinutes * 60))
+            return 0;
+        const long long local = seconds + offsetMinutes * 60;
+        const long long days = floorDiv(local, 86400);
+        const int secondsOfDay = static_cast<int>(local - days * 86400);
+        const CivilDate date = civilDateFromDays(days);
+
+        char out[64];
+        size_t length = 0;
+        auto two = [&](int value) {
+            out[length++] = detail::twoDigits[value * 2];
+            out[length++] = detail::twoDigits[value * 2 + 1];
+        };
+
+        if (date.year >= 0 && date.year <= 9999) {
+            two(static_cast<int>(date.year / 100));
+            two(static_cast<int>(date.year % 100));
+        } else {
+            out[length++] = date.year < 0 ? '-' : '+';
+            char year[20];
+            size_t yearLength = detail::writeInteger(year, date.year < 0 ? 0ULL - static_cast<unsigned long long>(date.year)
+                                                                         : static_cast<unsigned long long>(date.year));
+            for (size_t i = yearLength; i < 4; ++i)
+                out[length++] = '0';
+            std::memcpy(out + length, year, yearLength);
+            length += yearLength;
+        }
+        out[length++] = '-';
+        two(date.month + 1);
+        out[length++] = '-';
+        two(date.day + 1);
+        out[length++] = 'T';
+        two(secondsOfDay / 3600);
+        out[length++] = ':';
+        two(secondsOfDay % 3600 / 60);
+        out[length++] = ':';
+        two(secondsOfDay % 60);
+        length += detail::writeFraction(out + length, nanoseconds);
+
+        if (offsetMinutes == 0) {
+            out[length++] = 'Z';
+        } else {
+            long long absolute = offsetMinutes < 0 ? -offsetMinutes : offsetMinutes;
+            out[length++] = offsetMinutes < 0 ? '-' : '+';
+            two(static_cast<int>(absolute / 60));
+            out[length++] = ':';
+            two(static_cast<int>(absolute % 60));
+        }
+        return detail::finishText(buffer, size, out, length);
+    }
+
+    /*
+     * Reads "YYYY-MM-DDTHH:MM:SS[.fraction](Z|+HH:MM|-HH:MM)" ('T' may also be 't' or ' ', 'Z' may be 'z'),
+     * and the expanded years `writeRFC3339` writes ("-0044", "+12345"), up to 10^9 either way like `parseFormatted`
+     * (so the result can't overflow). The fraction keeps up to 9 digits; a leap second (":60") is read as
+     * the first second of the next minute.
+     */
+    inline bool parseRFC3339(const char* str, size_t length, long long& seconds, int& nanoseconds) {
+        constexpr long long maxYear = 1000000000;
+        const char* p = str;
+        const char* end = str + length;
+        auto two = [&](int& value) {
+            if (end - p < 2 || p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') return false;
+            value = (p[0] - '0') * 10 + (p[1] - '0');
+            p += 2;
+            return true;
+        };
+        auto expect = [&](char c) {
+            if (p == end || *p != c) return false;
+            ++p;
+            return true;
+        };
+
+        // Expanded years written by `writeRFC3339`: a sign and at least 4 digits.
+        long long year = 0;
+        bool negativeYear = p != end && *p == '-';
+        if (p != end && (*p == '-' || *p == '+')) {
+            ++p;
+            const char* yearStart = p;
+            for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+                year = year * 10 + (*p - '0');
+                if (year > maxYear) return false;
+            }
+            if (p - yearStart < 4) return false;
+            if (negativeYear) year = -year;
+        } else {
+            int century, yearOfCentury;
+            if (!two(century) || !two(yearOfCentury)) return false;
+            year = century * 100 + yearOfCentury;
+        }
+
+        int month, day, hour, minute, second;
+        if (!expect('-') || !two(month) || !expect('-') || !two(day))
+            return false;
+        if (p == end || (*p != 'T' && *p != 't' && *p != ' '))
+            return false;
+        ++p;
+        if (!two(hour) || !expect(':') || !two(minute) || !expect(':') || !two(second))
+            return false;
+
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, static_cast<month_t>(month - 1))
+            || hour > 23 || minute > 59 || second > 60)
+            return false;
+
+        int fraction = 0;
+        if (p != end && *p == '.' && !detail::readFraction(++p, end, fraction))
+            return false;
+
+        long long offsetSeconds = 0;
+        if (p != end && (*p == 'Z' || *p == 'z')) {
+            ++p;
+        } else if (p != end && (*p == '+' || *p == '-')) {
+            bool negative = *p++ == '-';
+            int offsetHours, offsetMinutes;
+            if (!two(offsetHours) || !expect(':') || !two(offsetMinutes) || offsetHours > 23 || offsetMinutes > 59)
+                return false;
+            offsetSeconds = (offsetHours * 3600LL + offsetMinutes * 60LL) * (negative ? -1 : 1);
+        } else {
+            return false;
+        }
+        if (p != end)
+            return false;
+
+        seconds = daysFromCivil(year, static_cast<month_t>(month - 1), static_cast<day_t>(day - 1)) * 86400
+                + hour * 3600LL + minute * 60LL + second - offsetSeconds;
+        nanoseconds = fraction;
+        return true;
+    }
+
+    // JSON number of seconds: "1700000000" or "-1.5" (fraction like in RFC 3339).
+    inline size_t writeEpochNumber(char* buffer, size_t size, long long seconds, int nanoseconds = 0) {
+        if (nanoseconds < 0 || nanoseconds > 999999999) return 0;
+
+        char out[32];
+        size_t length = 0;
+        unsigned long long whole;
+        if (seconds < 0 && nanoseconds > 0) {
+            // {-2, 500000000} is -1.5
+            out[length++] = '-';
+            whole = 0ULL - static_cast<unsigned long long>(seconds + 1);
+            nanoseconds = 1000000000 - nanoseconds;
+        } else if (seconds < 0) {
+            out[length++] = '-';
+            whole = 0ULL - static_cast<unsigned long long>(seconds);
+        } else {
+            whole = static_cast<unsigned long long>(seconds);
+        }
+        length += detail::writeInteger(out + length, whole);
+        length += detail::writeFraction(out + length, nanoseconds);
+        return detail::finishText(buffer, size, out, length);
+    }
+
+    // Reads a JSON number of seconds without an exponent ("1700000000", "-1.5").
+    inline bool parseEpochNumber(const char* str, size_t length, long long& seconds, int& nanoseconds) {
+        const char* p = str;
+        const char* end = str + length;
+        bool negative = p != end && *p == '-';
+        if (negative) ++p;
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+
+        long long whole = 0;
+        for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+            if (whole > (std::numeric_limits<long long>::max() - (*p - '0')) / 10)
+                return false;
+            whole = whole * 10 + (*p - '0');
+        }
+        int fraction = 0;
+        if (p != end && *p == '.' && !detail::readFraction(++p, end, fraction))
+            return false;
+        if (p != end)
+            return false;
+
+        if (negative && fraction > 0) {
+            seconds = -whole - 1;
+            nanoseconds = 1000000000 - fraction;
+        } else {
+            seconds = negative ? -whole : whole;
+            nanoseconds = fraction;
+        }
+        return true;
+    }
+
+    // A JSON string with the RFC 3339 timestamp, quotes included.
+    inline size_t writeJSONString(char* buffer, size_t size, long long seconds, int nanoseconds = 0, timezone_offset_t timezoneOffset = 0.0) {
+        char out[66];
+        size_t length = writeRFC3339(out + 1, sizeof(out) - 2, seconds, nanoseconds, timezoneOffset);
+        if (length == 0) return 0;
+        out[0] = '"';
+        out[length + 1] = '"';
+        return detail::finishText(buffer, size, out, length + 2);
+    }
+
+    // A JSON value holding a timestamp: a quoted RFC 3339 string or an epoch number (surrounding whitespace is skipped).
+    inline bool parseJSONTimestamp(const char* str, size_t length, long long& seconds, int& nanoseconds) {
+        auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+        while (length > 0 && isSpace(*str)) ++str, --length;
+        while (length > 0 && isSpace(str[length - 1])) --length;
+
+        if (length >= 2 && str[0] == '"' && str[length - 1] == '"')
+            return parseRFC3339(str + 1, length - 2, seconds, nanoseconds);
+        return parseEpochNumber(str, length, seconds, nanoseconds);
+    }
+
+    // Protobuf base-128 varint; at most 10 bytes. Returns the number of bytes (written only if they fit in `size`).
+    inline size_t writeVarint(unsigned char* buffer, size_t size, unsigned long long value) {
+        size_t length = 0;
+        do {
+            unsigned char byte = static_cast<unsigned char>(value & 0x7f);
+            value >>= 7;
+            if (value != 0) byte |= 0x80;
+            if (length < size) buffer[length] = byte;
+            ++length;
+        } while (value != 0);
+        return length;
+    }
+
+    inline bool readVarint(const unsigned char*& p, const unsigned char* end, unsigned long long& value) {
+        value = 0;
+        for (int shift = 0; shift < 70 && p != end; shift += 7) {
+            unsigned char byte = *p++;
+            value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    /*
+     * Serialized `google.protobuf.Timestamp` ({int64 seconds = 1; int32 nanos = 2;}), fields equal to 0 are omitted.
+     * At most 22 bytes; nothing is written if they don't fit in `size`.
+     */
+    inline size_t writeTimestampMessage(unsigned char* buffer, size_t size, long long seconds, int nanoseconds = 0) {
+        if (nanoseconds < 0 || nanoseconds > 999999999) return 0;
+
+        unsigned char out[22];
+        size_t length = 0;
+        if (seconds != 0) {
+            out[length++] = 0x08; // Field 1, varint
+            length += writeVarint(out + length, sizeof(out) - length, static_cast<unsigned long long>(seconds));
+        }
+        if (nanoseconds != 0) {
+            out[length++] = 0x10; // Field 2, varint
+            length += writeVarint(out + length, sizeof(out) - length, static_cast<unsigned long long>(nanoseconds));
+        }
+        if (length <= size)
+            std::memcpy(buffer, out, length);
+        return length;
+    }
+
+    // Reads a `google.protobuf.Timestamp` message; unknown fields are skipped, like protobuf does.
+    inline bool parseTimestampMessage(const unsigned char* data, size_t length, long long& seconds, int& nanoseconds) {
+        const unsigned char* p = data;
+        const unsigned char* end = data + length;
+        long long resultSeconds = 0;
+        long long resultNanoseconds = 0;
+
+        while (p != end) {
+            unsigned long long key, value;
+            if (!readVarint(p, end, key))
+                return false;
+            switch (key & 7) {
+                case 0: // Varint
+                    if (!readVarint(p, end, value)) return false;
+                    if (key >> 3 == 1) resultSeconds = static_cast<long long>(value);
+                    else if (key >> 3 == 2) resultNanoseconds = static_cast<int>(static_cast<unsigned>(value));
+                    break;
+                case 1: // 64-bit
+                    if (end - p < 8) return false;
+                    p += 8;
+                    break;
+                case 2: // Length-delimited
+                    if (!readVarint(p, end, value) || value > static_cast<unsigned long long>(end - p)) return false;
+                    p += value;
+                    break;
+                case 5: // 32-bit
+                    if (end - p < 4) return false;
+                    p += 4;
+                    break;
+                default:
+                    return false;
+            }
+        }
+        if (resultNanoseconds < 0 || resultNanoseconds > 999999999)
+            return false;
+        seconds = resultSeconds;
+        nanoseconds = static_cast<int>(resultNanoseconds);
+        return true;
+    }
+
+    /*
+     * ---------
+     * DAY CACHE
+     * ---------
+     *
+     * Small direct-mapped cache of calendar dates, keyed by the day number (days since 01.01.1970).
+     * Real data usually has few distinct days (e.g. logs of the last weeks), so most conversions
+     * only need the time of day, which is cheap; the date is looked up instead of recomputed.
+     * Consecutive days map to consecutive slots, so `Size` days in a row never evict each other.
+     *
+     * The cache isn't synchronized; use one instance per thread.
+     */
+    template<size_t Size = 256>
+    class DayCache {
+        static_assert(Size > 0 && (Size & (Size - 1)) == 0, "DayCache size must be a power of two.");
+    public:
+        DayCache() {
+            for (Slot& slot : this->slots)
+                slot.days = std::numeric_limits<long long>::min();
+        }
+
+        CivilTime decompose(long long _unix, timezone_offset_t timezoneOffset = 0.0) {
+            int secondsOfDay;
+            long long days = splitUnix(_unix, timezoneOffset, secondsOfDay);
+            return lookup(days, secondsOfDay, timezoneOffset);
+        }
+
+        void decompose(const long long* unixTimes, size_t count, CivilTime* out, timezone_offset_t timezoneOffset = 0.0) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = decompose(unixTimes[i], timezoneOffset);
+        }
+
+        // Civil time of `localSeconds`, a unix timestamp already moved by its UTC offset (like TimeZone::toLocal gives).
+        CivilTime fromLocal(long long localSeconds, timezone_offset_t timezoneOffset) {
+            const long long days = floorDiv(localSeconds, 86400);
+            return lookup(days, static_cast<int>(localSeconds - days * 86400), timezoneOffset);
+        }
+
+        // Same as `beliumgl::formatTo`, but takes a unix timestamp.
+        size_t formatTo(char* buffer, size_t size, long long _unix, const DateTimeFormat& format,
+                        timezone_offset_t timezoneOffset = 0.0) {
+            return beliumgl::formatTo(buffer, size, decompose(_unix, timezoneOffset), format);
+        }
+
+        size_t getHits() const { return this->hits; }
+        size_t getMisses() const { return this->misses; }
+        double hitRate() const {
+            return this->hits + this->misses == 0 ? 0.0 : static_cast<double>(this->hits) / static_cast<double>(this->hits + this->misses);
+        }
+        void resetStats() { this->hits = this->misses = 0; }
+    private:
+        struct Slot {
+            long long days;
+            CivilTime date;
+        };
+
+        std::array<Slot, Size> slots;
+        size_t hits = 0, misses = 0;
+
+        CivilTime lookup(long long days, int secondsOfDay, timezone_offset_t timezoneOffset) {
+            Slot& slot = this->slots[static_cast<size_t>(days) & (Size - 1)];
+            if (slot.days == days) {
+                ++this->hits;
+            } else {
+                ++this->misses;
+                slot.days = days;
+                civilFromDays(days, slot.date.year, slot.date.month, slot.date.day);
+                slot.date.dotw = weekdayFromDays(days);
+            }
+
+            CivilTime result = slot.date;
+            setTimeOfDay(result, secondsOfDay);
+            result.timezoneOffset = timezoneOffset;
+            return result;
+        }
+    };
+
+    namespace detail {
+        // Batches at least this long are decomposed through a DayCache; for shorter ones, clearing it costs more than it saves.
+        constexpr size_t cachedBatch = 64;
+    }
+
+    /*
+     * Same as `decompose` for every timestamp. Long batches go through a DayCache,
+     * so timestamps on the same few days only compute their time of day.
+     */
+    inline void decompose(const long long* unixTimes, size_t count, CivilTime* out, timezone_offset_t timezoneOffset = 0.0) {
+        if (count < detail::cachedBatch) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = decompose(unixTimes[i], timezoneOffset);
+            return;
+        }
+        DayCache<> cache;
+        cache.decompose(unixTimes, count, out, timezoneOffset);
+    }
+
+    /*
+     * ----------------
+     * MULTIPLE OFFSETS
+     * ----------------
+     *
+     * One instant in many UTC offsets or zones at once (e.g. an event shown in the zones
+     * of all attendees). The instant is decomposed once in UTC, and the civil time in every offset
+     * is derived from it by moving the time of day; the date is only recomputed when the offset
+     * moves it to another day, and the day before or after in the same month is just `day -/+ 1`.
+     * The zone versions, decomposeInZones and formatInZones, are in `datepp_zones.hpp`.
+     */
+    namespace detail {
+        // `utc` (the civil time of `days` and `secondsOfDay`) moved by `offset` seconds.
+        inline CivilTime shiftCivilTime(const CivilTime& utc, long long days, int secondsOfDay, long long offset,
+                                        timezone_offset_t timezoneOffset) {
+            const long long local = secondsOfDay + offset;
+            const long long shift = floorDiv(local, 86400);
+            CivilTime time = utc;
+            if (shift != 0) {
+                if (shift == 1 && utc.day + 1 < daysInMonth(utc.year, utc.month)) {
+                    time.day = static_cast<day_t>(utc.day + 1);
+                } else if (shift == -1 && utc.day > 0) {
+                    time.day = static_cast<day_t>(utc.day - 1);
+                } else {
+                    const CivilDate date = civilDateFromDays(days + shift);
+                    time.year = date.year;
+                    time.month = date.month;
+                    time.day = date.day;
+                }
+                time.dotw = static_cast<unsigned char>(((utc.dotw + shift) % 7 + 7) % 7);
+            }
+            setTimeOfDay(time, static_cast<int>(local - shift * 86400));
+            time.timezoneOffset = timezoneOffset;
+            return time;
+        }
+
+        /*
+         * Formats `timeAt(i)` for every `i` into `buffer`, separated by `separator`; see formatInOffsets.
+         */
+        template<typename F>
+        size_t formatEach(char* buffer, size_t size, size_t count, const DateTimeFormat& format, size_t* ends, char separator, F timeAt) {
+            size_t length = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (i > 0) {
+                    if (length < size)
+                        buffer[length] = separator;
+                    ++length;
+                }
+                length += formatTo(length < size ? buffer + length : nullptr, length < size ? size - length : 0, timeAt(i), format);
+                if (ends != nullptr)
+                    ends[i] = length;
+            }
+            if (size > 0)
+                buffer[length < size ? length : size - 1] = '\0';
+            return length;
+        }
+    }
+
+    // Civil time of `_unix` in every one of `offsets` (in hours, like DateTime).
+    inline void decomposeInOffsets(long long _unix, const timezone_offset_t* offsets, size_t count, CivilTime* out) {
+        int secondsOfDay;
+        const long long days = splitUnix(_unix, 0.0, secondsOfDay);
+        const CivilTime utc = detail::civilTimeFromLocal(_unix, days, 0.0);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = detail::shiftCivilTime(utc, days, secondsOfDay, static_cast<long long>(offsets[i] * 3600), offsets[i]);
+    }
+
+    /*
+     * Formats `_unix` in every one of `offsets` into `buffer`, one after another, separated by `separator`
+     * (with '\0', every result is a C string). Works like `formatTo` (and `snprintf`): the result is always
+     * null-terminated and its full length is returned. If `ends` isn't null, `ends[i]` is set to the position
+     * after the `i`-th result, so it spans [ends[i - 1] + 1, ends[i]) (or [0, ends[0]) for the first one).
+     */
+    inline size_t formatInOffsets(char* buffer, size_t size, long long _unix, const timezone_offset_t* offsets, size_t count,
+                                  const DateTimeFormat& format, size_t* ends = nullptr, char separator = '\n') {
+        int secondsOfDay;
+        const long long days = splitUnix(_unix, 0.0, secondsOfDay);
+        const CivilTime utc = detail::civilTimeFromLocal(_unix, days, 0.0);
+        return detail::formatEach(buffer, size, count, format, ends, separator, [&](size_t i) {
+            return detail::shiftCivilTime(utc, days, secondsOfDay, static_cast<long long>(offsets[i] * 3600), offsets[i]);
+        });
+    }
+
+    /*
+     * -------------
+     * LOG REWRITING
+     * -------------
+     *
+     * Replaces unix timestamps in one column of text lines with formatted dates
+     * (what `awk '{ $2 = strftime(...) }'` would do), used by `tools/datepp-rewrite.cpp`.
+     *
+     * Columns are counted from 1. With the ' ' delimiter, fields are separated by runs of spaces and tabs
+     * (like in awk), otherwise by every delimiter character (like in cut). Fields that aren't integers are kept as is.
+     * One instance shouldn't be used from several threads at the same time (it owns a DayCache).
+     */
+    class EpochRewriter {
+    public:
+        EpochRewriter(const DateTimeFormat& format, size_t column, char delimiter = ' ',
+                      timezone_offset_t timezoneOffset = 0.0, bool milliseconds = false)
+        : format(format), column(column), delimiter(delimiter), timezoneOffset(timezoneOffset), milliseconds(milliseconds) {
+            if (column == 0)
+                throw std::invalid_argument("Columns are counted from 1.");
+        }
+
+        // Appends the field to `out`, formatted if it's a timestamp. Returns false if it isn't one.
+        bool rewriteField(const char* begin, const char* end, std::string& out) {
+            const char* p = begin;
+            bool negative = p != end && *p == '-';
+            if (negative) ++p;
+            if (p == end || end - p > 18) {
+                out.append(begin, end);
+                return false;
+            }
+
+            long long value = 0;
+            for (; p != end; ++p) {
+                if (*p < '0' || *p > '9') {
+                    out.append(begin, end);
+                    return false;
+                }
+                value = value * 10 + (*p - '0');
+            }
+            if (negative) value = -value;
+            if (this->milliseconds) value = floorDiv(value, 1000);
+
+            char buffer[128];
+            size_t length = this->cache.formatTo(buffer, sizeof(buffer), value, this->format, this->timezoneOffset);
+            if (length >= sizeof(buffer)) {
+                size_t position = out.size();
+                out.resize(position + length + 1);
+                this->cache.formatTo(&out[position], length + 1, value, this->format, this->timezoneOffset);
+                out.resize(position + length);
+            } else {
+                out.append(buffer, length);
+            }
+            return true;
+        }
+
+        // Rewrites the lines in [begin, end) and appends them to `out`. The last line may lack a '\n'.
+        void rewrite(const char* begin, const char* end, std::string& out) {
+            out.reserve(out.size() + static_cast<size_t>(end - begin) + static_cast<size_t>(end - begin) / 2);
+            while (begin != end) {
+                const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+                if (lineEnd == nullptr) lineEnd = end;
+                rewriteLine(begin, lineEnd, out);
+                if (lineEnd != end) {
+                    out.push_back('\n');
+                    ++lineEnd;
+                }
+                begin = lineEnd;
+            }
+        }
+
+        void rewriteLine(const char* begin, const char* end, std::string& out) {
+            auto isSpace = [](char c) { return c == ' ' || c == '\t'; };
+            bool whitespace = this->delimiter == ' ';
+
+            const char* field = begin;
+            for (size_t index = 1; ; ++index) {
+                if (whitespace)
+                    while (field != end && isSpace(*field)) ++field;
+
+                const char* fieldEnd = field;
+                while (fieldEnd != end && (whitespace ? !isSpace(*fieldEnd) : *fieldEnd != this->delimiter)) ++fieldEnd;
+
+                if (index == this->column) {
+                    out.append(begin, field);
+                    rewriteField(field, fieldEnd, out);
+                    out.append(fieldEnd, end);
+                    return;
+                }
+                if (fieldEnd == end)
+                    break;
+                field = whitespace ? fieldEnd : fieldEnd + 1;
+            }
+            out.append(begin, end);
+        }
+
+        const DayCache<>& getCache() const { return this->cache; }
+    private:
+        DateTimeFormat format;
+        size_t column;
+        char delimiter;
+        timezone_offset_t timezoneOffset;
+        bool milliseconds;
+        DayCache<> cache;
+    };
+
+    class DateTimeRange;
+
+    /*
+     * Step of a DateTimeRange: a number of seconds, minutes, hours, days, weeks, months or years.
+     * Month and year steps keep the day of the month of the first date when possible
+     * (31.01 + 1 month = 28.02 or 29.02, and the next step is 31.03 again).
+     */
+    struct RangeStep {
+        enum class Unit { Second, Minute, Hour, Day, Week, Month, Year };
+
+        Unit unit;
+        long long count;
+
+        RangeStep(Unit unit = Unit::Day, long long count = 1) : unit(unit), count(count) {}
+
+        static RangeStep seconds(long long count) { return {Unit::Second, count}; }
+        static RangeStep minutes(long long count) { return {Unit::Minute, count}; }
+        static RangeStep hours(long long count) { return {Unit::Hour, count}; }
+        static RangeStep days(long long count) { return {Unit::Day, count}; }
+        static RangeStep weeks(long long count) { return {Unit::Week, count}; }
+        static RangeStep months(long long count) { return {Unit::Month, count}; }
+        static RangeStep years(long long count) { return {Unit::Year, count}; }
+
+        bool isCalendar() const { return this->unit == Unit::Month || this->unit == Unit::Year; }
+
+        // Length of a fixed step in seconds. Month and year steps have none (asserted; 0 with NDEBUG).
+        // Not checked for overflow, see lengthInSecondsChecked.
+        long long lengthInSeconds() const {
+            static const long long lengths[7] = {1, 60, 3600, 86400, 604800, 0, 0};
+            assert(!isCalendar());
+            return lengths[static_cast<int>(this->unit)] * this->count;
+        }
+    };
+
+    /*
+     * ------------------
+     * CHECKED ARITHMETIC
+     * ------------------
+     *
+     * Arithmetic on timestamps that reports errors instead of overflowing or throwing.
+     * The `...Checked` functions return a Status and leave `out` untouched on failure;
+     * the `...Saturating` ones clamp the result to the representable range.
+     * With GCC and Clang they use the overflow builtins, which compile to the plain
+     * instruction plus a branch on the overflow flag, so they cost about the same as unchecked arithmetic.
+     */
+    enum class Status {
+        Ok = 0,
+        Overflow,        // The result doesn't fit in `long long` (or a year doesn't fit in the calendar)
+        DivisionByZero,
+        OutOfRange,      // The result doesn't fit in a DateTime (years of `year_t`)
+        InvalidArgument  // Not a unix timestamp
+    };
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_mul_overflow)
+#define DATEPP_OVERFLOW_BUILTINS
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 5
+#define DATEPP_OVERFLOW_BUILTINS
+#endif
+
+    inline Status addChecked(long long a, long long b, long long& out) {
+#ifdef DATEPP_OVERFLOW_BUILTINS
+        long long result;
+        if (__builtin_add_overflow(a, b, &result)) return Status::Overflow;
+#else
+        if ((b > 0 && a > std::numeric_limits<long long>::max() - b) || (b < 0 && a < std::numeric_limits<long long>::min() - b))
+            return Status::Overflow;
+        long long result = a + b;
+#endif
+        out = result;
+        return Status::Ok;
+    }
+
+    inline Status subChecked(long long a, long long b, long long& out) {
+#ifdef DATEPP_OVERFLOW_BUILTINS
+        long long result;
+        if (__builtin_sub_overflow(a, b, &result)) return Status::Overflow;
+#else
+        if ((b < 0 && a > std::numeric_limits<long long>::max() + b) || (b > 0 && a < std::numeric_limits<long long>::min() + b))
+            return Status::Overflow;
+        long long result = a - b;
+#endif
+        out = result;
+        return Status::Ok;
+    }
+
+    inline Status mulChecked(long long a, long long b, long long& out) {
+#ifdef DATEPP_OVERFLOW_BUILTINS
+        long long result;
+        if (__builtin_mul_overflow(a, b, &result)) return Status::Overflow;
+#else
+        constexpr long long max = std::numeric_limits<long long>::max(), min = std::numeric_limits<long long>::min();
+        if (a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : (a != 0 && b < max / a)))
+            return Status::Overflow;
+        long long result = a * b;
+#endif
+        out = result;
+        return Status::Ok;
+    }
+
+    // Truncates like `/`.
+    inline Status divChecked(long long a, long long b, long long& out) {
+        if (b == 0) return Status::DivisionByZero;
+        if (a == std::numeric_limits<long long>::min() && b == -1) return Status::Overflow;
+        out = a / b;
+        return Status::Ok;
+    }
+
+    inline long long addSaturating(long long a, long long b) {
+        long long result;
+        if (addChecked(a, b, result) == Status::Ok) return result;
+        return b > 0 ? std::numeric_limits<long long>::max() : std::numeric_limits<long long>::min();
+    }
+
+    inline long long subSaturating(long long a, long long b) {
+        long long result;
+        if (subChecked(a, b, result) == Status::Ok) return result;
+        return b < 0 ? std::numeric_limits<long long>::max() : std::numeric_limits<long long>::min();
+    }
+
+    inline long long mulSaturating(long long a, long long b) {
+        long long result;
+        if (mulChecked(a, b, result) == Status::Ok) return result;
+        return (a < 0) == (b < 0) ? std::numeric_limits<long long>::max() : std::numeric_limits<long long>::min();
+    }
+
+    // Length of `step` in seconds; Status::InvalidArgument for month and year steps, which have no fixed length.
+    inline Status lengthInSecondsChecked(const RangeStep& step, long long& out) {
+        static const long long lengths[5] = {1, 60, 3600, 86400, 604800};
+        if (step.isCalendar())
+            return Status::InvalidArgument;
+        return mulChecked(lengths[static_cast<int>(step.unit)], step.count, out);
+    }
+
+    /*
+     * `_unix` moved by `step` (which may be negative), like one step of a DateTimeRange:
+     * month and year steps are applied to the civil time in `timezoneOffset`, and the day
+     * is clamped to the length of the month (31.01 + 1 month = 28.02 or 29.02).
+     */
+    inline Status advanceChecked(long long _unix, const RangeStep& step, long long& out, timezone_offset_t timezoneOffset = 0.0) {
+        long long result;
+        if (!step.isCalendar()) {
+            long long seconds;
+            if (lengthInSecondsChecked(step, seconds) != Status::Ok || addChecked(_unix, seconds, result) != Status::Ok)
+                return Status::Overflow;
+            out = result;
+            return Status::Ok;
+        }
+
+        // Past ~2.9e11 years the seconds don't fit in `long long` anyway; this keeps daysFromCivil from overflowing.
+        constexpr long long maxYear = 300000000000LL;
+        const long long timezoneSeconds = static_cast<long long>(timezoneOffset * 3600);
+        long long local, months, totalMonths;
+        if (addChecked(_unix, timezoneSeconds, local) != Status::Ok
+            || mulChecked(step.count, step.unit == RangeStep::Unit::Year ? 12 : 1, months) != Status::Ok)
+            return Status::Overflow;
+
+        const long long days = floorDiv(local, 86400);
+        const long long secondsOfDay = local - days * 86400;
+        const CivilDate date = civilDateFromDays(days);
+        if (addChecked(date.year * 12 + date.month, months, totalMonths) != Status::Ok)
+            return Status::Overflow;
+
+        const long long year = floorDiv(totalMonths, 12);
+        const month_t month = static_cast<month_t>(totalMonths - year * 12);
+        if (year > maxYear || year < -maxYear)
+            return Status::Overflow;
+        const day_t monthDays = daysInMonth(year, month);
+        const long long newDays = daysFromCivil(year, month, date.day < monthDays ? date.day : static_cast<day_t>(monthDays - 1));
+
+        if (mulChecked(newDays, 86400, result) != Status::Ok || addChecked(result, secondsOfDay - timezoneSeconds, result) != Status::Ok)
+            return Status::Overflow;
+        out = result;
+        return Status::Ok;
+    }
+
+    namespace detail {
+        // For the operators of DateTime, which can't return a Status.
+        inline void throwIfFailed(Status status) {
+            if (status == Status::DivisionByZero)
+                throw std::domain_error("Division of a DateTime by zero.");
+            if (status != Status::Ok)
+                throw std::overflow_error("DateTime arithmetic overflowed.");
+        }
+    }
+
+    // First and last unix timestamps whose year fits in `year_t` (in UTC).
+    constexpr long long minDateTimeUnix = daysFromCivil(std::numeric_limits<year_t>::min(), 0, 0) * 86400;
+    constexpr long long maxDateTimeUnix = daysFromCivil(std::numeric_limits<year_t>::max() + 1LL, 0, 0) * 86400 - 1;
+
+    /*
+     * -------------------
+     * CALENDAR DIFFERENCE
+     * -------------------
+     *
+     * Differences between two timestamps in calendar units (the "age" of `from` at `to`),
+     * computed from the civil fields of both ends in constant time instead of looping over months.
+     * Both ends are read in the same UTC offset. Moving `from` by the years and months
+     * (clamping the day, like advanceChecked), then by the days and the time gives `to`.
+     * When `to` is before `from`, the result is the negated difference from `to` to `from`.
+     */
+    struct CalendarDifference {
+        long long years = 0;
+        int months = 0;  // [-11, 11]
+        int days = 0;    // [-30, 30]
+        int hours = 0;
+        int minutes = 0;
+        int seconds = 0;
+
+        long long totalMonths() const { return this->years * 12 + this->months; }
+
+        bool operator==(const CalendarDifference& other) const {
+            return this->years == other.years && this->months == other.months && this->days == other.days
+                && this->hours == other.hours && this->minutes == other.minutes && this->seconds == other.seconds;
+        }
+        bool operator!=(const CalendarDifference& other) const { return !(*this == other); }
+    };
+
+    namespace detail {
+        // Both in local seconds, `from` <= `to`.
+        inline CalendarDifference forwardDifference(long long from, long long to) {
+            const long long fromDays = floorDiv(from, 86400);
+            long long toDays = floorDiv(to, 86400);
+            const long long fromSeconds = from - fromDays * 86400;
+            long long toSeconds = to - toDays * 86400;
+            if (toSeconds < fromSeconds) { // Borrow a day for the time
+                toSeconds += 86400;
+                --toDays;
+            }
+
+            const CivilDate start = civilDateFromDays(fromDays);
+            const CivilDate end = civilDateFromDays(toDays);
+            long long months = (end.year - start.year) * 12 + end.month - start.month;
+            if (end.day < start.day) // The last month isn't complete
+                --months;
+
+            // `from` moved by the whole months, with the day clamped to the month
+            const long long monthIndex = start.year * 12 + start.month + months;
+            const long long year = floorDiv(monthIndex, 12);
+            const month_t month = static_cast<month_t>(monthIndex - year * 12);
+            const day_t monthDays = daysInMonth(year, month);
+            const long long anchorDays = daysFromCivil(year, month, start.day < monthDays ? start.day : static_cast<day_t>(monthDays - 1));
+
+            const int seconds = static_cast<int>(toSeconds - fromSeconds);
+            CalendarDifference difference;
+            difference.years = months / 12;
+            difference.months = static_cast<int>(months % 12);
+            difference.days = static_cast<int>(toDays - anchorDays);
+            difference.hours = seconds / 3600;
+            difference.minutes = seconds / 60 % 60;
+            difference.seconds = seconds % 60;
+            return difference;
+        }
+    }
+
+    inline CalendarDifference calendarDifference(long long from, long long to, timezone_offset_t timezoneOffset = 0.0) {
+        const long long timezoneSeconds = static_cast<long long>(timezoneOffset * 3600);
+        if (from <= to)
+            return detail::forwardDifference(from + timezoneSeconds, to + timezoneSeconds);
+
+        CalendarDifference difference = detail::forwardDifference(to + timezoneSeconds, from + timezoneSeconds);
+        difference.years = -difference.years;
+        difference.months = -difference.months;
+        difference.days = -difference.days;
+        difference.hours = -difference.hours;
+        difference.minutes = -difference.minutes;
+        difference.seconds = -difference.seconds;
+        return difference;
+    }
+
+    // Whole months from `from` to `to` (rounded toward zero); 31.01 to 28.02 is 0 months, to 29.02 as well.
+    inline long long monthsBetween(long long from, long long to, timezone_offset_t timezoneOffset = 0.0) {
+        return calendarDifference(from, to, timezoneOffset).totalMonths();
+    }
+
+    inline long long yearsBetween(long long from, long long to, timezone_offset_t timezoneOffset = 0.0) {
+        return monthsBetween(from, to, timezoneOffset) / 12;
+    }
+
+    // Whole days (rounded toward zero); with a fixed UTC offset every day has 86400 seconds, so it doesn't matter.
+    // Days and seconds are subtracted separately, so `to - from` can't overflow.
+    inline long long daysBetween(long long from, long long to) {
+        long long days = to / 86400 - from / 86400;
+        const long long seconds = to % 86400 - from % 86400;
+        days += seconds / 86400;
+        if (days > 0 && seconds % 86400 < 0) --days;
+        else if (days < 0 && seconds % 86400 > 0) ++days;
+        return days;
+    }
+
+    // Element-wise over columns of `count` pairs.
+    inline void calendarDifference(const long long* from, const long long* to, size_t count, CalendarDifference* out,
+                                   timezone_offset_t timezoneOffset = 0.0) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = calendarDifference(from[i], to[i], timezoneOffset);
+    }
+
+    inline void monthsBetween(const long long* from, const long long* to, size_t count, long long* out,
+                              timezone_offset_t timezoneOffset = 0.0) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = monthsBetween(from[i], to[i], timezoneOffset);
+    }
+
+    inline void daysBetween(const long long* from, const long long* to, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = daysBetween(from[i], to[i]);
+    }
+
+    class DateTime {
+    private:
+        friend struct RangePoint;
+
         // Store constructor inputs for easier conversion back to unix timestamp.
-        char* unix_lit;
         std::string unix_str;
+        long long unix_time = 0;
 
         // Day Of The Week (or DOTW).
         enum class DOTW {
             Sunday = 0, Monday = 1, Tuesday = 2, Wednesday = 3, Thursday = 4, Friday = 5, Saturday = 6
         };
-        const std::unordered_map<DOTW, std::string> dotwStrMap {
-            {DOTW::Sunday, "Sunday"},
-            {DOTW::Monday, "Monday"},
-            {DOTW::Tuesday, "Tuesday"},
-            {DOTW::Wednesday, "Wednesday"},
-            {DOTW::Thursday, "Thursday"},
-            {DOTW::Friday, "Friday"},
-            {DOTW::Saturday, "Saturday"}
-        };
-        const std::unordered_map<month_t, std::string> monthsStrMap {
-            {0, "January"},
-            {1, "February"},
-            {2, "March"},
-            {3, "April"},
-            {4, "May"},
-            {5, "June"},
-            {6, "July"},
-            {7, "August"},
-            {8, "September"},
-            {9, "October"},
-            {10, "November"},
-            {11, "December"},
-        };
+        // Names are looked up with `dotwName` and `monthName` (see CALENDAR CORE).
 
         /*
          * Those default values represent `Thu, 01/01/1970 00:00:00 +00 UTC`.
@@ -181,14 +2380,14 @@ namespace beliumgl {
          * Don't worry if you see days and months as 0;
          * they'll still be interpreted as 'first', like array indexes.
          */
-        const year_t defYears = 1970;
-        const month_t defMonth = 0;
-        const day_t defDays = 0;
-        const hour_t defHours = 0;
-        const minute_t defMinutes = 0;
-        const second_t defSeconds = 0;
-        const timezone_offset_t defTimezoneOffset = 0;
-        const size_t shortStrLength = 3;
+        static constexpr year_t defYears = 1970;
+        static constexpr month_t defMonth = 0;
+        static constexpr day_t defDays = 0;
+        static constexpr hour_t defHours = 0;
+        static constexpr minute_t defMinutes = 0;
+        static constexpr second_t defSeconds = 0;
+        static constexpr timezone_offset_t defTimezoneOffset = 0;
+        static constexpr size_t shortStrLength = 3;
 
         year_t years = 1970;
         month_t months = 0;
@@ -204,104 +2403,26 @@ namespace beliumgl {
          * HELPERS
          * -------
          */
-        template<typename T>
-        inline std::string padZeros(T num) {
-            if (num >= 0)
-                return (num < 10 ? "0" : "") + std::to_string(static_cast<T>(num));
-            else
-                return (num > -10 ? "-0" : "") + std::to_string(static_cast<T>(num * -1));
-        }
-
-        inline bool isLeapYear(year_t year) {
-            return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
-        }
-
-        day_t daysInMonth(year_t year, month_t month) {
-            if (month < 0 || month > 11)
-                throw std::invalid_argument("Invalid month (must be 0-11)");
-
-            static constexpr std::array<day_t, 12> days =
-            {31,28,31,30,31,30,31,31,30,31,30,31};
-            return (month == 1 && isLeapYear(year)) ? 29 : days[month];
-        }
-
-         DOTW dotwByDate(year_t year, month_t month, day_t day) {
-            if (month < 1 || month > 12)
-                throw std::invalid_argument("Month must be 1-12");
-
-            day_t max_day = daysInMonth(year, month - 1);
-            if (day < 1 || day > max_day)
-                throw std::invalid_argument("Invalid day for month");
-
-            int m = month;
-            int y = year;
-            if (m < 3) {
-                m += 12;
-                y -= 1;
-            }
-
-            int q = day;
-            int K = y % 100;
-            int J = y / 100;
-
-            int h = (q + 13*(m + 1)/5 + K + K/4 + J/4 + 5*J) % 7;
-            return static_cast<DOTW>((h - 1 + 7) % 7);
-        }
-
         void parseUnix(long long _unix, timezone_offset_t timezoneOffset) {
-            constexpr int secondsInDay = 86400;
-            constexpr int secondsInHour = 3600;
-            constexpr int secondsInMinute = 60;
-
-            long long timezoneSeconds = static_cast<long long>(timezoneOffset * secondsInHour);
-            long long adjustedUnix = _unix + timezoneSeconds;
-            long long days = adjustedUnix / secondsInDay;
-            int remainderSeconds = static_cast<int>(adjustedUnix % secondsInDay);
-
-            if (remainderSeconds < 0) {
-                remainderSeconds += secondsInDay;
-                days -= 1;
-            }
-
-            year_t year = this->defYears;
-            if (days >= 0) {
-                while (true) {
-                    unsigned short daysInYear = isLeapYear(year) ? 366 : 365;
-                    if (days >= daysInYear) {
-                        days -= daysInYear;
-                        ++year;
-                    } else break;
-                }
-            } else {
-                while (days < 0) {
-                    year_t prevYear = year - 1;
-                    unsigned short daysInYear = isLeapYear(prevYear) ? 366 : 365;
-                    days += daysInYear;
-                    --year;
-                }
-            }
-
-            month_t month = this->defMonth;
-            while (true) {
-                day_t monthDays = daysInMonth(year, month);
-                if (days >= monthDays) {
-                    days -= monthDays;
-                    ++month;
-                } else break;
-            }
-
-            int hours = remainderSeconds / secondsInHour;
-            remainderSeconds %= secondsInHour;
-            int minutes = remainderSeconds / secondsInMinute;
-            int seconds = remainderSeconds % secondsInMinute;
+            CivilTime time = decompose(_unix, timezoneOffset);
+            DATEPP_COUNT_PARSE_UNIX(time.year);
+
+            this->years = static_cast<year_t>(time.year);
+            this->months = time.month;
+            this->days = time.day;
+            this->hours = time.hour;
+            this->minutes = time.minute;
+            this->seconds = time.second;
+            this->dotw = static_cast<DOTW>(time.dotw);
+        }
 
-            this->years = year;
-            this->months = month;
-            this->days = days;
-            this->hours = hours;
-            this->minutes = minutes;
-            this->seconds = seconds;
-            this->dotw = dotwByDate(year, month + 1, days + 1);
+        // Used by RangePoint, which already knows the civil time.
+        DateTime(const CivilTime& time, long long _unix)
+        : unix_str(std::to_string(_unix)), unix_time(_unix), years(static_cast<year_t>(time.year)), months(time.month),
+        dotw(static_cast<DOTW>(time.dotw)), days(time.day), hours(time.hour), minutes(time.minute), seconds(time.second),
+        timezoneOffset(time.timezoneOffset) {
+            DATEPP_COUNT(DateTimeConstructions);
+            DATEPP_COUNT_STRING(this->unix_str);
         }
     public:
         /*
@@ -309,6 +2430,11 @@ namespace beliumgl {
          * and string class from C++ STL.
          *
          * Optionally, you can explicitly provide timezone offset (you’ll still be able to use different offsets).
+         *
+         * All const member functions (accessors, `toString`, `toStringLit`, comparisons and arithmetic)
+         * only read the object and use no shared mutable state, so one `const DateTime&`
+         * can be formatted from any number of threads at the same time without copying it.
+         * Writing to an object (e.g. assigning to it) while other threads read it still needs synchronization.
          */
 
         /*
@@ -318,15 +2444,29 @@ namespace beliumgl {
          */
         DateTime(char* _unix, timezone_offset_t timezoneOffset = 0.0);
         DateTime(const std::string& _unix, timezone_offset_t timezoneOffset = 0.0);
+        DateTime(long long _unix, timezone_offset_t timezoneOffset = 0.0);
 
-        char* toStringLit(char* format = "W, DD/MM/YY, HH:II:SS O UTC");
-        char* toStringLit(const std::string& format = "W, DD/MM/YY, HH:II:SS O UTC"); // Return a string in specified format
-        char* toStringLit(const DateTimeFormat& format = "W, DD/MM/YY, HH:II:SS O UTC");
-        char* toUnixLit() const { return this->unix_lit; };
-        std::string toString(char* format = "W, DD/MM/YY, HH:II:SS O UTC");
-        std::string toString(const std::string& format = "W, DD/MM/YY, HH:II:SS O UTC"); // Return a string in specified format
-        std::string toString(const DateTimeFormat& format = "W, DD/MM/YY, HH:II:SS O UTC");
+        /*
+         * Every `step` from `begin` (inclusive) to `end` (exclusive), stepping in the civil time
+         * of `begin`'s UTC offset. See DateTimeRange.
+         */
+        static DateTimeRange range(const DateTime& begin, const DateTime& end, RangeStep step);
+
+        char* toStringLit(char* format = "W, DD/MM/YY, HH:II:SS O UTC") const;
+        char* toStringLit(const std::string& format = "W, DD/MM/YY, HH:II:SS O UTC") const; // Return a string in specified format
+        char* toStringLit(const DateTimeFormat& format = "W, DD/MM/YY, HH:II:SS O UTC") const;
+        char* toUnixLit() const { return const_cast<char*>(this->unix_str.c_str()); };
+        std::string toString(char* format = "W, DD/MM/YY, HH:II:SS O UTC") const;
+        std::string toString(const std::string& format = "W, DD/MM/YY, HH:II:SS O UTC") const; // Return a string in specified format
+        std::string toString(const DateTimeFormat& format = "W, DD/MM/YY, HH:II:SS O UTC") const;
         std::string toUnix() const { return this->unix_str; };
+        // Same as `toString`, but the result is stored inline and never allocates.
+        FormattedDateTime toFixedString(const DateTimeFormat& format) const {
+            DATEPP_COUNT(ToStringCalls);
+            DATEPP_TIME(ToString);
+            return FormattedDateTime::format(this->civil(), format);
+        }
+        long long unixTime() const { return this->unix_time; };
 
         year_t year() const { return this->years; };
         month_t month() const { return this->months; };
@@ -338,6 +2478,20 @@ namespace beliumgl {
         second_t second() const { return this->seconds; };
         timezone_offset_t offsetUTC() const { return this->timezoneOffset; };
 
+        // All fields at once, for the allocation-free functions (`formatTo`, etc.).
+        CivilTime civil() const {
+            CivilTime time;
+            time.year = this->years;
+            time.month = this->months;
+            time.day = this->days;
+            time.hour = this->hours;
+            time.minute = this->minutes;
+            time.second = this->seconds;
+            time.dotw = static_cast<unsigned char>(this->dotw);
+            time.timezoneOffset = this->timezoneOffset;
+            return time;
+        }
+
         /*
          * Rename of the same functions
          */
@@ -354,36 +2508,325 @@ namespace beliumgl {
         bool operator==(const DateTime& other) const;
         bool operator<=(const DateTime& other) const;
         bool operator>=(const DateTime& other) const;
+        // Throw std::overflow_error if the unix timestamp overflows and std::domain_error when dividing by 0;
+        // the `...Checked` versions below return a Status instead.
         DateTime operator+(const DateTime& other) const;
         DateTime operator-(const DateTime& other) const;
         DateTime operator*(const DateTime& other) const;
         DateTime operator/(const DateTime& other) const;
+
+        /*
+         * --------------
+         * EXCEPTION-FREE
+         * --------------
+         *
+         * Like the constructors and the operators (see CHECKED ARITHMETIC), but errors are returned as a Status
+         * (and `out` is left untouched) instead of throwing or overflowing. Results must have
+         * a year that fits in `year_t`, otherwise Status::OutOfRange is returned.
+         */
+        static Status fromUnix(long long _unix, DateTime& out, timezone_offset_t timezoneOffset = 0.0);
+        // An optionally signed decimal unix timestamp, the whole string.
+        static Status parse(const char* str, size_t length, DateTime& out, timezone_offset_t timezoneOffset = 0.0);
+
+        Status addChecked(const DateTime& other, DateTime& out) const;
+        Status subChecked(const DateTime& other, DateTime& out) const;
+        Status mulChecked(const DateTime& other, DateTime& out) const;
+        Status divChecked(const DateTime& other, DateTime& out) const;
+        // Moves by `step` in this date's UTC offset, which the result keeps.
+        Status advanceChecked(const RangeStep& step, DateTime& out) const;
+
+        // Clamped to [minDateTimeUnix, maxDateTimeUnix].
+        DateTime addSaturating(const DateTime& other) const;
+        DateTime subSaturating(const DateTime& other) const;
+        DateTime mulSaturating(const DateTime& other) const;
+
+        /*
+         * -------------------
+         * CALENDAR DIFFERENCE
+         * -------------------
+         *
+         * From this date to `to`, both read in this date's UTC offset.
+         */
+        CalendarDifference calendarDifference(const DateTime& to) const {
+            return beliumgl::calendarDifference(this->unix_time, to.unix_time, this->timezoneOffset);
+        }
+        long long monthsBetween(const DateTime& to) const { return beliumgl::monthsBetween(this->unix_time, to.unix_time, this->timezoneOffset); }
+        long long yearsBetween(const DateTime& to) const { return beliumgl::yearsBetween(this->unix_time, to.unix_time, this->timezoneOffset); }
+        long long daysBetween(const DateTime& to) const { return beliumgl::daysBetween(this->unix_time, to.unix_time); }
+    };
+
+    /*
+     * One step of a DateTimeRange: its calendar fields, unix timestamp and index in the range.
+     * Iterating yields these instead of DateTimes, so a step costs no allocation;
+     * `toDateTime()` builds a DateTime when one is needed.
+     */
+    struct RangePoint {
+        CivilTime civil;
+        long long unixTime = 0;
+        long long index = 0;
+
+        // The range checked that the year fits in `year_t`.
+        DateTime toDateTime() const { return DateTime(this->civil, this->unixTime); }
+    };
+
+    /*
+     * Range of dates for range-based for loops, e.g.:
+     *
+     *     for (const RangePoint& point : DateTime::range(begin, end, RangeStep::days(1)))
+     *         std::cout << FormattedDateTime::format(point.civil, format).c_str() << std::endl;
+     *
+     * Each step updates the calendar fields of the previous one (carrying seconds into days,
+     * days into months, and so on) instead of converting the timestamp from scratch.
+     * The whole range (and one step) must fit in `year_t` years, otherwise the constructor throws std::out_of_range.
+     *
+     * The number of steps is known up front, so the range can be split into `chunk`s
+     * to be processed in parallel; every chunk iterates exactly like the full range would.
+     */
+    class DateTimeRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = RangePoint;
+            using difference_type = long long;
+            using pointer = const RangePoint*;
+            using reference = const RangePoint&;
+
+            const RangePoint& operator*() const { return this->point; }
+            const RangePoint* operator->() const { return &this->point; }
+            const CivilTime& civil() const { return this->point.civil; }
+            long long unixTime() const { return this->point.unixTime; }
+            long long index() const { return this->point.index; }
+
+            iterator& operator++() {
+                ++this->point.index;
+                if (this->step.isCalendar())
+                    this->moveTo(this->point.index);
+                else
+                    this->advance(this->step.lengthInSeconds());
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const iterator& other) const { return this->point.index == other.point.index; }
+            bool operator!=(const iterator& other) const { return this->point.index != other.point.index; }
+        private:
+            friend class DateTimeRange;
+
+            RangeStep step;
+            CivilTime anchor;       // First date of the whole range
+            long long anchorDays = 0;
+            int anchorSeconds = 0;
+            long long anchorUnix = 0;
+
+            RangePoint point;
+            long long days = 0;     // Local day number of `point`
+            int secondsOfDay = 0;
+
+            // Adds a fixed number of seconds, rolling the calendar fields over.
+            void advance(long long seconds) {
+                constexpr int secondsInDay = 86400;
+
+                this->point.unixTime += seconds;
+                long long carry = seconds / secondsInDay;
+                this->secondsOfDay += static_cast<int>(seconds % secondsInDay);
+                if (this->secondsOfDay >= secondsInDay) {
+                    this->secondsOfDay -= secondsInDay;
+                    ++carry;
+                }
+                setTimeOfDay(this->point.civil, this->secondsOfDay);
+                if (carry == 0)
+                    return;
+
+                this->days += carry;
+                this->point.civil.dotw = static_cast<unsigned char>((this->point.civil.dotw + carry % 7) % 7);
+                if (carry > 366) {
+                    civilFromDays(this->days, this->point.civil.year, this->point.civil.month, this->point.civil.day);
+                    return;
+                }
+
+                carry += this->point.civil.day;
+                for (day_t monthDays = daysInMonth(this->point.civil.year, this->point.civil.month); carry >= monthDays;
+                     monthDays = daysInMonth(this->point.civil.year, this->point.civil.month)) {
+                    carry -= monthDays;
+                    if (++this->point.civil.month == 12) {
+                        this->point.civil.month = 0;
+                        ++this->point.civil.year;
+                    }
+                }
+                this->point.civil.day = static_cast<day_t>(carry);
+            }
+
+            // Jumps straight to step `index` of the range.
+            void moveTo(long long index) {
+                this->point.index = index;
+                if (!this->step.isCalendar()) {
+                    this->point.civil = this->anchor;
+                    this->days = this->anchorDays;
+                    this->secondsOfDay = this->anchorSeconds;
+                    this->point.unixTime = this->anchorUnix;
+                    long long seconds;
+                    if (mulChecked(index, this->step.lengthInSeconds(), seconds) != Status::Ok)
+                        throw std::out_of_range("Range index is out of range.");
+                    this->advance(seconds);
+                    return;
+                }
+
+                this->point.civil = this->anchor;
+                this->secondsOfDay = this->anchorSeconds;
+                long long months;
+                if (mulChecked(index, this->step.count * (this->step.unit == RangeStep::Unit::Year ? 12 : 1), months) != Status::Ok
+                    || months > maxRangeMonths || months < -maxRangeMonths)
+                    throw std::out_of_range("Range index is out of range.");
+                months += this->anchor.month;
+                this->point.civil.year = this->anchor.year + floorDiv(months, 12);
+                this->point.civil.month = static_cast<month_t>(months - floorDiv(months, 12) * 12);
+                day_t monthDays = daysInMonth(this->point.civil.year, this->point.civil.month);
+                this->point.civil.day = this->anchor.day < monthDays ? this->anchor.day : static_cast<day_t>(monthDays - 1);
+
+                this->days = daysFromCivil(this->point.civil.year, this->point.civil.month, this->point.civil.day);
+                this->point.civil.dotw = weekdayFromDays(this->days);
+                this->point.unixTime = this->anchorUnix + (this->days - this->anchorDays) * 86400;
+            }
+        };
+
+        DateTimeRange(long long begin, long long end, RangeStep step, timezone_offset_t timezoneOffset = 0.0) : step(step) {
+            if (step.count <= 0)
+                throw std::invalid_argument("Range step must be positive.");
+            // A step or a span longer than all `year_t` years can't fit; bounding them keeps the step arithmetic from overflowing.
+            long long length, span;
+            if (step.isCalendar() ? step.count > maxRangeMonths / (step.unit == RangeStep::Unit::Year ? 12 : 1)
+                                  : lengthInSecondsChecked(step, length) != Status::Ok || length > maxRangeSeconds)
+                throw std::out_of_range("Range step is longer than the years of `year_t`.");
+            if (end > begin && (subChecked(end, begin, span) != Status::Ok || span > 2 * maxRangeSeconds))
+                throw std::out_of_range("Range doesn't fit in `year_t` years.");
+
+            this->start.step = step;
+            this->start.anchor = decompose(begin, timezoneOffset);
+            this->start.anchorDays = splitUnix(begin, timezoneOffset, this->start.anchorSeconds);
+            this->start.anchorUnix = begin;
+            this->start.moveTo(0);
+            this->last = stepsBefore(end);
+
+            const long long lastYear = this->last > 0 ? at(this->last - 1).civil().year : this->start.anchor.year;
+            if (this->start.anchor.year < std::numeric_limits<year_t>::min() || lastYear > std::numeric_limits<year_t>::max())
+                throw std::out_of_range("Range doesn't fit in `year_t` years.");
+        }
+
+        iterator begin() const { return at(this->first); }
+        iterator end() const {
+            iterator result = this->start;
+            result.point.index = this->last;
+            return result;
+        }
+
+        long long size() const { return this->last - this->first; }
+        bool empty() const { return this->last == this->first; }
+
+        // Step `index` of the whole range (chunks keep the indexes of the range they come from).
+        // Throws std::out_of_range if the step is so far away that its time would overflow.
+        iterator at(long long index) const {
+            iterator result = this->start;
+            result.moveTo(index);
+            return result;
+        }
+
+        // Part `index` of `chunks` nearly equal parts of the range.
+        DateTimeRange chunk(size_t index, size_t chunks) const {
+            if (chunks == 0 || index >= chunks)
+                throw std::out_of_range("Invalid chunk index.");
+
+            long long count = size();
+            DateTimeRange result = *this;
+            result.first = this->first + count * static_cast<long long>(index) / static_cast<long long>(chunks);
+            result.last = this->first + count * static_cast<long long>(index + 1) / static_cast<long long>(chunks);
+            return result;
+        }
+    private:
+        static constexpr long long maxRangeSeconds = maxDateTimeUnix - minDateTimeUnix + 1;
+        static constexpr long long maxRangeMonths = (std::numeric_limits<year_t>::max() - std::numeric_limits<year_t>::min() + 1LL) * 12;
+
+        RangeStep step;
+        iterator start;
+        long long first = 0, last = 0;
+
+        // Number of steps before the unix timestamp `end`.
+        long long stepsBefore(long long end) const {
+            long long begin = this->start.anchorUnix;
+            if (end <= begin)
+                return 0;
+            if (!this->step.isCalendar()) {
+                long long length = this->step.lengthInSeconds();
+                return (end - begin + length - 1) / length;
+            }
+
+            // Estimate with the average length of a month, then correct it.
+            long long monthsPerStep = this->step.count * (this->step.unit == RangeStep::Unit::Year ? 12 : 1);
+            long long count = (end - begin) / (2629746LL * monthsPerStep);
+            while (count > 0 && at(count).unixTime() >= end) --count;
+            while (at(count).unixTime() < end) ++count;
+            return count;
+        }
     };
 
+    inline DateTimeRange DateTime::range(const DateTime& begin, const DateTime& end, RangeStep step) {
+        return DateTimeRange(begin.unixTime(), end.unixTime(), step, begin.offsetUTC());
+    }
+
     /*
      * ---------------
      * IMPLEMENTATIONS
      * ---------------
      */
-    DateTime::DateTime(char* _unix, timezone_offset_t timezoneOffset)
-    : unix_lit(_unix), unix_str(std::string(_unix)), timezoneOffset(timezoneOffset) {
+    namespace detail {
+        // Appends the contents of the file to `out`; false if it can't be read. Used by LeapSecondTable and TimeZone.
+        DATEPP_DECL bool readFile(const std::string& path, std::string& out);
+    }
+
+#if !defined(DATEPP_SEPARATE_COMPILATION) || defined(DATEPP_IMPLEMENTATION)
+    DATEPP_DECL DateTime::DateTime(char* _unix, timezone_offset_t timezoneOffset)
+    : unix_str(std::string(_unix)), timezoneOffset(timezoneOffset) {
+        DATEPP_COUNT(DateTimeConstructions);
+        DATEPP_TIME(DateTimeConstruction);
+        DATEPP_COUNT_STRING(this->unix_str);
         try {
-            parseUnix(std::strtoll(_unix, nullptr, 10), timezoneOffset);
+            this->unix_time = std::strtoll(_unix, nullptr, 10);
+            parseUnix(this->unix_time, timezoneOffset);
         } catch (...) {
             throw std::invalid_argument("Your unix timestamp is invalid.");
         }
     }
 
-    DateTime::DateTime(const std::string& _unix, timezone_offset_t timezoneOffset)
-    : unix_lit(const_cast<char*>(_unix.data())), unix_str(_unix), timezoneOffset(timezoneOffset) {
+    DATEPP_DECL DateTime::DateTime(const std::string& _unix, timezone_offset_t timezoneOffset)
+    : unix_str(_unix), timezoneOffset(timezoneOffset) {
+        DATEPP_COUNT(DateTimeConstructions);
+        DATEPP_TIME(DateTimeConstruction);
+        DATEPP_COUNT_STRING(this->unix_str);
         try {
-            parseUnix(std::stoll(_unix), timezoneOffset);
+            this->unix_time = std::stoll(_unix);
+            parseUnix(this->unix_time, timezoneOffset);
         } catch (...) {
             throw std::invalid_argument("Your unix timestamp is invalid.");
         }
     }
 
-    DateTimeFormat::DateTimeFormat(const std::string& format) {
+    DATEPP_DECL DateTime::DateTime(long long _unix, timezone_offset_t timezoneOffset)
+    : unix_str(std::to_string(_unix)), unix_time(_unix), timezoneOffset(timezoneOffset) {
+        DATEPP_COUNT(DateTimeConstructions);
+        DATEPP_TIME(DateTimeConstruction);
+        DATEPP_COUNT_STRING(this->unix_str);
+        parseUnix(_unix, timezoneOffset);
+    }
+
+    DATEPP_DECL DateTimeFormat::DateTimeFormat(const std::string& format) {
+        DATEPP_COUNT(FormatParses);
+        DATEPP_TIME(FormatParse);
+
         /*
          * I left a comment explaining how my format works in DateTimeFormat class,
          * so you can read it and understand how this code functions.
@@ -392,32 +2835,46 @@ namespace beliumgl {
         hourToken = 'h', minuteToken = 'i', secondToken = 's',
         timezoneOffsetToken = 'o', _12HoursToken = '_', alphabeticalMonthToken = 'a';
 
-        std::string newFormat = toLowercase(format);
-        std::string order;
+        // Spaces are ignored and tokens are case-insensitive; the pattern is read in place to avoid copying it.
+        auto lower = [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); };
+        auto nextToken = [&](size_t i) {
+            for (++i; i < format.length(); ++i)
+                if (format[i] != ' ') return static_cast<int>(lower(format[i]));
+            return -1;
+        };
 
-        removeAll(newFormat, ' ');
+        char order[3];
+        size_t orderLength = 0, orderTokens = 0;
 
         auto isOrderToken = [&](char c) {
             return c == dayToken || c == monthToken || c == yearToken || c == alphabeticalMonthToken;
         };
 
-        for (size_t i = 0; i < newFormat.length(); ++i) {
-            char token = newFormat[i];
+        for (size_t i = 0; i < format.length(); ++i) {
+            if (format[i] == ' ')
+                continue;
+            char token = lower(format[i]);
+            int next = nextToken(i);
 
             if (token == dotwToken) {
                 this->showDotw = true;
-                if (i + 1 < newFormat.length() && newFormat[i + 1] == dotwToken)
+                if (next == dotwToken)
                     this->fullNames = true;
                 continue;
             }
 
             if (isOrderToken(token)) {
-                order.push_back(token);
+                ++orderTokens;
+                if (std::find(order, order + orderLength, token) == order + orderLength) {
+                    if (orderLength == 3)
+                        throw std::runtime_error("Failed to generate order from string.");
+                    order[orderLength++] = token;
+                }
 
-                if (i + 1 < newFormat.length() && newFormat[i + 1] == token && !this->fillZeros)
+                if (next == token && !this->fillZeros)
                     this->fillZeros = true;
-                if (order.size() < 3 && i + 1 < newFormat.length())
-                    this->delimiter = newFormat[i + 1];
+                if (orderTokens < 3 && next != -1)
+                    this->delimiter = static_cast<char>(next);
 
                 if (token == alphabeticalMonthToken)
                     this->alphabeticalMonth = true;
@@ -427,7 +2884,7 @@ namespace beliumgl {
 
             if (token == hourToken || token == minuteToken || token == secondToken) {
                 this->showTime = true;
-                if (i + 1 < newFormat.length() && newFormat[i + 1] == token && !this->fillZeros)
+                if (next == token && !this->fillZeros)
                     this->fillZeros = true;
                 continue;
             }
@@ -443,116 +2900,61 @@ namespace beliumgl {
             }
         }
 
-        removeDuplicates(order);
-        if (order.length() != 3)
+        if (orderLength != 3)
             throw std::runtime_error("Failed to generate order from string.");
-        this->order = order;
+        this->order.assign(order, orderLength);
     }
 
-    std::string DateTime::toString(const DateTimeFormat& format){
-        constexpr char dayToken = 'd', monthToken = 'm', yearToken = 'y', alphabeticalMonthToken = 'a';
-        std::string result;
-
-        if (format.getShowDotw())
-            result += format.getFullNames()
-                ? this->dotwStrMap.at(this->dotw) + ", "
-                : this->dotwStrMap.at(this->dotw).substr(0, this->shortStrLength) + ", ";
-
-        std::string order = format.getOrder();
-        for (size_t i = 0; i < order.length(); ++i) {
-            switch (order[i]) {
-                case dayToken:
-                    result += format.getFillZeros()
-                        ? padZeros(this->days + 1)
-                        : std::to_string(this->days + 1);
-                    break;
-                case monthToken:
-                    result += format.getFillZeros()
-                        ? padZeros(this->months + 1)
-                        : std::to_string(this->months + 1);
-                    break;
-                case alphabeticalMonthToken:
-                    result += format.getFullNames()
-                        ? this->monthsStrMap.at(this->months)
-                        : this->monthsStrMap.at(this->months).substr(0, this->shortStrLength);
-                    break;
-                case yearToken:
-                    result += std::to_string(this->years);
-                    break;
-            }
-            result += format.getDelimiter();
-        }
-        result[result.length() - 1] = ' '; // Replace the last delimiter with space
-
-        if (format.getShowTime()) {
-            bool am = this->hours < 12;
-            hour_t hours12 = this->hours % 12;
-            if (hours12 == 0) hours12 = 12;
-
-            if (format.get12HourFormat()) {
-                result += format.getFillZeros()
-                    ? padZeros(hours12) + ":"
-                    : std::to_string(hours12) + ":";
-            } else {
-                result += format.getFillZeros()
-                    ? padZeros(this->hours) + ":"
-                    : std::to_string(this->hours) + ":";
-            }
-            result += format.getFillZeros() ? padZeros(this->minutes) + ":" : std::to_string(this->minutes) + ":";
-            result += format.getFillZeros() ? padZeros(this->seconds) + " " : std::to_string(this->seconds) + " ";
-
-            if (format.get12HourFormat()) {
-                result += am ? "AM " : "PM ";
-            }
-        }
-
-        if (format.getShowUTCoffset()) {
-            bool isPositive = this->timezoneOffset >= 0;
-
-            result += isPositive ? "+" : "";
-            result += format.getFillZeros() ? padZeros(this->timezoneOffset) + " UTC" : std::to_string(this->timezoneOffset) + " UTC";
+    DATEPP_DECL std::string DateTime::toString(const DateTimeFormat& format) const {
+        DATEPP_COUNT(ToStringCalls);
+        DATEPP_TIME(ToString);
+
+        CivilTime time = civil();
+        char buffer[128];
+        size_t length = formatTo(buffer, sizeof(buffer), time, format);
+        if (length < sizeof(buffer)) {
+            std::string result(buffer, length);
+            DATEPP_COUNT_STRING(result);
+            return result;
         }
 
+        std::string result(length + 1, '\0');
+        DATEPP_COUNT(HeapAllocations);
+        formatTo(&result[0], result.size(), time, format);
+        result.resize(length);
         return result;
     }
 
-    char* DateTime::toStringLit(char* format) {
-        std::string tmp = toString(DateTimeFormat(format));
-        char* buf = new char[tmp.size() + 1];
-        std::copy(tmp.begin(), tmp.end(), buf);
-        buf[tmp.size()] = '\0';
-        return buf;
+    DATEPP_DECL char* DateTime::toStringLit(char* format) const {
+        return toStringLit(DateTimeFormat(format));
     }
 
-    char* DateTime::toStringLit(const std::string& format) {
-        std::string tmp = toString(DateTimeFormat(format));
-        char* buf = new char[tmp.size() + 1];
-        std::copy(tmp.begin(), tmp.end(), buf);
-        buf[tmp.size()] = '\0';
-        return buf;
+    DATEPP_DECL char* DateTime::toStringLit(const std::string& format) const {
+        return toStringLit(DateTimeFormat(format));
     }
 
-    char* DateTime::toStringLit(const DateTimeFormat& format) {
-        std::string tmp = toString(format);
-        char* buf = new char[tmp.size() + 1];
-        std::copy(tmp.begin(), tmp.end(), buf);
-        buf[tmp.size()] = '\0';
+    DATEPP_DECL char* DateTime::toStringLit(const DateTimeFormat& format) const {
+        CivilTime time = civil();
+        size_t length = formatTo(nullptr, 0, time, format);
+        char* buf = new char[length + 1];
+        DATEPP_COUNT(HeapAllocations);
+        formatTo(buf, length + 1, time, format);
         return buf;
     }
 
-    std::string DateTime::toString(char* format) {
+    DATEPP_DECL std::string DateTime::toString(char* format) const {
         return toString(DateTimeFormat(format));
     }
 
-    std::string DateTime::toString(const std::string& format) {
+    DATEPP_DECL std::string DateTime::toString(const std::string& format) const {
         return toString(DateTimeFormat(format));
     }
 
-    std::string DateTime::dayOfTheWeekendStr(bool full) const {
+    DATEPP_DECL std::string DateTime::dayOfTheWeekendStr(bool full) const {
         if (static_cast<unsigned char>(this->dotw) > 6)
             throw std::invalid_argument("Invalid day of the week.");
 
-        const std::string& result = this->dotwStrMap.at(this->dotw);
+        std::string result = dotwName(static_cast<unsigned char>(this->dotw));
 
         if (!full && this->shortStrLength > result.length())
             throw std::runtime_error("Short length is larger than the actual string.");
@@ -560,10 +2962,30 @@ namespace beliumgl {
         return full ? result : result.substr(0, this->shortStrLength);
     }
 
-    std::string DateTime::dotwStr(bool full) const {
+    DATEPP_DECL std::string DateTime::dotwStr(bool full) const {
         return dayOfTheWeekendStr(full);
     }
 
+    namespace detail {
+        DATEPP_DECL void printFixed(char* buffer, size_t size, double value) {
+            std::snprintf(buffer, size, "%f", value);
+        }
+
+        DATEPP_DECL bool readFile(const std::string& path, std::string& out) {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr)
+                return false;
+            char chunk[4096];
+            size_t length;
+            while ((length = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+                out.append(chunk, length);
+            const bool ok = std::ferror(file) == 0;
+            std::fclose(file);
+            return ok;
+        }
+    }
+#endif
+
     /*
      * --------------------
      * OPERATOR OVERLOADING
@@ -571,38 +2993,480 @@ namespace beliumgl {
      */
     // Since Unix timestamps are already in UTC, we can just compare them.
     inline bool DateTime::operator<(const DateTime& other) const {
-        return std::stoll(this->unix_str) < std::stoll(other.toUnix());
+        return this->unix_time < other.unixTime();
     }
 
     inline bool DateTime::operator>(const DateTime& other) const {
-         return std::stoll(this->unix_str) > std::stoll(other.toUnix());
+         return this->unix_time > other.unixTime();
     }
 
     inline bool DateTime::operator==(const DateTime& other) const {
-         return std::stoll(this->unix_str) == std::stoll(other.toUnix());
+         return this->unix_time == other.unixTime();
     }
 
     inline bool DateTime::operator<=(const DateTime& other) const {
-        return std::stoll(this->unix_str) <= std::stoll(other.toUnix());
+        return this->unix_time <= other.unixTime();
     }
 
     inline bool DateTime::operator>=(const DateTime& other) const {
-        return std::stoll(this->unix_str) >= std::stoll(other.toUnix());
+        return this->unix_time >= other.unixTime();
     }
 
     inline DateTime DateTime::operator+(const DateTime& other) const {
-        return DateTime(std::to_string(std::stoll(this->unix_str) + std::stoll(other.toUnix())), 0.0);
+        long long result;
+        detail::throwIfFailed(beliumgl::addChecked(this->unix_time, other.unixTime(), result));
+        return DateTime(result, 0.0);
     }
 
     inline DateTime DateTime::operator-(const DateTime& other) const {
-        return DateTime(std::to_string(std::stoll(this->unix_str) - std::stoll(other.toUnix())), 0.0);
+        long long result;
+        detail::throwIfFailed(beliumgl::subChecked(this->unix_time, other.unixTime(), result));
+        return DateTime(result, 0.0);
     }
 
     inline DateTime DateTime::operator*(const DateTime& other) const {
-        return DateTime(std::to_string(std::stoll(this->unix_str) * std::stoll(other.toUnix())), 0.0);
+        long long result;
+        detail::throwIfFailed(beliumgl::mulChecked(this->unix_time, other.unixTime(), result));
+        return DateTime(result, 0.0);
     }
 
     inline DateTime DateTime::operator/(const DateTime& other) const {
-        return DateTime(std::to_string(std::stoll(this->unix_str) / std::stoll(other.toUnix())), 0.0);
+        long long result;
+        detail::throwIfFailed(beliumgl::divChecked(this->unix_time, other.unixTime(), result));
+        return DateTime(result, 0.0);
+    }
+
+    inline Status DateTime::fromUnix(long long _unix, DateTime& out, timezone_offset_t timezoneOffset) {
+        long long local;
+        if (beliumgl::addChecked(_unix, static_cast<long long>(timezoneOffset * 3600), local) != Status::Ok)
+            return Status::OutOfRange;
+        if (local < minDateTimeUnix || local > maxDateTimeUnix)
+            return Status::OutOfRange;
+        out = DateTime(_unix, timezoneOffset);
+        return Status::Ok;
+    }
+
+    inline Status DateTime::parse(const char* str, size_t length, DateTime& out, timezone_offset_t timezoneOffset) {
+        const char* p = str;
+        const char* end = str + length;
+        bool negative = p != end && *p == '-';
+        if (p != end && (*p == '-' || *p == '+'))
+            ++p;
+        if (p == end)
+            return Status::InvalidArgument;
+
+        long long value = 0;
+        for (; p != end; ++p) {
+            if (*p < '0' || *p > '9')
+                return Status::InvalidArgument;
+            if (beliumgl::mulChecked(value, 10, value) != Status::Ok
+                || beliumgl::addChecked(value, negative ? '0' - *p : *p - '0', value) != Status::Ok)
+                return Status::Overflow;
+        }
+        return fromUnix(value, out, timezoneOffset);
     }
+
+    inline Status DateTime::addChecked(const DateTime& other, DateTime& out) const {
+        long long result;
+        Status status = beliumgl::addChecked(this->unix_time, other.unix_time, result);
+        return status == Status::Ok ? fromUnix(result, out) : status;
+    }
+
+    inline Status DateTime::subChecked(const DateTime& other, DateTime& out) const {
+        long long result;
+        Status status = beliumgl::subChecked(this->unix_time, other.unix_time, result);
+        return status == Status::Ok ? fromUnix(result, out) : status;
+    }
+
+    inline Status DateTime::mulChecked(const DateTime& other, DateTime& out) const {
+        long long result;
+        Status status = beliumgl::mulChecked(this->unix_time, other.unix_time, result);
+        return status == Status::Ok ? fromUnix(result, out) : status;
+    }
+
+    inline Status DateTime::divChecked(const DateTime& other, DateTime& out) const {
+        long long result;
+        Status status = beliumgl::divChecked(this->unix_time, other.unix_time, result);
+        return status == Status::Ok ? fromUnix(result, out) : status;
+    }
+
+    inline Status DateTime::advanceChecked(const RangeStep& step, DateTime& out) const {
+        long long result;
+        Status status = beliumgl::advanceChecked(this->unix_time, step, result, this->timezoneOffset);
+        return status == Status::Ok ? fromUnix(result, out, this->timezoneOffset) : status;
+    }
+
+    inline DateTime DateTime::addSaturating(const DateTime& other) const {
+        return DateTime(std::min(std::max(beliumgl::addSaturating(this->unix_time, other.unix_time), minDateTimeUnix), maxDateTimeUnix), 0.0);
+    }
+
+    inline DateTime DateTime::subSaturating(const DateTime& other) const {
+        return DateTime(std::min(std::max(beliumgl::subSaturating(this->unix_time, other.unix_time), minDateTimeUnix), maxDateTimeUnix), 0.0);
+    }
+
+    inline DateTime DateTime::mulSaturating(const DateTime& other) const {
+        return DateTime(std::min(std::max(beliumgl::mulSaturating(this->unix_time, other.unix_time), minDateTimeUnix), maxDateTimeUnix), 0.0);
+    }
+}
+
+/*
+ * ----------------
+ * LD_PRELOAD SHIM
+ * ----------------
+ *
+ * Define `DATEPP_LIBC_SHIM` in exactly one translation unit to replace libc's
+ * `gmtime_r`, `gmtime`, `timegm` and `strftime` with the versions above, e.g.:
+ *
+ *     // datepp_shim.cpp
+ *     #define DATEPP_LIBC_SHIM
+ *     #include "datepp.hpp"
+ *
+ *     $ g++ -std=c++11 -O2 -shared -fPIC datepp_shim.cpp -o libdatepp_shim.so -ldl
+ *     $ LD_PRELOAD=./libdatepp_shim.so ./legacy-service
+ *
+ * Formats and dates that `formatTm` doesn't support are forwarded to the next `strftime` (libc).
+ */
+#ifdef DATEPP_LIBC_SHIM
+#include <cerrno>
+#include <dlfcn.h>
+
+extern "C" {
+    struct tm* gmtime_r(const time_t* timer, struct tm* result) noexcept {
+        if (!beliumgl::unixToTm(static_cast<long long>(*timer), *result)) {
+            errno = EOVERFLOW;
+            return nullptr;
+        }
+        return result;
+    }
+
+    struct tm* gmtime(const time_t* timer) noexcept {
+        // Not through `gmtime_r`, which may resolve to another library's when the shim isn't preloaded.
+        static struct tm result;
+        if (!beliumgl::unixToTm(static_cast<long long>(*timer), result)) {
+            errno = EOVERFLOW;
+            return nullptr;
+        }
+        return &result;
+    }
+
+    time_t timegm(struct tm* tm) noexcept {
+        try {
+            long long result = beliumgl::tmToUnix(*tm);
+            if (result > std::numeric_limits<time_t>::max() || result < std::numeric_limits<time_t>::min()) {
+                errno = EOVERFLOW;
+                return static_cast<time_t>(-1);
+            }
+            return static_cast<time_t>(result);
+        } catch (...) {
+            errno = EOVERFLOW;
+            return static_cast<time_t>(-1);
+        }
+    }
+
+    size_t strftime(char* buffer, size_t size, const char* format, const struct tm* tm) noexcept {
+        size_t result = beliumgl::formatTm(buffer, size, format, *tm);
+        if (result != static_cast<size_t>(-1))
+            return result;
+
+        using strftime_t = size_t (*)(char*, size_t, const char*, const struct tm*);
+        static strftime_t next = reinterpret_cast<strftime_t>(dlsym(RTLD_NEXT, "strftime"));
+        return next != nullptr ? next(buffer, size, format, tm) : 0;
+    }
+}
+#endif
+
+/*
+ * -----
+ * C API
+ * -----
+ *
+ * Define `DATEPP_C_API` in exactly one translation unit to compile the functions declared in `datepp.h`.
+ */
+#ifdef DATEPP_C_API
+#include <new>
+#include "datepp.h"
+#include "datepp_zones.hpp"
+
+struct datepp_format {
+    beliumgl::DateTimeFormat format;
+};
+
+struct datepp_zone {
+    beliumgl::TimeZone zone;
+};
+
+namespace beliumgl {
+    namespace detail {
+        /*
+         * Calls `apply(i, civil)` for every timestamp in the zone (UTC if it's null) until it returns false.
+         * Long batches take their dates from one DayCache. Named zones look up the offsets a chunk at a time
+         * with TimeZone::offsetAt, which walks the transitions alongside sorted input.
+         */
+        template<typename F>
+        void decomposeBatch(const datepp_zone* zone, const int64_t* unixTimes, size_t count, F apply) {
+            if (count < cachedBatch) {
+                for (size_t i = 0; i < count; ++i) {
+                    const long long utc = static_cast<long long>(unixTimes[i]);
+                    if (!apply(i, zone == nullptr ? beliumgl::decompose(utc, 0.0) : zone->zone.decompose(utc)))
+                        return;
+                }
+                return;
+            }
+
+            DayCache<> cache;
+            constexpr size_t chunkSize = 256;
+            long long utc[chunkSize];
+            int offsets[chunkSize] = {};
+            for (size_t chunk = 0; chunk < count; chunk += chunkSize) {
+                const size_t length = std::min(chunkSize, count - chunk);
+                for (size_t i = 0; i < length; ++i)
+                    utc[i] = static_cast<long long>(unixTimes[chunk + i]);
+                if (zone != nullptr)
+                    zone->zone.offsetAt(utc, length, offsets);
+                for (size_t i = 0; i < length; ++i)
+                    if (!apply(chunk + i, cache.fromLocal(utc[i] + offsets[i], offsets[i] / 3600.0)))
+                        return;
+            }
+        }
+
+        /*
+         * UTC moment of a local time in the zone. Local times repeated by a transition get the offset
+         * in effect before it; the ones skipped by a transition get it too, which moves them forward by the gap.
+         */
+        inline long long utcFromLocal(const TimeZone& zone, long long local) {
+            const std::vector<TimeZone::Transition>& transitions = zone.getTransitions();
+            // The first segment whose local time range ends after `local`.
+            size_t low = 0, high = transitions.size() - 1;
+            while (low < high) {
+                size_t middle = low + (high - low) / 2;
+                if (transitions[middle + 1].utc + transitions[middle].offset > local) high = middle;
+                else low = middle + 1;
+            }
+            if (low > 0 && local < transitions[low].utc + transitions[low].offset)
+                --low;
+            return local - transitions[low].offset;
+        }
+
+        template<typename F>
+        datepp_status createZone(datepp_zone** out, F make) {
+            if (out == nullptr)
+                return DATEPP_INVALID_ARGUMENT;
+            try {
+                *out = new datepp_zone{make()};
+                return DATEPP_OK;
+            } catch (const std::bad_alloc&) {
+                return DATEPP_OUT_OF_MEMORY;
+            } catch (const std::invalid_argument&) {
+                return DATEPP_INVALID_ARGUMENT;
+            } catch (...) {
+                return DATEPP_ZONE_NOT_FOUND;
+            }
+        }
+    }
+}
+
+extern "C" {
+    uint32_t datepp_abi_version(void) {
+        return DATEPP_ABI_VERSION;
+    }
+
+    datepp_status datepp_format_create(const char* pattern, datepp_format** out) {
+        if (pattern == nullptr || out == nullptr)
+            return DATEPP_INVALID_ARGUMENT;
+        try {
+            *out = new datepp_format{beliumgl::DateTimeFormat(std::string(pattern))};
+            return DATEPP_OK;
+        } catch (const std::bad_alloc&) {
+            return DATEPP_OUT_OF_MEMORY;
+        } catch (...) {
+            return DATEPP_INVALID_ARGUMENT;
+        }
+    }
+
+    void datepp_format_destroy(datepp_format* format) {
+        delete format;
+    }
+
+    datepp_status datepp_zone_create_fixed(double utc_offset, datepp_zone** out) {
+        if (!(utc_offset >= -99.0 && utc_offset <= 99.0))
+            return DATEPP_INVALID_ARGUMENT;
+        return beliumgl::detail::createZone(out, [&]() { return beliumgl::TimeZone::fixed(utc_offset); });
+    }
+
+    datepp_status datepp_zone_create_named(const char* name, datepp_zone** out) {
+        if (name == nullptr)
+            return DATEPP_INVALID_ARGUMENT;
+        return beliumgl::detail::createZone(out, [&]() { return beliumgl::TimeZone::locate(name); });
+    }
+
+    datepp_status datepp_zone_create_tzif(const char* name, const void* data, size_t size, datepp_zone** out) {
+        if (data == nullptr)
+            return DATEPP_INVALID_ARGUMENT;
+        datepp_status status = beliumgl::detail::createZone(out, [&]() {
+            return beliumgl::TimeZone::fromTZif(name != nullptr ? name : "", static_cast<const char*>(data), size);
+        });
+        // The data was given, so it can only be invalid.
+        return status == DATEPP_ZONE_NOT_FOUND ? DATEPP_INVALID_ARGUMENT : status;
+    }
+
+    void datepp_zone_destroy(datepp_zone* zone) {
+        delete zone;
+    }
+
+    datepp_status datepp_decompose_batch(const datepp_zone* zone, const int64_t* unix_times, size_t count,
+                                         datepp_fields* out) {
+        if ((unix_times == nullptr || out == nullptr) && count > 0)
+            return DATEPP_INVALID_ARGUMENT;
+
+        beliumgl::detail::decomposeBatch(zone, unix_times, count, [&](size_t i, const beliumgl::CivilTime& time) {
+            out[i].year = time.year;
+            out[i].month = time.month;
+            out[i].day = time.day;
+            out[i].hour = time.hour;
+            out[i].minute = time.minute;
+            out[i].second = time.second;
+            out[i].dotw = time.dotw;
+            out[i].utc_offset = time.timezoneOffset;
+            return true;
+        });
+        return DATEPP_OK;
+    }
+
+    datepp_status datepp_format_batch(const datepp_format* format, const datepp_zone* zone,
+                                      const int64_t* unix_times, size_t count,
+                                      char* buffer, size_t buffer_size, size_t* offsets, size_t* written) {
+        if (format == nullptr || written == nullptr || ((unix_times == nullptr || offsets == nullptr || buffer == nullptr) && count > 0))
+            return DATEPP_INVALID_ARGUMENT;
+
+        datepp_status status = DATEPP_OK;
+        size_t position = 0;
+        *written = 0;
+        beliumgl::detail::decomposeBatch(zone, unix_times, count, [&](size_t i, const beliumgl::CivilTime& time) {
+            size_t length = beliumgl::formatTo(buffer + position, buffer_size - position, time, format->format);
+            if (length >= buffer_size - position) {
+                status = DATEPP_BUFFER_TOO_SMALL;
+                return false;
+            }
+            offsets[i] = position;
+            position += length + 1;
+            *written = i + 1;
+            return true;
+        });
+        return status;
+    }
+
+    datepp_status datepp_parse_batch(const datepp_format* format, const datepp_zone* zone,
+                                     const char* data, const size_t* offsets, size_t count,
+                                     int64_t* out, uint8_t* ok) {
+        if (format == nullptr || ((data == nullptr || offsets == nullptr || out == nullptr) && count > 0))
+            return DATEPP_INVALID_ARGUMENT;
+
+        // A fixed offset is applied by parseFormatted itself; other zones need the local time first.
+        const bool fixed = zone == nullptr || zone->zone.getTransitions().size() == 1;
+        const timezone_offset_t offset = zone != nullptr && fixed ? zone->zone.getTransitions()[0].offset / 3600.0 : 0.0;
+        datepp_status status = DATEPP_OK;
+        for (size_t i = 0; i < count; ++i) {
+            const char* string = data + offsets[i];
+            const size_t length = offsets[i] <= offsets[i + 1] ? offsets[i + 1] - offsets[i] : 0;
+            long long result = 0;
+            bool parsed = offsets[i] <= offsets[i + 1]
+                && beliumgl::parseFormatted(string, length, format->format, result, offset);
+            if (parsed && !fixed) {
+                // The string's own UTC offset wins over the zone: then the result doesn't depend on the default.
+                long long other = 0;
+                bool hasOffset = format->format.getShowUTCoffset()
+                    && beliumgl::parseFormatted(string, length, format->format, other, 1.0) && other == result;
+                if (!hasOffset)
+                    result = beliumgl::detail::utcFromLocal(zone->zone, result);
+            }
+            if (!parsed) {
+                result = 0;
+                status = DATEPP_PARSE_ERROR;
+            }
+            out[i] = static_cast<int64_t>(result);
+            if (ok != nullptr)
+                ok[i] = parsed ? 1 : 0;
+        }
+        return status;
+    }
+}
+#endif
+
+/*
+ * --------------------
+ * ALLOCATION TRACKING
+ * --------------------
+ *
+ * See AllocationScope. Every replaced `operator new` allocates with `malloc` and every `operator delete` frees,
+ * so the array, sized and nothrow versions all match each other. The aligned versions of C++17
+ * (`std::align_val_t`) aren't replaced, so over-aligned allocations aren't counted; datepp makes none.
+ */
+#ifdef DATEPP_ALLOCATION_TRACKING
+#include <cstdlib>
+#include <new>
+
+namespace beliumgl {
+    namespace instrumentation {
+        namespace detail {
+            inline void* countedMalloc(std::size_t size) noexcept {
+                ++threadAllocations();
+                return std::malloc(size == 0 ? 1 : size);
+            }
+        }
+    }
+}
+
+void* operator new(std::size_t size) {
+    if (void* result = beliumgl::instrumentation::detail::countedMalloc(size))
+        return result;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* result = beliumgl::instrumentation::detail::countedMalloc(size))
+        return result;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return beliumgl::instrumentation::detail::countedMalloc(size);
 }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return beliumgl::instrumentation::detail::countedMalloc(size);
+}
+
+// GCC warns when one of these is inlined after a `new` (it sees `free` of a pointer from `operator new`), though they match.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Hybrid logical clock for datepp: HybridTimestamp and HybridLogicalClock.
+ *
+ * Separate from `datepp.hpp`, so programs which only convert and format dates don't include <chrono>.
+ * Everything here is header-only in both build modes of datepp.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+
+#include <atomic>
+#include <chrono>
+
+namespace beliumgl {
+    /*
+     * --------------------
+     * HYBRID LOGICAL CLOCK
+     * --------------------
+     *
+     * Hybrid logical clock (Kulkarni et al., 2014): timestamps which follow the wall clock, but never go
+     * backwards and are ordered by causality - a message is always received after it was sent,
+     * even when the receiver's wall clock is behind. A timestamp is packed into 64 bits: unix milliseconds
+     * in the upper 48 (up to the year 10889) and a logical counter in the lower 16, so comparing
+     * the packed numbers compares the timestamps.
+     *
+     * The clock is a single atomic, updated with a compare-and-swap loop, so any number of threads
+     * can share one. If more than 65536 events happen in the same millisecond, the counter carries into
+     * the milliseconds and the clock runs up to a few milliseconds ahead of the wall clock until it catches up.
+     */
+    class HybridTimestamp {
+    public:
+        static constexpr int counterBits = 16;
+        static constexpr unsigned long long maxCounter = (1ULL << counterBits) - 1;
+        static constexpr long long maxMilliseconds = (1LL << (64 - counterBits)) - 1;
+
+        HybridTimestamp() : value(0) {}
+        explicit HybridTimestamp(unsigned long long packed) : value(packed) {}
+        HybridTimestamp(long long milliseconds, unsigned counter) {
+            if (milliseconds < 0 || milliseconds > maxMilliseconds || counter > maxCounter)
+                throw std::invalid_argument("Hybrid timestamp out of range.");
+            this->value = static_cast<unsigned long long>(milliseconds) << counterBits | counter;
+        }
+
+        unsigned long long packed() const { return this->value; }
+        long long milliseconds() const { return static_cast<long long>(this->value >> counterBits); }
+        unsigned counter() const { return static_cast<unsigned>(this->value & maxCounter); }
+        long long unixTime() const { return milliseconds() / 1000; }
+        // Drops the milliseconds and the counter.
+        DateTime toDateTime(timezone_offset_t timezoneOffset = 0.0) const { return DateTime(unixTime(), timezoneOffset); }
+
+        bool operator==(const HybridTimestamp& other) const { return this->value == other.value; }
+        bool operator!=(const HybridTimestamp& other) const { return this->value != other.value; }
+        bool operator<(const HybridTimestamp& other) const { return this->value < other.value; }
+        bool operator>(const HybridTimestamp& other) const { return this->value > other.value; }
+        bool operator<=(const HybridTimestamp& other) const { return this->value <= other.value; }
+        bool operator>=(const HybridTimestamp& other) const { return this->value >= other.value; }
+    private:
+        unsigned long long value;
+    };
+
+    namespace detail {
+        inline long long systemMilliseconds() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    class HybridLogicalClock {
+    public:
+        using PhysicalClock = long long (*)(); // Unix milliseconds
+
+        /*
+         * `maxOffset` (in milliseconds) rejects received timestamps which are further ahead of
+         * the wall clock, so a peer with a broken clock can't move this one into the future; 0 accepts any.
+         */
+        explicit HybridLogicalClock(long long maxOffset = 0, PhysicalClock physicalClock = detail::systemMilliseconds)
+        : physicalClock(physicalClock), maxOffset(maxOffset) {}
+
+        HybridLogicalClock(const HybridLogicalClock&) = delete;
+        HybridLogicalClock& operator=(const HybridLogicalClock&) = delete;
+
+        // Timestamp of a local or send event.
+        HybridTimestamp now() {
+            const unsigned long long physical = packedPhysical();
+            unsigned long long last = this->state.load(std::memory_order_relaxed);
+            unsigned long long next;
+            do {
+                next = std::max(last + 1, physical);
+            } while (!this->state.compare_exchange_weak(last, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+            return HybridTimestamp(next);
+        }
+
+        // Timestamp of receiving a message sent at `remote`; later than both `remote` and every earlier event here.
+        HybridTimestamp receive(HybridTimestamp remote) {
+            const unsigned long long physical = packedPhysical();
+            if (this->maxOffset > 0 && remote.milliseconds() - static_cast<long long>(physical >> HybridTimestamp::counterBits) > this->maxOffset)
+                throw std::runtime_error("Received hybrid timestamp is too far ahead of the wall clock.");
+            unsigned long long last = this->state.load(std::memory_order_relaxed);
+            unsigned long long next;
+            do {
+                next = std::max(std::max(last, remote.packed()) + 1, physical);
+            } while (!this->state.compare_exchange_weak(last, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+            return HybridTimestamp(next);
+        }
+
+        // Last timestamp given out, without making a new one.
+        HybridTimestamp last() const {
+            return HybridTimestamp(this->state.load(std::memory_order_acquire));
+        }
+    private:
+        PhysicalClock physicalClock;
+        long long maxOffset;
+        alignas(64) std::atomic<unsigned long long> state{0};
+
+        unsigned long long packedPhysical() const {
+            long long milliseconds = this->physicalClock();
+            if (milliseconds < 0) milliseconds = 0;
+            if (milliseconds > HybridTimestamp::maxMilliseconds) milliseconds = HybridTimestamp::maxMilliseconds;
+            return static_cast<unsigned long long>(milliseconds) << HybridTimestamp::counterBits;
+        }
+    };
+}
@@ -0,0 +1,333 @@
+/*
+ * Time-ordered ids for datepp: UUIDv7 and Snowflake generators and decoders.
+ *
+ * Separate from `datepp.hpp`, so programs which only convert and format dates don't include
+ * <chrono> and <random>. Everything here is header-only in both build modes of datepp.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+#include "datepp_clock.hpp" // detail::systemMilliseconds
+#include "datepp_zones.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace beliumgl {
+    /*
+     * ----------------
+     * TIME-ORDERED IDS
+     * ----------------
+     *
+     * Generators of ids which sort by creation time: UUIDv7 (RFC 9562) and Snowflake ids with
+     * a configurable layout. A generator isn't synchronized; every thread uses its own
+     * (`UUIDv7Generator::local()`, or a SnowflakeGenerator with its own worker id), so generating
+     * needs no atomics at all. Several ids can be made at once with one read of the clock.
+     *
+     * The decoders take the timestamps out of whole arrays of ids and decompose them in blocks,
+     * without allocating; ids made in order are sorted by time, which TimeZone::decompose converts fastest.
+     */
+    namespace detail {
+        inline unsigned long long splitmix64(unsigned long long& state) {
+            unsigned long long x = (state += 0x9E3779B97F4A7C15ULL);
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+
+        // Different for every generator, even ones made in the same thread at the same moment.
+        inline unsigned long long randomSeed(const void* owner) {
+            static std::atomic<unsigned long long> counter{0};
+            unsigned long long seed = static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count())
+                                    ^ static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(owner))
+                                    ^ counter.fetch_add(0x9E3779B97F4A7C15ULL, std::memory_order_relaxed);
+            try {
+                std::random_device device;
+                seed ^= static_cast<unsigned long long>(device()) << 32 | device();
+            } catch (const std::exception&) {
+                // No entropy source; the clock and the address have to do.
+            }
+            return seed;
+        }
+
+        // Timestamps of `count` ids, `unixAt(i)` each, decomposed by `block(unixTimes, n, out)` in blocks of 256.
+        template<typename UnixAt, typename Block>
+        void decomposeInBlocks(size_t count, CivilTime* out, UnixAt unixAt, Block block) {
+            long long unixTimes[256];
+            for (size_t begin = 0; begin < count; begin += 256) {
+                const size_t n = std::min<size_t>(256, count - begin);
+                for (size_t i = 0; i < n; ++i)
+                    unixTimes[i] = unixAt(begin + i);
+                block(unixTimes, n, out + begin);
+            }
+        }
+    }
+
+    // 128-bit UUID; `high` holds the first 8 bytes, so UUIDs compare like their text.
+    struct UUID {
+        unsigned long long high = 0, low = 0;
+
+        UUID() = default;
+        UUID(unsigned long long high, unsigned long long low) : high(high), low(low) {}
+
+        int version() const { return static_cast<int>(this->high >> 12 & 0xF); }
+        // Unix milliseconds of a version 7 UUID.
+        long long milliseconds() const { return static_cast<long long>(this->high >> 16); }
+        long long unixTime() const { return milliseconds() / 1000; }
+        DateTime toDateTime(timezone_offset_t timezoneOffset = 0.0) const { return DateTime(unixTime(), timezoneOffset); }
+
+        bool operator==(const UUID& other) const { return this->high == other.high && this->low == other.low; }
+        bool operator!=(const UUID& other) const { return !(*this == other); }
+        bool operator<(const UUID& other) const { return this->high < other.high || (this->high == other.high && this->low < other.low); }
+        bool operator>(const UUID& other) const { return other < *this; }
+        bool operator<=(const UUID& other) const { return !(other < *this); }
+        bool operator>=(const UUID& other) const { return !(*this < other); }
+    };
+
+    // "01890a5d-ac96-774b-bcce-b302099a8057" (36 characters, lowercase), like `snprintf`.
+    inline size_t writeUUID(char* buffer, size_t size, const UUID& id) {
+        static constexpr char digits[] = "0123456789abcdef";
+        char out[36];
+        size_t length = 0;
+        for (int i = 0; i < 32; ++i) {
+            if (i == 8 || i == 12 || i == 16 || i == 20)
+                out[length++] = '-';
+            const unsigned long long half = i < 16 ? id.high : id.low;
+            out[length++] = digits[half >> (60 - (i % 16) * 4) & 0xF];
+        }
+        return detail::finishText(buffer, size, out, length);
+    }
+
+    // Reads the 36-character form, in either case.
+    inline bool parseUUID(const char* str, size_t length, UUID& id) {
+        if (length != 36)
+            return false;
+        unsigned long long halves[2] = {0, 0};
+        int digit = 0;
+        for (size_t i = 0; i < 36; ++i) {
+            const char c = str[i];
+            if (i == 8 || i == 13 || i == 18 || i == 23) {
+                if (c != '-') return false;
+                continue;
+            }
+            unsigned value;
+            if (c >= '0' && c <= '9') value = static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') value = static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value = static_cast<unsigned>(c - 'A' + 10);
+            else return false;
+            halves[digit / 16] = halves[digit / 16] << 4 | value;
+            ++digit;
+        }
+        id = UUID(halves[0], halves[1]);
+        return true;
+    }
+
+    /*
+     * UUIDv7 with a 12-bit counter in `rand_a` (RFC 9562, method 1): in the same millisecond the counter
+     * goes up, so the ids of one generator are strictly increasing; it starts from a random value below 2048
+     * every millisecond, and when it runs out, the timestamp is moved one millisecond ahead.
+     * The other 62 bits are random, from a fast generator that isn't cryptographically secure.
+     */
+    class UUIDv7Generator {
+    public:
+        using PhysicalClock = long long (*)(); // Unix milliseconds
+
+        explicit UUIDv7Generator(PhysicalClock physicalClock = detail::systemMilliseconds)
+        : physicalClock(physicalClock), random(detail::randomSeed(this)) {}
+
+        // Generator of the calling thread.
+        static UUIDv7Generator& local() {
+            thread_local UUIDv7Generator generator;
+            return generator;
+        }
+
+        UUID next() {
+            advance(this->physicalClock());
+            return make();
+        }
+
+        // `count` increasing ids, with one read of the clock.
+        void next(UUID* out, size_t count) {
+            if (count == 0) return;
+            advance(this->physicalClock());
+            out[0] = make();
+            for (size_t i = 1; i < count; ++i) {
+                advance(this->lastMilliseconds);
+                out[i] = make();
+            }
+        }
+    private:
+        static constexpr unsigned maxCounter = 0xFFF;
+
+        PhysicalClock physicalClock;
+        unsigned long long random;
+        long long lastMilliseconds = -1;
+        unsigned counter = 0;
+
+        void advance(long long milliseconds) {
+            if (milliseconds < 0) milliseconds = 0;
+            if (milliseconds > this->lastMilliseconds) {
+                this->lastMilliseconds = milliseconds;
+                this->counter = static_cast<unsigned>(detail::splitmix64(this->random) & 0x7FF);
+            } else if (this->counter < maxCounter) {
+                ++this->counter;
+            } else {
+                ++this->lastMilliseconds;
+                this->counter = 0;
+            }
+        }
+
+        UUID make() {
+            const unsigned long long high = static_cast<unsigned long long>(this->lastMilliseconds) << 16 | 0x7000ULL | this->counter;
+            const unsigned long long low = detail::splitmix64(this->random) >> 2 | 0x8000000000000000ULL; // Variant 10
+            return UUID(high, low);
+        }
+    };
+
+    // Unix timestamps (seconds) of version 7 UUIDs.
+    inline void unixTimesOfUUIDv7(const UUID* ids, size_t count, long long* out) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = ids[i].unixTime();
+    }
+
+    inline void decomposeUUIDv7(const UUID* ids, size_t count, CivilTime* out, timezone_offset_t timezoneOffset = 0.0) {
+        detail::decomposeInBlocks(count, out, [&](size_t i) { return ids[i].unixTime(); },
+                                  [&](const long long* unixTimes, size_t n, CivilTime* block) { decompose(unixTimes, n, block, timezoneOffset); });
+    }
+
+    inline void decomposeUUIDv7(const UUID* ids, size_t count, CivilTime* out, const TimeZone& zone) {
+        detail::decomposeInBlocks(count, out, [&](size_t i) { return ids[i].unixTime(); },
+                                  [&](const long long* unixTimes, size_t n, CivilTime* block) { zone.decompose(unixTimes, n, block); });
+    }
+
+    /*
+     * Bit layout of Snowflake ids, from the top: timestamp (ticks since `epoch`), worker, sequence.
+     * The default is Twitter's: 41 bits of milliseconds since 04.11.2010, 10 bits of worker, 12 bits of sequence.
+     * The fields may use all 64 bits; ids are unsigned.
+     */
+    class SnowflakeLayout {
+    public:
+        explicit SnowflakeLayout(long long epoch = 1288834974657LL, int timestampBits = 41, int workerBits = 10, int sequenceBits = 12,
+                                 long long tickMilliseconds = 1)
+        : epoch(epoch), tickMilliseconds(tickMilliseconds), timestampBits(timestampBits), workerBits(workerBits), sequenceBits(sequenceBits) {
+            if (timestampBits < 1 || workerBits < 0 || sequenceBits < 1 || timestampBits + workerBits + sequenceBits > 64 || tickMilliseconds < 1)
+                throw std::invalid_argument("Invalid Snowflake layout.");
+        }
+
+        static SnowflakeLayout twitter() { return SnowflakeLayout(); }
+        // Discord's: 42 bits of milliseconds since 2015, 10 bits of worker and process, 12 bits of increment.
+        static SnowflakeLayout discord() { return SnowflakeLayout(1420070400000LL, 42, 10, 12); }
+
+        long long getEpoch() const { return this->epoch; }
+        long long getTickMilliseconds() const { return this->tickMilliseconds; }
+        int getTimestampBits() const { return this->timestampBits; }
+        int getWorkerBits() const { return this->workerBits; }
+        int getSequenceBits() const { return this->sequenceBits; }
+
+        unsigned long long maxTicks() const { return mask(this->timestampBits); }
+        unsigned long long maxWorker() const { return mask(this->workerBits); }
+        unsigned long long maxSequence() const { return mask(this->sequenceBits); }
+
+        unsigned long long make(unsigned long long ticks, unsigned long long worker, unsigned long long sequence) const {
+            return ticks << (this->workerBits + this->sequenceBits) | worker << this->sequenceBits | sequence;
+        }
+
+        unsigned long long ticks(unsigned long long id) const { return id >> (this->workerBits + this->sequenceBits); }
+        unsigned long long worker(unsigned long long id) const { return id >> this->sequenceBits & maxWorker(); }
+        unsigned long long sequence(unsigned long long id) const { return id & maxSequence(); }
+        long long milliseconds(unsigned long long id) const {
+            return this->epoch + static_cast<long long>(ticks(id)) * this->tickMilliseconds;
+        }
+        long long unixTime(unsigned long long id) const { return floorDiv(milliseconds(id), 1000); }
+        DateTime toDateTime(unsigned long long id, timezone_offset_t timezoneOffset = 0.0) const {
+            return DateTime(unixTime(id), timezoneOffset);
+        }
+
+        void unixTimes(const unsigned long long* ids, size_t count, long long* out) const {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = unixTime(ids[i]);
+        }
+
+        void decompose(const unsigned long long* ids, size_t count, CivilTime* out, timezone_offset_t timezoneOffset = 0.0) const {
+            detail::decomposeInBlocks(count, out, [&](size_t i) { return unixTime(ids[i]); },
+                                      [&](const long long* unixTimes, size_t n, CivilTime* block) {
+                                          beliumgl::decompose(unixTimes, n, block, timezoneOffset);
+                                      });
+        }
+
+        void decompose(const unsigned long long* ids, size_t count, CivilTime* out, const TimeZone& zone) const {
+            detail::decomposeInBlocks(count, out, [&](size_t i) { return unixTime(ids[i]); },
+                                      [&](const long long* unixTimes, size_t n, CivilTime* block) { zone.decompose(unixTimes, n, block); });
+        }
+    private:
+        long long epoch, tickMilliseconds;
+        int timestampBits, workerBits, sequenceBits;
+
+        static unsigned long long mask(int bits) { return bits >= 64 ? ~0ULL : (1ULL << bits) - 1; }
+    };
+
+    /*
+     * Snowflake ids of one worker. In the same tick the sequence goes up; when it runs out, the next ids
+     * borrow the following tick instead of waiting for it, and if the clock goes back, the generator stays
+     * at the last tick. Throws std::runtime_error before the epoch and after the last tick of the layout.
+     */
+    class SnowflakeGenerator {
+    public:
+        using PhysicalClock = long long (*)(); // Unix milliseconds
+
+        SnowflakeGenerator(const SnowflakeLayout& layout, unsigned long long worker, PhysicalClock physicalClock = detail::systemMilliseconds)
+        : layout(layout), worker(worker), physicalClock(physicalClock) {
+            if (worker > layout.maxWorker())
+                throw std::invalid_argument("Snowflake worker id doesn't fit the layout.");
+        }
+
+        const SnowflakeLayout& getLayout() const { return this->layout; }
+        unsigned long long getWorker() const { return this->worker; }
+
+        unsigned long long next() {
+            advance(currentTicks());
+            return this->layout.make(static_cast<unsigned long long>(this->lastTicks), this->worker, this->sequence);
+        }
+
+        // `count` increasing ids, with one read of the clock.
+        void next(unsigned long long* out, size_t count) {
+            if (count == 0) return;
+            advance(currentTicks());
+            out[0] = this->layout.make(static_cast<unsigned long long>(this->lastTicks), this->worker, this->sequence);
+            for (size_t i = 1; i < count; ++i) {
+                advance(this->lastTicks);
+                out[i] = this->layout.make(static_cast<unsigned long long>(this->lastTicks), this->worker, this->sequence);
+            }
+        }
+    private:
+        SnowflakeLayout layout;
+        unsigned long long worker;
+        PhysicalClock physicalClock;
+        long long lastTicks = -1;
+        unsigned long long sequence = 0;
+
+        long long currentTicks() const {
+            const long long milliseconds = this->physicalClock();
+            if (milliseconds < this->layout.getEpoch())
+                throw std::runtime_error("Clock is before the Snowflake epoch.");
+            return (milliseconds - this->layout.getEpoch()) / this->layout.getTickMilliseconds();
+        }
+
+        void advance(long long ticks) {
+            if (ticks > this->lastTicks) {
+                this->lastTicks = ticks;
+                this->sequence = 0;
+            } else if (this->sequence < this->layout.maxSequence()) {
+                ++this->sequence;
+            } else {
+                ++this->lastTicks;
+                this->sequence = 0;
+            }
+            if (static_cast<unsigned long long>(this->lastTicks) > this->layout.maxTicks())
+                throw std::runtime_error("Snowflake timestamp doesn't fit the layout.");
+        }
+    };
+}
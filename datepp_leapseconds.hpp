@@ -0,0 +1,212 @@
+/*
+ * Leap seconds for datepp: LeapSecondTable, conversions between UTC, TAI and GPS time.
+ *
+ * Separate from `datepp.hpp`, so programs which don't count leap seconds don't include <vector> and <atomic>.
+ * With `DATEPP_SEPARATE_COMPILATION`, reading `leap-seconds.list` is compiled into libdatepp like the rest.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace beliumgl {
+    /*
+     * ------------
+     * LEAP SECONDS
+     * ------------
+     *
+     * Unix time (and DateTime) pretends every day has 86400 seconds, so it can't count leap seconds.
+     * TAI and GPS time do count them. LeapSecondTable converts between them with the TAI - UTC
+     * offset in effect at a given moment.
+     *
+     * TAI timestamps here use the unix epoch (`tai = utc + (TAI - UTC)`), and GPS timestamps
+     * are seconds since the GPS epoch (06.01.1980), which is always 19 seconds behind TAI.
+     * Before 1972 the offset of the first entry (10 seconds) is used.
+     *
+     * Lookups are binary searches over the table, but the last segment that was used is remembered,
+     * so (mostly) sorted or recent timestamps are converted without searching.
+     * The table is immutable after construction and can be shared between threads.
+     */
+    class LeapSecondTable {
+    public:
+        struct Entry {
+            long long utc;  // Unix timestamp from which `offset` applies
+            int offset;     // TAI - UTC in seconds
+        };
+
+        // The table published by IERS up to the leap second at the end of 2016.
+        LeapSecondTable() : entries({
+            {63072000LL, 10},   // 01.01.1972
+            {78796800LL, 11},   // 01.07.1972
+            {94694400LL, 12},   // 01.01.1973
+            {126230400LL, 13},  // 01.01.1974
+            {157766400LL, 14},  // 01.01.1975
+            {189302400LL, 15},  // 01.01.1976
+            {220924800LL, 16},  // 01.01.1977
+            {252460800LL, 17},  // 01.01.1978
+            {283996800LL, 18},  // 01.01.1979
+            {315532800LL, 19},  // 01.01.1980
+            {362793600LL, 20},  // 01.07.1981
+            {394329600LL, 21},  // 01.07.1982
+            {425865600LL, 22},  // 01.07.1983
+            {489024000LL, 23},  // 01.07.1985
+            {567993600LL, 24},  // 01.01.1988
+            {631152000LL, 25},  // 01.01.1990
+            {662688000LL, 26},  // 01.01.1991
+            {709948800LL, 27},  // 01.07.1992
+            {741484800LL, 28},  // 01.07.1993
+            {773020800LL, 29},  // 01.07.1994
+            {820454400LL, 30},  // 01.01.1996
+            {867715200LL, 31},  // 01.07.1997
+            {915148800LL, 32},  // 01.01.1999
+            {1136073600LL, 33}, // 01.01.2006
+            {1230768000LL, 34}, // 01.01.2009
+            {1341100800LL, 35}, // 01.07.2012
+            {1435708800LL, 36}, // 01.07.2015
+            {1483228800LL, 37}  // 01.01.2017
+        }) {}
+
+        // Entries must be sorted by `utc`.
+        explicit LeapSecondTable(std::vector<Entry> entries) : entries(std::move(entries)) {
+            if (this->entries.empty())
+                throw std::invalid_argument("Leap second table can't be empty.");
+            for (size_t i = 1; i < this->entries.size(); ++i)
+                if (this->entries[i].utc <= this->entries[i - 1].utc)
+                    throw std::invalid_argument("Leap second table must be sorted.");
+        }
+
+        LeapSecondTable(const LeapSecondTable& other) : entries(other.entries) {}
+        LeapSecondTable& operator=(const LeapSecondTable& other) {
+            this->entries = other.entries;
+            this->lastSegment.store(0, std::memory_order_relaxed);
+            return *this;
+        }
+
+        /*
+         * Reads the `leap-seconds.list` file distributed by IERS/IANA
+         * (e.g. /usr/share/zoneinfo/leap-seconds.list): lines of "<NTP timestamp> <TAI - UTC>",
+         * comments start with '#'.
+         */
+        static LeapSecondTable fromFile(const std::string& path);
+
+        // Shared instance with the compiled-in table.
+        static const LeapSecondTable& builtin() {
+            static const LeapSecondTable table;
+            return table;
+        }
+
+        const std::vector<Entry>& getEntries() const { return this->entries; }
+
+        // TAI - UTC at the UTC moment `utc`.
+        int offsetAt(long long utc) const {
+            return this->entries[segmentOf(utc, 0)].offset;
+        }
+
+        long long utcToTai(long long utc) const {
+            return utc + offsetAt(utc);
+        }
+
+        /*
+         * During an inserted leap second (23:59:60) there's no unix timestamp;
+         * the start of the next day is returned and `leapSecond` is set to true.
+         */
+        long long taiToUtc(long long tai, bool* leapSecond = nullptr) const {
+            size_t segment = segmentOf(tai, 1);
+            long long utc = tai - this->entries[segment].offset;
+            if (leapSecond != nullptr)
+                *leapSecond = false;
+
+            // Between two segments, TAI has seconds which UTC doesn't (or the other way around).
+            if (segment + 1 < this->entries.size() && utc >= this->entries[segment + 1].utc) {
+                utc = this->entries[segment + 1].utc;
+                if (leapSecond != nullptr)
+                    *leapSecond = true;
+            }
+            return utc;
+        }
+
+        long long utcToGps(long long utc) const {
+            return utcToTai(utc) - 19 - gpsEpochOffset;
+        }
+
+        long long gpsToUtc(long long gps, bool* leapSecond = nullptr) const {
+            return taiToUtc(gps + 19 + gpsEpochOffset, leapSecond);
+        }
+
+        void utcToTai(const long long* utc, size_t count, long long* out) const {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = utcToTai(utc[i]);
+        }
+
+        void taiToUtc(const long long* tai, size_t count, long long* out) const {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = taiToUtc(tai[i]);
+        }
+
+        void utcToGps(const long long* utc, size_t count, long long* out) const {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = utcToGps(utc[i]);
+        }
+
+        void gpsToUtc(const long long* gps, size_t count, long long* out) const {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = gpsToUtc(gps[i]);
+        }
+    private:
+        std::vector<Entry> entries;
+        mutable std::atomic<size_t> lastSegment{0};
+
+        /*
+         * Index of the segment containing `time`, measured in UTC (`tai` = 0) or in TAI (`tai` = 1),
+         * where a segment starts at `utc + offset * tai`.
+         */
+        size_t segmentOf(long long time, int tai) const {
+            auto start = [&](size_t i) { return this->entries[i].utc + this->entries[i].offset * tai; };
+
+            size_t segment = this->lastSegment.load(std::memory_order_relaxed);
+            if (segment < this->entries.size() && start(segment) <= time
+                && (segment + 1 == this->entries.size() || time < start(segment + 1)))
+                return segment;
+
+            size_t low = 0, high = this->entries.size();
+            while (high - low > 1) {
+                size_t middle = low + (high - low) / 2;
+                if (start(middle) <= time) low = middle;
+                else high = middle;
+            }
+            this->lastSegment.store(low, std::memory_order_relaxed);
+            return low;
+        }
+    };
+
+#if !defined(DATEPP_SEPARATE_COMPILATION) || defined(DATEPP_IMPLEMENTATION)
+    DATEPP_DECL LeapSecondTable LeapSecondTable::fromFile(const std::string& path) {
+        std::string data;
+        if (!detail::readFile(path, data))
+            throw std::runtime_error("Failed to open the leap second file.");
+
+        std::vector<Entry> entries;
+        for (size_t begin = 0, end; begin < data.size(); begin = end + 1) {
+            end = data.find('\n', begin);
+            if (end == std::string::npos)
+                end = data.size();
+            const std::string line = data.substr(begin, end - begin);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            char* numberEnd;
+            long long ntp = std::strtoll(line.c_str(), &numberEnd, 10);
+            char* offsetEnd;
+            long offset = std::strtol(numberEnd, &offsetEnd, 10);
+            if (numberEnd == line.c_str() || offsetEnd == numberEnd)
+                throw std::runtime_error("Invalid line in the leap second file.");
+            entries.push_back({ntp - ntpEpochOffset, static_cast<int>(offset)});
+        }
+        return LeapSecondTable(std::move(entries));
+    }
+
+#endif
+}
@@ -0,0 +1,128 @@
+/*
+ * Timestamp detection for datepp: TimestampParser, which finds the format of a stream of timestamps
+ * (epoch numbers, ISO 8601, RFC 2822 or DateTimeFormat layouts) and locks it in.
+ *
+ * Separate from `datepp.hpp`, so programs which only use `parseEpoch`, `parseISO8601` and `parseRFC2822`
+ * don't include <vector>. Everything here is header-only in both build modes of datepp.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+
+#include <vector>
+
+namespace beliumgl {
+    /*
+     * Parses a stream of timestamps whose format is unknown up front.
+     *
+     * The first value is matched against every known format (epoch numbers, ISO 8601, RFC 2822, and the
+     * DateTimeFormat layouts given to the constructor, in this order), and the matching format is locked in.
+     * Following values are parsed with that format only; a value that doesn't match it is detected
+     * again (and the lock moves to its format), so mixed streams still parse, just slower.
+     *
+     * Not synchronized; use one instance per stream or thread.
+     */
+    class TimestampParser {
+    public:
+        enum class Format { EpochSeconds, EpochMilliseconds, EpochMicroseconds, EpochNanoseconds, ISO8601, RFC2822, Layout, Unknown };
+        static constexpr size_t formatCount = 7;
+
+        explicit TimestampParser(std::vector<DateTimeFormat> layouts = std::vector<DateTimeFormat>(),
+                                 timezone_offset_t timezoneOffset = 0.0)
+        : layouts(std::move(layouts)), layoutCounts(this->layouts.size(), 0), timezoneOffset(timezoneOffset) {}
+
+        bool parse(const char* str, size_t length, long long& out) {
+            if (this->locked != Format::Unknown && parseAs(this->locked, this->lockedLayout, str, length, out)) {
+                count(this->locked, this->lockedLayout);
+                return true;
+            }
+
+            ++this->detections;
+            for (size_t format = 0; format < static_cast<size_t>(Format::Layout); ++format) {
+                if (parseAs(static_cast<Format>(format), 0, str, length, out)) {
+                    lock(static_cast<Format>(format), 0);
+                    return true;
+                }
+            }
+            for (size_t layout = 0; layout < this->layouts.size(); ++layout) {
+                if (parseAs(Format::Layout, layout, str, length, out)) {
+                    lock(Format::Layout, layout);
+                    return true;
+                }
+            }
+            ++this->failures;
+            return false;
+        }
+
+        bool parse(const std::string& str, long long& out) {
+            return parse(str.data(), str.size(), out);
+        }
+
+        // Parses `count` strings; string i is `data[offsets[i]]..data[offsets[i + 1]]`. Returns the number of failures.
+        size_t parse(const char* data, const size_t* offsets, size_t count, long long* out, bool* ok = nullptr) {
+            size_t failed = 0;
+            for (size_t i = 0; i < count; ++i) {
+                bool parsed = parse(data + offsets[i], offsets[i + 1] - offsets[i], out[i]);
+                if (!parsed) {
+                    out[i] = 0;
+                    ++failed;
+                }
+                if (ok != nullptr) ok[i] = parsed;
+            }
+            return failed;
+        }
+
+        Format lockedFormat() const { return this->locked; }
+        size_t lockedLayoutIndex() const { return this->lockedLayout; }
+        // Number of values parsed with `format` (all layouts together for Format::Layout).
+        size_t getCount(Format format) const { return format == Format::Unknown ? this->failures : this->counts[static_cast<size_t>(format)]; }
+        size_t getLayoutCount(size_t layout) const { return this->layoutCounts.at(layout); }
+        // How many times the format had to be detected (1 for a stream with a single format).
+        size_t getDetections() const { return this->detections; }
+        size_t getFailures() const { return this->failures; }
+    private:
+        std::vector<DateTimeFormat> layouts;
+        std::vector<size_t> layoutCounts;
+        timezone_offset_t timezoneOffset;
+
+        Format locked = Format::Unknown;
+        size_t lockedLayout = 0;
+        size_t counts[formatCount] = {};
+        size_t detections = 0, failures = 0;
+
+        bool parseAs(Format format, size_t layout, const char* str, size_t length, long long& out) const {
+            size_t digits;
+            switch (format) {
+                case Format::EpochSeconds:
+                    return parseEpoch(str, length, out, digits) && digits <= 11;
+                case Format::EpochMilliseconds:
+                    return parseEpoch(str, length, out, digits) && digits >= 12 && digits <= 14;
+                case Format::EpochMicroseconds:
+                    return parseEpoch(str, length, out, digits) && digits >= 15 && digits <= 17;
+                case Format::EpochNanoseconds:
+                    return parseEpoch(str, length, out, digits) && digits >= 18;
+                case Format::ISO8601:
+                    return parseISO8601(str, length, out);
+                case Format::RFC2822:
+                    return parseRFC2822(str, length, out);
+                case Format::Layout:
+                    return parseFormatted(str, length, this->layouts[layout], out, this->timezoneOffset);
+                default:
+                    return false;
+            }
+        }
+
+        void count(Format format, size_t layout) {
+            ++this->counts[static_cast<size_t>(format)];
+            if (format == Format::Layout)
+                ++this->layoutCounts[layout];
+        }
+
+        void lock(Format format, size_t layout) {
+            this->locked = format;
+            this->lockedLayout = layout;
+            count(format, layout);
+        }
+    };
+}
@@ -0,0 +1,403 @@
+/*
+ * Timers for datepp: TimingWheel and ConcurrentTimingWheel.
+ *
+ * Separate from `datepp.hpp`, so programs which only convert and format dates don't include
+ * <mutex> and <thread>. Everything here is header-only in both build modes of datepp.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace beliumgl {
+    /*
+     * ------------
+     * TIMING WHEEL
+     * ------------
+     *
+     * Scheduler for many timers with absolute deadlines (unix timestamps or DateTimes), with a resolution
+     * of one second. Pending timers are kept in four wheels of buckets: seconds (60), minutes (60),
+     * hours (24) and days (64) ahead of the current time; timers further away wait in an overflow list,
+     * which is looked at every 64 days. When the time of a bucket comes, its timers move to a lower
+     * wheel, until they expire from the seconds wheel together with all the other timers of that second.
+     *
+     * Buckets are arrays of (deadline, value) entries, so moving them down reads memory in order.
+     * Scheduling and cancelling are O(1): a cancelled timer is only marked, and its entry is dropped
+     * when it would have expired. `advance` finds the next non-empty bucket with one bitmap
+     * per wheel, so idle time is skipped instead of ticking through every second.
+     * The arrays keep their capacity, so in a steady state scheduling doesn't allocate.
+     * Ids aren't reused: cancelling a timer which already expired or was cancelled returns false.
+     *
+     * TimingWheel isn't synchronized; ConcurrentTimingWheel has one per thread.
+     */
+    namespace detail {
+        inline int lowestBit(unsigned long long bits) {
+#if defined(__GNUC__)
+            return __builtin_ctzll(bits);
+#else
+            int bit = 0;
+            while ((bits & 1) == 0) {
+                bits >>= 1;
+                ++bit;
+            }
+            return bit;
+#endif
+        }
+
+        inline long long floorMod(long long a, long long b) {
+            return a - floorDiv(a, b) * b;
+        }
+    }
+
+    template<typename T>
+    class TimingWheel {
+    public:
+        using TimerId = unsigned long long; // Never 0; the top 8 bits are always 0
+
+        explicit TimingWheel(long long now = 0) {
+            std::fill(std::begin(this->occupied), std::end(this->occupied), 0ULL);
+            setTime(now);
+        }
+        explicit TimingWheel(const DateTime& now) : TimingWheel(now.unixTime()) {}
+
+        long long now() const { return this->currentTime; }
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0; }
+        void reserve(size_t capacity) { this->timers.reserve(capacity); }
+
+        // A deadline that already passed fires on the next second.
+        TimerId schedule(long long deadline, T value) {
+            unsigned index;
+            if (!this->freeTimers.empty()) {
+                index = this->freeTimers.back();
+                this->freeTimers.pop_back();
+            } else {
+                index = static_cast<unsigned>(this->timers.size());
+                this->timers.emplace_back();
+            }
+
+            Timer& timer = this->timers[index];
+            timer.pending = true;
+            put(bucketOf(deadline, this->currentTime + 1), Entry{deadline, index, timer.generation, std::move(value)});
+            ++this->count;
+            return idOf(index, timer.generation);
+        }
+
+        TimerId schedule(const DateTime& deadline, T value) {
+            return schedule(deadline.unixTime(), std::move(value));
+        }
+
+        // The timer's entry stays in its bucket and is skipped when the bucket's time comes.
+        bool cancel(TimerId id) {
+            const unsigned long long index = (id & 0xffffffffULL) - 1;
+            if (!isPending(id))
+                return false;
+            release(static_cast<unsigned>(index));
+            return true;
+        }
+
+        bool isPending(TimerId id) const {
+            const unsigned long long index = (id & 0xffffffffULL) - 1;
+            return index < this->timers.size() && this->timers[index].pending && (this->timers[index].generation & 0xffffff) == id >> 32;
+        }
+
+        /*
+         * Moves the current time to `to` (if it's later) and calls `expire(TimerId, long long deadline, T& value)`
+         * for every timer due until then, second by second (in no particular order within a second).
+         * `expire` may schedule and cancel timers, but not call `advance`. Returns the number of expired timers.
+         */
+        template<typename F>
+        size_t advance(long long to, F expire) {
+            size_t expired = 0;
+            while (this->currentTime < to) {
+                const long long tick = std::min(nextTick(), to);
+                setTime(tick);
+
+                // Buckets starting at `tick` move down, the highest wheel first.
+                const bool dayStarts = this->current[levels - 1] * granularities[levels - 1] == tick;
+                if (dayStarts && !this->buckets[overflow].empty() && slotOf(this->current[levels - 1], levels - 1) == 0)
+                    redistribute(overflow);
+                for (int level = levels - 1; level > 0; --level)
+                    if (this->current[level] * granularities[level] == tick)
+                        redistribute(offsets[level] + slotOf(this->current[level], level));
+
+                take(slotOf(tick, 0));
+                for (Entry& entry : this->scratch) {
+                    if (!isLive(entry))
+                        continue;
+                    release(entry.index);
+                    ++expired;
+                    expire(idOf(entry.index, entry.generation), entry.deadline, entry.value);
+                }
+                this->scratch.clear();
+            }
+            return expired;
+        }
+
+        template<typename F>
+        size_t advance(const DateTime& to, F expire) {
+            return advance(to.unixTime(), expire);
+        }
+
+        // Appends the values of the expired timers to `expired`.
+        size_t advance(long long to, std::vector<T>& expired) {
+            return advance(to, [&](TimerId, long long, T& value) { expired.push_back(std::move(value)); });
+        }
+    private:
+        static constexpr int levels = 4;
+        static constexpr long long granularities[levels] = {1, 60, 3600, 86400};
+        static constexpr long long sizes[levels] = {60, 60, 24, 64};
+        static constexpr size_t offsets[levels] = {0, 60, 120, 144};
+        static constexpr size_t overflow = 208;
+
+        // Timers are only their generation; their deadlines and values move between the buckets.
+        struct Timer {
+            unsigned generation = 0;
+            bool pending = false;
+        };
+
+        struct Entry {
+            long long deadline;
+            unsigned index;
+            unsigned generation;
+            T value;
+        };
+
+        std::vector<Timer> timers;
+        std::vector<unsigned> freeTimers;
+        std::vector<Entry> buckets[overflow + 1];
+        std::vector<Entry> scratch; // The bucket being emptied
+        unsigned long long occupied[levels]; // Non-empty buckets of every wheel
+        long long currentTime;
+        long long current[levels]; // Bucket of every wheel containing `currentTime`
+        long long limits[levels];  // End of the time covered by every wheel
+        size_t count = 0;
+
+        static TimerId idOf(unsigned index, unsigned generation) {
+            return static_cast<TimerId>(generation & 0xffffff) << 32 | (index + 1ULL);
+        }
+
+        static int levelOf(size_t bucket) {
+            return bucket < offsets[1] ? 0 : bucket < offsets[2] ? 1 : bucket < offsets[3] ? 2 : 3;
+        }
+
+        bool isLive(const Entry& entry) const {
+            const Timer& timer = this->timers[entry.index];
+            return timer.pending && timer.generation == entry.generation;
+        }
+
+        void release(unsigned index) {
+            Timer& timer = this->timers[index];
+            timer.pending = false;
+            ++timer.generation;
+            this->freeTimers.push_back(index);
+            --this->count;
+        }
+
+        /*
+         * Number of the bucket of `level` containing `time` (counted from the epoch), and its position
+         * in the wheel. The switches make the divisors constants, which compile to multiplications.
+         */
+        static long long bucketAt(long long time, int level) {
+            switch (level) {
+                case 0: return time;
+                case 1: return floorDiv(time, 60);
+                case 2: return floorDiv(time, 3600);
+                default: return floorDiv(time, 86400);
+            }
+        }
+
+        static size_t slotOf(long long bucket, int level) {
+            switch (level) {
+                case 0:
+                case 1: return static_cast<size_t>(detail::floorMod(bucket, 60));
+                case 2: return static_cast<size_t>(detail::floorMod(bucket, 24));
+                default: return static_cast<size_t>(detail::floorMod(bucket, 64));
+            }
+        }
+
+        void setTime(long long now) {
+            this->currentTime = now;
+            for (int level = 0; level < levels; ++level) {
+                this->current[level] = bucketAt(now, level);
+                this->limits[level] = (this->current[level] + sizes[level]) * granularities[level];
+            }
+        }
+
+        // Bucket of a timer due at `deadline`, but not before `earliest`.
+        size_t bucketOf(long long deadline, long long earliest) const {
+            const long long due = std::max(deadline, earliest);
+            for (int level = 0; level < levels; ++level)
+                if (due < this->limits[level])
+                    return offsets[level] + slotOf(bucketAt(due, level), level);
+            return overflow;
+        }
+
+        void put(size_t bucket, Entry&& entry) {
+            this->buckets[bucket].push_back(std::move(entry));
+            if (bucket != overflow)
+                this->occupied[levelOf(bucket)] |= 1ULL << (bucket - offsets[levelOf(bucket)]);
+        }
+
+        // Moves the entries of `bucket` to `scratch`.
+        void take(size_t bucket) {
+            std::swap(this->buckets[bucket], this->scratch);
+            if (bucket != overflow)
+                this->occupied[levelOf(bucket)] &= ~(1ULL << (bucket - offsets[levelOf(bucket)]));
+        }
+
+        /*
+         * Moves the timers of `bucket` to the buckets they belong to now. Cancelled ones move too: checking them
+         * here would read `timers` out of order on every level, instead of once when they expire.
+         */
+        void redistribute(size_t bucket) {
+            take(bucket);
+            for (Entry& entry : this->scratch)
+                put(bucketOf(entry.deadline, this->currentTime), std::move(entry));
+            this->scratch.clear();
+        }
+
+        // The next second at which a bucket starts: the earliest non-empty one of every wheel.
+        long long nextTick() const {
+            long long tick = std::numeric_limits<long long>::max();
+            for (int level = 0; level < levels; ++level) {
+                const unsigned long long bits = this->occupied[level];
+                if (bits == 0)
+                    continue;
+                const long long current = this->current[level];
+                const int start = static_cast<int>(slotOf(current, level)) + 1;
+                // Buckets after the current one, then the ones that wrapped around.
+                const unsigned long long after = start < 64 ? bits >> start << start : 0;
+                const int bucket = after != 0 ? detail::lowestBit(after) : detail::lowestBit(bits) + static_cast<int>(sizes[level]);
+                tick = std::min(tick, (current + bucket - start + 1) * granularities[level]);
+            }
+            if (!this->buckets[overflow].empty()) {
+                const long long days = this->current[levels - 1];
+                tick = std::min(tick, (days - static_cast<long long>(slotOf(days, levels - 1)) + sizes[levels - 1]) * granularities[levels - 1]);
+            }
+            return tick;
+        }
+    };
+
+    template<typename T> constexpr long long TimingWheel<T>::granularities[];
+    template<typename T> constexpr long long TimingWheel<T>::sizes[];
+    template<typename T> constexpr size_t TimingWheel<T>::offsets[];
+    template<typename T> constexpr size_t TimingWheel<T>::overflow;
+
+    namespace detail {
+        // Small number of the calling thread, counted from 0 in the order threads first ask.
+        inline size_t threadIndex() {
+            static std::atomic<size_t> next{0};
+            thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+    }
+
+    /*
+     * TimingWheel for many threads: every thread schedules into its own wheel (shard),
+     * so threads don't contend with each other. The shard is part of the id, so a timer can be
+     * cancelled from any thread. `advance` moves all shards, `advanceShard` one of them
+     * (e.g. every worker thread its own); callbacks run without holding the shard's lock,
+     * so they may schedule and cancel timers.
+     */
+    template<typename T>
+    class ConcurrentTimingWheel {
+    public:
+        using TimerId = typename TimingWheel<T>::TimerId;
+
+        explicit ConcurrentTimingWheel(long long now = 0, size_t shards = std::thread::hardware_concurrency()) {
+            shards = std::min<size_t>(std::max<size_t>(shards, 1), 256);
+            for (size_t i = 0; i < shards; ++i)
+                this->shards.emplace_back(new Shard(now));
+        }
+        explicit ConcurrentTimingWheel(const DateTime& now, size_t shards = std::thread::hardware_concurrency())
+        : ConcurrentTimingWheel(now.unixTime(), shards) {}
+
+        size_t shardCount() const { return this->shards.size(); }
+        // Shard of the calling thread.
+        size_t currentShard() const { return detail::threadIndex() % this->shards.size(); }
+
+        size_t size() const {
+            size_t total = 0;
+            for (const std::unique_ptr<Shard>& shard : this->shards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                total += shard->wheel.size();
+            }
+            return total;
+        }
+
+        TimerId schedule(long long deadline, T value) {
+            const size_t index = currentShard();
+            Shard& shard = *this->shards[index];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.wheel.schedule(deadline, std::move(value)) | static_cast<TimerId>(index) << 56;
+        }
+
+        TimerId schedule(const DateTime& deadline, T value) {
+            return schedule(deadline.unixTime(), std::move(value));
+        }
+
+        bool cancel(TimerId id) {
+            const size_t index = static_cast<size_t>(id >> 56);
+            if (index >= this->shards.size())
+                return false;
+            Shard& shard = *this->shards[index];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.wheel.cancel(id & ((1ULL << 56) - 1));
+        }
+
+        // Like TimingWheel::advance, for the timers of shard `index`.
+        template<typename F>
+        size_t advanceShard(size_t index, long long to, F expire) {
+            Shard& shard = *this->shards[index];
+            std::lock_guard<std::mutex> advancing(shard.advancing);
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.wheel.advance(to, [&](TimerId id, long long deadline, T& value) {
+                    shard.expired.push_back(Expired{id | static_cast<TimerId>(index) << 56, deadline, std::move(value)});
+                });
+            }
+            for (Expired& timer : shard.expired)
+                expire(timer.id, timer.deadline, timer.value);
+            const size_t expired = shard.expired.size();
+            shard.expired.clear();
+            return expired;
+        }
+
+        template<typename F>
+        size_t advance(long long to, F expire) {
+            size_t expired = 0;
+            for (size_t i = 0; i < this->shards.size(); ++i)
+                expired += advanceShard(i, to, expire);
+            return expired;
+        }
+
+        template<typename F>
+        size_t advance(const DateTime& to, F expire) {
+            return advance(to.unixTime(), expire);
+        }
+    private:
+        struct Expired {
+            TimerId id;
+            long long deadline;
+            T value;
+        };
+
+        struct Shard {
+            explicit Shard(long long now) : wheel(now) {}
+
+            std::mutex mutex;     // Guards `wheel`
+            std::mutex advancing; // Guards `expired`, held while the callbacks run
+            TimingWheel<T> wheel;
+            std::vector<Expired> expired;
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+    };
+}
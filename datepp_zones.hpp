@@ -0,0 +1,410 @@
+/*
+ * Named time zones for datepp: TimeZone (from the TZif files of the IANA database),
+ * and decomposeInZones / formatInZones, the zone versions of decomposeInOffsets / formatInOffsets.
+ *
+ * Separate from `datepp.hpp`, so programs which only use fixed UTC offsets don't include <vector> and <atomic>.
+ * With `DATEPP_SEPARATE_COMPILATION`, reading TZif files is compiled into libdatepp like the rest.
+ */
+
+#pragma once
+
+#include "datepp.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace beliumgl {
+    /*
+     * ----------
+     * TIME ZONES
+     * ----------
+     *
+     * Named time zones as a list of transitions (UTC moments from which an offset applies),
+     * read from the TZif files of the IANA database (e.g. /usr/share/zoneinfo/Europe/Berlin).
+     * The rule at the end of a TZif file (for the years after its last transition) is expanded
+     * into transitions up to `ruleYears`; after the last transition its offset stays in effect.
+     *
+     * Lookups remember the last segment (like LeapSecondTable), and the batch functions walk
+     * the transitions alongside sorted input: each run of timestamps between two transitions
+     * gets one constant offset, so it's converted by the same loop as a fixed offset.
+     * Unsorted input falls back to a lookup per timestamp.
+     * The zone is immutable after construction and can be shared between threads.
+     */
+    class TimeZone {
+    public:
+        struct Transition {
+            long long utc; // Unix timestamp from which `offset` applies
+            int offset;    // Seconds east of UTC
+        };
+
+        // Rules are expanded into transitions up to the end of this year.
+        static constexpr long long ruleYears = 2200;
+
+        // UTC
+        TimeZone() : name("UTC"), transitions({{std::numeric_limits<long long>::min(), 0}}) {}
+
+        // Transitions must be sorted by `utc`; the offset of the first one also applies before it.
+        TimeZone(std::string name, std::vector<Transition> transitions) : name(std::move(name)), transitions(std::move(transitions)) {
+            if (this->transitions.empty())
+                throw std::invalid_argument("Time zone needs at least one transition.");
+            for (size_t i = 1; i < this->transitions.size(); ++i)
+                if (this->transitions[i].utc <= this->transitions[i - 1].utc)
+                    throw std::invalid_argument("Time zone transitions must be sorted.");
+        }
+
+        TimeZone(const TimeZone& other) : name(other.name), transitions(other.transitions) {}
+        TimeZone& operator=(const TimeZone& other) {
+            this->name = other.name;
+            this->transitions = other.transitions;
+            this->lastSegment.store(0, std::memory_order_relaxed);
+            return *this;
+        }
+
+        static TimeZone fixed(timezone_offset_t timezoneOffset, const std::string& name = "") {
+            return TimeZone(name, {{std::numeric_limits<long long>::min(), static_cast<int>(timezoneOffset * 3600)}});
+        }
+
+        // Contents of a TZif file (RFC 8536), versions 1 to 4. Files with leap seconds ("right/...") aren't supported.
+        static TimeZone fromTZif(const std::string& name, const char* data, size_t size);
+        static TimeZone fromFile(const std::string& path, const std::string& name = "");
+        // Zone `name` (e.g. "Europe/Berlin") from the directory in $TZDIR, or /usr/share/zoneinfo.
+        static TimeZone locate(const std::string& name);
+
+        const std::string& getName() const { return this->name; }
+        const std::vector<Transition>& getTransitions() const { return this->transitions; }
+
+        int offsetAt(long long utc) const {
+            return this->transitions[segmentOf(utc)].offset;
+        }
+
+        long long toLocal(long long utc) const {
+            return utc + offsetAt(utc);
+        }
+
+        CivilTime decompose(long long utc) const {
+            const int offset = offsetAt(utc);
+            return detail::civilTimeFromLocal(utc + offset, offset / 3600.0);
+        }
+
+        void offsetAt(const long long* utc, size_t count, int* out) const {
+            forEachRun(utc, count, [&](size_t begin, size_t end, int offset) {
+                for (size_t i = begin; i < end; ++i)
+                    out[i] = offset;
+            });
+        }
+
+        void toLocal(const long long* utc, size_t count, long long* out) const {
+            forEachRun(utc, count, [&](size_t begin, size_t end, int offset) {
+                for (size_t i = begin; i < end; ++i)
+                    out[i] = utc[i] + offset;
+            });
+        }
+
+        // Long batches go through a DayCache, like `beliumgl::decompose`.
+        void decompose(const long long* utc, size_t count, CivilTime* out) const {
+            if (count < detail::cachedBatch) {
+                forEachRun(utc, count, [&](size_t begin, size_t end, int offset) {
+                    const timezone_offset_t timezoneOffset = offset / 3600.0;
+                    for (size_t i = begin; i < end; ++i)
+                        out[i] = detail::civilTimeFromLocal(utc[i] + offset, timezoneOffset);
+                });
+                return;
+            }
+            DayCache<> cache;
+            forEachRun(utc, count, [&](size_t begin, size_t end, int offset) {
+                const timezone_offset_t timezoneOffset = offset / 3600.0;
+                for (size_t i = begin; i < end; ++i)
+                    out[i] = cache.fromLocal(utc[i] + offset, timezoneOffset);
+            });
+        }
+    private:
+        std::string name;
+        std::vector<Transition> transitions;
+        mutable std::atomic<size_t> lastSegment{0};
+
+        // Appends the transitions of a POSIX TZ rule (the TZif footer, e.g. "CET-1CEST,M3.5.0,M10.5.0/3").
+        static void expandRule(const std::string& rule, std::vector<Transition>& transitions);
+
+        size_t segmentOf(long long utc) const {
+            size_t segment = this->lastSegment.load(std::memory_order_relaxed);
+            if (segment < this->transitions.size() && this->transitions[segment].utc <= utc
+                && (segment + 1 == this->transitions.size() || utc < this->transitions[segment + 1].utc))
+                return segment;
+
+            size_t low = 0, high = this->transitions.size();
+            while (high - low > 1) {
+                size_t middle = low + (high - low) / 2;
+                if (this->transitions[middle].utc <= utc) low = middle;
+                else high = middle;
+            }
+            this->lastSegment.store(low, std::memory_order_relaxed);
+            return low;
+        }
+
+        /*
+         * Calls `apply(begin, end, offset)` for runs of `utc` with the same offset. Blocks that are sorted
+         * are split at the transitions with binary searches; others are looked up one by one.
+         */
+        template<typename F>
+        void forEachRun(const long long* utc, size_t count, F apply) const {
+            constexpr size_t blockSize = 1024;
+            for (size_t block = 0; block < count; block += blockSize) {
+                const size_t blockEnd = std::min(count, block + blockSize);
+                bool sorted = true;
+                for (size_t i = block + 1; i < blockEnd; ++i)
+                    sorted &= utc[i - 1] <= utc[i];
+
+                if (!sorted) {
+                    for (size_t i = block; i < blockEnd; ++i)
+                        apply(i, i + 1, this->transitions[segmentOf(utc[i])].offset);
+                    continue;
+                }
+                for (size_t i = block; i < blockEnd;) {
+                    const size_t segment = segmentOf(utc[i]);
+                    size_t end = blockEnd;
+                    if (segment + 1 < this->transitions.size())
+                        end = static_cast<size_t>(std::lower_bound(utc + i, utc + blockEnd, this->transitions[segment + 1].utc) - utc);
+                    apply(i, end, this->transitions[segment].offset);
+                    i = end;
+                }
+            }
+        }
+    };
+
+    /*
+     * --------------
+     * MULTIPLE ZONES
+     * --------------
+     *
+     * Like decomposeInOffsets and formatInOffsets (in `datepp.hpp`), with the offset each zone has at `_unix`.
+     */
+    inline void decomposeInZones(long long _unix, const TimeZone* const* zones, size_t count, CivilTime* out) {
+        int secondsOfDay;
+        const long long days = splitUnix(_unix, 0.0, secondsOfDay);
+        const CivilTime utc = detail::civilTimeFromLocal(_unix, days, 0.0);
+        for (size_t i = 0; i < count; ++i) {
+            const int offset = zones[i]->offsetAt(_unix);
+            out[i] = detail::shiftCivilTime(utc, days, secondsOfDay, offset, offset / 3600.0);
+        }
+    }
+
+    inline size_t formatInZones(char* buffer, size_t size, long long _unix, const TimeZone* const* zones, size_t count,
+                                const DateTimeFormat& format, size_t* ends = nullptr, char separator = '\n') {
+        int secondsOfDay;
+        const long long days = splitUnix(_unix, 0.0, secondsOfDay);
+        const CivilTime utc = detail::civilTimeFromLocal(_unix, days, 0.0);
+        return detail::formatEach(buffer, size, count, format, ends, separator, [&](size_t i) {
+            const int offset = zones[i]->offsetAt(_unix);
+            return detail::shiftCivilTime(utc, days, secondsOfDay, offset, offset / 3600.0);
+        });
+    }
+
+#if !defined(DATEPP_SEPARATE_COMPILATION) || defined(DATEPP_IMPLEMENTATION)
+    DATEPP_DECL TimeZone TimeZone::fromTZif(const std::string& name, const char* data, size_t size) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        auto read32 = [&](size_t at) {
+            return static_cast<unsigned long>(bytes[at]) << 24 | static_cast<unsigned long>(bytes[at + 1]) << 16
+                 | static_cast<unsigned long>(bytes[at + 2]) << 8 | bytes[at + 3];
+        };
+        auto readTime = [&](size_t at, size_t length) {
+            unsigned long long value = 0;
+            for (size_t i = 0; i < length; ++i)
+                value = value << 8 | bytes[at + i];
+            if (length == 4)
+                return static_cast<long long>(static_cast<int>(static_cast<unsigned>(value)));
+            return static_cast<long long>(value);
+        };
+
+        // Header: "TZif", version, 15 unused bytes, then the counts
+        constexpr size_t headerSize = 44;
+        size_t at = 0;
+        if (size < headerSize || std::memcmp(data, "TZif", 4) != 0)
+            throw std::runtime_error("Invalid TZif data.");
+        const bool version2 = bytes[4] >= '2';
+        size_t timeSize = 4;
+        for (int pass = 0; pass < 2; ++pass) {
+            if (size - at < headerSize || std::memcmp(data + at, "TZif", 4) != 0)
+                throw std::runtime_error("Invalid TZif data.");
+            const size_t isUtCount = read32(at + 20), isStdCount = read32(at + 24), leapCount = read32(at + 28);
+            const size_t timeCount = read32(at + 32), typeCount = read32(at + 36), charCount = read32(at + 40);
+            const size_t blockSize = timeCount * (timeSize + 1) + typeCount * 6 + charCount + leapCount * (timeSize + 4) + isStdCount + isUtCount;
+            at += headerSize;
+            if (timeCount > size || typeCount > size || charCount > size || leapCount > size || blockSize > size - at)
+                throw std::runtime_error("Invalid TZif data.");
+
+            // Version 1 data is only read from version 1 files; the others repeat it with 64-bit times.
+            if (pass == 0 && version2) {
+                at += blockSize;
+                timeSize = 8;
+                continue;
+            }
+            if (leapCount > 0)
+                throw std::runtime_error("TZif data with leap seconds isn't supported.");
+            if (typeCount == 0)
+                throw std::runtime_error("Invalid TZif data.");
+
+            const size_t times = at, indices = times + timeCount * timeSize, types = indices + timeCount;
+            auto typeOffset = [&](size_t type) {
+                return static_cast<int>(readTime(types + type * 6, 4));
+            };
+
+            // Before the first transition, the first type applies.
+            std::vector<Transition> transitions;
+            transitions.push_back({std::numeric_limits<long long>::min(), typeOffset(0)});
+            for (size_t i = 0; i < timeCount; ++i) {
+                const long long utc = readTime(times + i * timeSize, timeSize);
+                const size_t type = bytes[indices + i];
+                if (type >= typeCount || (i > 0 && utc <= readTime(times + (i - 1) * timeSize, timeSize)))
+                    throw std::runtime_error("Invalid TZif data.");
+                const int offset = typeOffset(type);
+                if (offset != transitions.back().offset) // Changes of only the abbreviation or DST flag don't matter here
+                    transitions.push_back({utc, offset});
+            }
+            at += blockSize;
+
+            // Footer: "\n<POSIX TZ rule>\n"
+            if (version2 && at < size && data[at] == '\n') {
+                const char* ruleEnd = static_cast<const char*>(std::memchr(data + at + 1, '\n', size - at - 1));
+                if (ruleEnd != nullptr)
+                    expandRule(std::string(data + at + 1, ruleEnd), transitions);
+            }
+            return TimeZone(name, std::move(transitions));
+        }
+        throw std::runtime_error("Invalid TZif data.");
+    }
+
+    DATEPP_DECL TimeZone TimeZone::fromFile(const std::string& path, const std::string& name) {
+        std::string data;
+        if (!detail::readFile(path, data))
+            throw std::runtime_error("Failed to open the time zone file.");
+        return fromTZif(name.empty() ? path : name, data.data(), data.size());
+    }
+
+    DATEPP_DECL TimeZone TimeZone::locate(const std::string& name) {
+        if (name.empty() || name[0] == '/' || name.find("..") != std::string::npos)
+            throw std::invalid_argument("Invalid time zone name.");
+        const char* directory = std::getenv("TZDIR");
+        return fromFile(std::string(directory != nullptr && *directory != '\0' ? directory : "/usr/share/zoneinfo") + "/" + name, name);
+    }
+
+    DATEPP_DECL void TimeZone::expandRule(const std::string& rule, std::vector<Transition>& transitions) {
+        const char* p = rule.c_str();
+
+        // "CET" or "<+03>"
+        auto skipName = [&]() {
+            const char* begin = p;
+            if (*p == '<') {
+                while (*p != '\0' && *p != '>') ++p;
+                if (*p != '>') return false;
+                ++p;
+                return true;
+            }
+            while (std::isalpha(static_cast<unsigned char>(*p))) ++p;
+            return p - begin >= 3;
+        };
+        // [+-]hh[:mm[:ss]], in seconds
+        auto readTime = [&](long long& seconds) {
+            int sign = 1;
+            if (*p == '+' || *p == '-') sign = *p++ == '-' ? -1 : 1;
+            if (!std::isdigit(static_cast<unsigned char>(*p))) return false;
+            long long parts[3] = {0, 0, 0};
+            for (int part = 0; part < 3; ++part) {
+                while (std::isdigit(static_cast<unsigned char>(*p)))
+                    parts[part] = parts[part] * 10 + (*p++ - '0');
+                if (part == 2 || *p != ':') break;
+                ++p;
+            }
+            seconds = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+            return true;
+        };
+        // Mm.w.d, Jn or n, then an optional "/time" (02:00:00 by default)
+        struct Date {
+            char kind = 'M';
+            int month = 0, week = 0, day = 0;
+            long long time = 7200;
+        };
+        auto readDate = [&](Date& date) {
+            auto number = [&]() {
+                int value = 0;
+                while (std::isdigit(static_cast<unsigned char>(*p))) value = value * 10 + (*p++ - '0');
+                return value;
+            };
+            if (*p == 'M') {
+                ++p;
+                date.kind = 'M';
+                date.month = number();
+                if (*p++ != '.') return false;
+                date.week = number();
+                if (*p++ != '.') return false;
+                date.day = number();
+                if (date.month < 1 || date.month > 12 || date.week < 1 || date.week > 5 || date.day > 6) return false;
+            } else if (*p == 'J') {
+                ++p;
+                date.kind = 'J';
+                date.day = number();
+                if (date.day < 1 || date.day > 365) return false;
+            } else if (std::isdigit(static_cast<unsigned char>(*p))) {
+                date.kind = 'n';
+                date.day = number();
+                if (date.day > 365) return false;
+            } else {
+                return false;
+            }
+            return *p != '/' || (++p, readTime(date.time));
+        };
+        // Days since 01.01.1970 of `date` in `year`
+        auto daysOf = [](const Date& date, long long year) {
+            const long long january = daysFromCivil(year, 0, 0);
+            if (date.kind == 'J')
+                return january + date.day - 1 + (isLeapYear(year) && date.day >= 60 ? 1 : 0);
+            if (date.kind == 'n')
+                return january + date.day;
+
+            const month_t month = static_cast<month_t>(date.month - 1);
+            const long long first = daysFromCivil(year, month, 0);
+            long long days = first + (date.day - weekdayFromDays(first) + 7) % 7 + (date.week - 1) * 7;
+            while (days >= first + daysInMonth(year, month)) // The 5th week is the last one
+                days -= 7;
+            return days;
+        };
+
+        long long standardOffset, daylightOffset;
+        if (!skipName() || !readTime(standardOffset))
+            return;
+        standardOffset = -standardOffset; // POSIX offsets are west of UTC
+        if (*p == '\0' || !skipName())
+            return; // No daylight saving time; the last transition already has the offset
+        daylightOffset = standardOffset + 3600;
+        if (*p != ',' && *p != '\0') {
+            if (!readTime(daylightOffset))
+                return;
+            daylightOffset = -daylightOffset;
+        }
+
+        Date start, end;
+        if (*p == '\0') {
+            // No dates: the US rules, like tzcode
+            start.month = 3, start.week = 2, start.day = 0;
+            end.month = 11, end.week = 1, end.day = 0;
+        } else if (*p++ != ',' || !readDate(start) || *p++ != ',' || !readDate(end) || *p != '\0') {
+            return;
+        }
+
+        const long long last = transitions.back().utc;
+        const long long firstYear = last == std::numeric_limits<long long>::min() ? 1970 : civilDateFromDays(floorDiv(last, 86400)).year;
+        for (long long year = firstYear; year <= ruleYears; ++year) {
+            // The start is in standard time, the end in daylight saving time.
+            Transition changes[2] = {
+                {daysOf(start, year) * 86400 + start.time - standardOffset, static_cast<int>(daylightOffset)},
+                {daysOf(end, year) * 86400 + end.time - daylightOffset, static_cast<int>(standardOffset)}
+            };
+            if (changes[1].utc < changes[0].utc) // Southern hemisphere
+                std::swap(changes[0], changes[1]);
+            for (const Transition& change : changes)
+                if (change.utc > transitions.back().utc && change.offset != transitions.back().offset)
+                    transitions.push_back(change);
+        }
+    }
+
+#endif
+}
@@ -0,0 +1,12 @@
+/*
+ * The compiled part of datepp: the out-of-line functions of `datepp.hpp`, `datepp_leapseconds.hpp`
+ * and `datepp_zones.hpp` (for programs built with `DATEPP_SEPARATE_COMPILATION`) and the C API declared in `datepp.h`.
+ *
+ * Built into libdatepp.a / libdatepp.so by the CMake project.
+ */
+
+#define DATEPP_IMPLEMENTATION
+#define DATEPP_C_API
+#include "../datepp.hpp"
+#include "../datepp_leapseconds.hpp"
+#include "../datepp_zones.hpp"
@@ -0,0 +1,8 @@
+/*
+ * LD_PRELOAD replacement of libc's `gmtime_r`, `gmtime`, `timegm` and `strftime`.
+ *
+ * Built into libdatepp_shim.so by the CMake project.
+ */
+
+#define DATEPP_LIBC_SHIM
+#include "../datepp.hpp"
@@ -0,0 +1,132 @@
+/*
+ * allocations: checks the heap allocation budgets in the README ("Allocation Budgets").
+ *
+ * Build (like the tools, header-only):
+ *     g++ -std=c++11 -O2 tests/allocations.cpp -o allocations
+ *
+ * Every call is made once before it's measured, so only the steady state counts.
+ * Prints every call with its allocations and exits with 1 if any of them is over its budget or fails.
+ */
+
+#define DATEPP_ALLOCATION_TRACKING
+#include "../datepp.hpp"
+#include "../datepp_parser.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+    using namespace beliumgl;
+
+    volatile long long sink;
+    int failures = 0;
+
+    // `call` returns false if it failed, which would make a budget of 0 meaningless.
+    template<typename F>
+    void expect(const char* name, unsigned long long budget, F call) {
+        bool ok = call();
+        instrumentation::AllocationScope scope;
+        ok = call() && ok;
+        unsigned long long allocations = scope.allocations();
+
+        const bool passed = ok && allocations <= budget;
+        std::printf("%-4s %-52s %llu (budget %llu)%s\n", passed ? "ok" : "FAIL", name, allocations, budget, ok ? "" : ", call failed");
+        if (!passed)
+            ++failures;
+    }
+}
+
+int main() {
+    const std::string longPattern = "W, DD/MM/YY, HH:II:SS O UTC";
+    const std::string shortPattern = "YY-MM-DD"; // "2023-11-14 ", which fits the SSO buffer
+    const std::string unixString = "1700000000";
+    const DateTimeFormat longFormat(longPattern);
+    const DateTimeFormat shortFormat(shortPattern);
+    const DateTime a(1700000000LL), b(86400LL, 2.0);
+    const CivilTime civil = decompose(1700000000LL, 5.5);
+    char buffer[128];
+
+    /*
+     * ---------------
+     * FORMATS & DATES
+     * ---------------
+     */
+    expect("DateTimeFormat(pattern)", 0, [&]() { return DateTimeFormat(longPattern).getShowTime(); });
+    expect("DateTime(long long)", 0, [&]() { DateTime d(1700000000LL, 1.0); sink = d.year(); return true; });
+    expect("DateTime(std::string)", 0, [&]() { DateTime d(unixString); sink = d.year(); return true; });
+    expect("DateTime comparisons", 0, [&]() { return a > b && !(a == b) && !(a <= b); });
+    expect("DateTime arithmetic", 0, [&]() { sink = (a + b).unixTime() + (a - b).unixTime(); return true; });
+    expect("DateTime::addChecked", 0, [&]() { DateTime d(0LL); return a.addChecked(b, d) == Status::Ok; });
+    expect("DateTime::fromUnix", 0, [&]() { DateTime d(0LL); return DateTime::fromUnix(-30000000000LL, d, 3.0) == Status::Ok; });
+    expect("DateTime::parse", 0, [&]() {
+        DateTime d(0LL);
+        return DateTime::parse(unixString.c_str(), unixString.size(), d) == Status::Ok;
+    });
+
+    /*
+     * -----------------------
+     * CONVERSION & FORMATTING
+     * -----------------------
+     */
+    expect("decompose", 0, [&]() { sink = decompose(-30000000000LL, -3.0).year; return true; });
+    expect("formatTo", 0, [&]() { return formatTo(buffer, sizeof(buffer), civil, longFormat) > 0; });
+    expect("FormattedDateTime::format", 0, [&]() { return FormattedDateTime::format(civil, longFormat).size() > 0; });
+    expect("DateTime::toFixedString", 0, [&]() { return a.toFixedString(longFormat).size() > 0; });
+    expect("DateTime::toString (fits the SSO buffer)", 0, [&]() { return a.toString(shortFormat).size() <= 15; });
+    expect("DateTime::toString (longer)", 1, [&]() { return a.toString(longFormat).size() > 15; });
+    expect("DateTime::toStringLit", 1, [&]() {
+        char* text = a.toStringLit(shortFormat);
+        bool ok = text[0] != '\0';
+        delete[] text;
+        return ok;
+    });
+
+    /*
+     * -------
+     * PARSING
+     * -------
+     */
+    const std::string formatted = a.toString(longFormat);
+    const char* const iso = "2023-11-14T22:13:20.5+01:00";
+    const char* const rfc2822 = "Tue, 14 Nov 2023 22:13:20 +0000";
+    TimestampParser parser;
+    expect("parseFormatted", 0, [&]() {
+        long long out;
+        return parseFormatted(formatted.c_str(), formatted.size(), longFormat, out) && out == 1700000000LL;
+    });
+    expect("parseEpoch", 0, [&]() {
+        long long out;
+        size_t digits;
+        return parseEpoch(unixString.c_str(), unixString.size(), out, digits);
+    });
+    expect("parseISO8601", 0, [&]() { long long out; return parseISO8601(iso, std::strlen(iso), out); });
+    expect("parseRFC2822", 0, [&]() { long long out; return parseRFC2822(rfc2822, std::strlen(rfc2822), out); });
+    expect("TimestampParser::parse", 0, [&]() { long long out; return parser.parse(rfc2822, std::strlen(rfc2822), out); });
+
+    /*
+     * -------------
+     * SERIALIZATION
+     * -------------
+     */
+    long long seconds;
+    int nanoseconds;
+    unsigned char message[32];
+    expect("writeRFC3339", 0, [&]() { return writeRFC3339(buffer, sizeof(buffer), 1700000000LL, 250000000, 1.0) > 0; });
+    expect("parseRFC3339", 0, [&]() { return parseRFC3339(iso, std::strlen(iso), seconds, nanoseconds); });
+    expect("writeEpochNumber", 0, [&]() { return writeEpochNumber(buffer, sizeof(buffer), -2, 500000000) > 0; });
+    expect("parseEpochNumber", 0, [&]() { return parseEpochNumber("1700000000.123456789", 20, seconds, nanoseconds); });
+    expect("writeJSONString", 0, [&]() { return writeJSONString(buffer, sizeof(buffer), 1700000000LL, 0, -3.5) > 0; });
+    expect("parseJSONTimestamp", 0, [&]() { return parseJSONTimestamp("\"2023-11-14T22:13:20Z\"", 22, seconds, nanoseconds); });
+    expect("writeTimestampMessage", 0, [&]() { return writeTimestampMessage(message, sizeof(message), 1700000000LL, 5) > 0; });
+    expect("parseTimestampMessage", 0, [&]() {
+        size_t length = writeTimestampMessage(message, sizeof(message), -1700000000LL, 999999999);
+        return parseTimestampMessage(message, length, seconds, nanoseconds) && seconds == -1700000000LL;
+    });
+
+    if (failures != 0) {
+        std::fprintf(stderr, "allocations: %d call(s) over budget or failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * The C API (datepp.h), compiled as C: fixed and named zones in the batch functions,
+ * and local times skipped or repeated by a daylight saving transition.
+ * Exits with 77 (skipped) if the system has no zoneinfo database.
+ */
+
+#include "datepp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void checkFormat(const datepp_format* format, const datepp_zone* zone, int64_t unix_time, const char* expected) {
+    char buffer[128];
+    size_t offset, written;
+    CHECK(datepp_format_batch(format, zone, &unix_time, 1, buffer, sizeof(buffer), &offset, &written) == DATEPP_OK);
+    CHECK(written == 1 && strncmp(buffer, expected, strlen(expected)) == 0);
+}
+
+static int64_t parse(const datepp_format* format, const datepp_zone* zone, const char* string) {
+    size_t offsets[2] = {0, strlen(string)};
+    int64_t result = -1;
+    uint8_t ok = 0;
+    CHECK(datepp_parse_batch(format, zone, string, offsets, 1, &result, &ok) == DATEPP_OK && ok == 1);
+    return result;
+}
+
+int main(void) {
+    datepp_format* format;
+    datepp_format* withOffset;
+    datepp_zone* fixed;
+    datepp_zone* berlin;
+    datepp_zone* zone;
+
+    CHECK(datepp_abi_version() == DATEPP_ABI_VERSION);
+    CHECK(datepp_format_create("DD.MM.YYYY HH:II:SS", &format) == DATEPP_OK);
+    CHECK(datepp_format_create("DD.MM.YYYY HH:II:SS O", &withOffset) == DATEPP_OK);
+
+    CHECK(datepp_zone_create_fixed(5.5, &fixed) == DATEPP_OK);
+    CHECK(datepp_zone_create_fixed(1000.0, &zone) == DATEPP_INVALID_ARGUMENT);
+    checkFormat(format, NULL, 1700000000, "14.11.2023 22:13:20");
+    checkFormat(format, fixed, 1700000000, "15.11.2023 03:43:20");
+    CHECK(parse(format, fixed, "15.11.2023 03:43:20") == 1700000000);
+
+    CHECK(datepp_zone_create_named("No/Such_Zone", &zone) == DATEPP_ZONE_NOT_FOUND);
+    if (datepp_zone_create_named("Europe/Berlin", &berlin) != DATEPP_OK) {
+        fprintf(stderr, "c_api: no zoneinfo database, named zones skipped\n");
+        return failures == 0 ? 77 : 1;
+    }
+
+    {
+        /* One batch across the summer: the offset follows the transitions. */
+        int64_t times[3] = {1679794200 - 3600, 1689328800, 1700000000};
+        datepp_fields fields[3];
+        CHECK(datepp_decompose_batch(berlin, times, 3, fields) == DATEPP_OK);
+        CHECK(fields[0].utc_offset == 1.0 && fields[0].hour == 1 && fields[0].minute == 30);
+        CHECK(fields[1].utc_offset == 2.0 && fields[1].hour == 12);
+        CHECK(fields[2].utc_offset == 1.0 && fields[2].hour == 23 && fields[2].day == 13 && fields[2].month == 10);
+    }
+    checkFormat(format, berlin, 1689328800, "14.07.2023 12:00:00");
+    CHECK(parse(format, berlin, "14.07.2023 12:00:00") == 1689328800);
+    CHECK(parse(format, berlin, "14.11.2023 23:13:20") == 1700000000);
+    /* 02:30 doesn't exist on the 26th of March and is moved forward by the hour skipped. */
+    CHECK(parse(format, berlin, "26.03.2023 02:30:00") == 1679794200);
+    /* 02:30 happens twice on the 29th of October; the first one is taken. */
+    CHECK(parse(format, berlin, "29.10.2023 02:30:00") == 1698539400);
+    /* An offset in the string wins over the zone. */
+    CHECK(parse(withOffset, berlin, "14.07.2023 10:00:00 +00.000000 UTC") == 1689328800);
+    CHECK(parse(withOffset, berlin, "14.07.2023 12:00:00") == 1689328800);
+
+    {
+        /* The same zone from the contents of its file. */
+        FILE* file = fopen("/usr/share/zoneinfo/America/New_York", "rb");
+        if (file != NULL) {
+            static char data[1 << 16];
+            size_t size = fread(data, 1, sizeof(data), file);
+            fclose(file);
+            CHECK(datepp_zone_create_tzif("America/New_York", data, size, &zone) == DATEPP_OK);
+            checkFormat(format, zone, 1700000000, "14.11.2023 17:13:20");
+            CHECK(parse(format, zone, "14.07.2023 06:00:00") == 1689328800);
+            datepp_zone_destroy(zone);
+            CHECK(datepp_zone_create_tzif(NULL, data, 10, &zone) == DATEPP_INVALID_ARGUMENT);
+        }
+    }
+
+    datepp_zone_destroy(berlin);
+    datepp_zone_destroy(fixed);
+    datepp_format_destroy(withOffset);
+    datepp_format_destroy(format);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*
+ * calendar_difference: known differences (month ends, leap days, borrowed days), the difference added back
+ * to `from` giving `to` for many pairs and offsets, the negated difference when `to` is first,
+ * and monthsBetween, yearsBetween and the batch and DateTime forms.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+namespace {
+    using namespace beliumgl;
+
+    long long unixOf(long long year, int month, int day, int hour = 0, int minute = 0, int second = 0) {
+        return daysFromCivil(year, static_cast<month_t>(month - 1), static_cast<day_t>(day - 1)) * 86400
+             + hour * 3600LL + minute * 60LL + second;
+    }
+
+    bool differs(long long from, long long to, long long years, int months, int days, int hours = 0, int minutes = 0,
+                 int seconds = 0, timezone_offset_t offset = 0.0) {
+        CalendarDifference expected;
+        expected.years = years;
+        expected.months = months;
+        expected.days = days;
+        expected.hours = hours;
+        expected.minutes = minutes;
+        expected.seconds = seconds;
+        return calendarDifference(from, to, offset) == expected;
+    }
+
+    // `from` moved by the months, then by the days and the time, is `to`; every field is in its range.
+    void checkRoundTrip(long long from, long long to, timezone_offset_t offset) {
+        const CalendarDifference difference = calendarDifference(from, to, offset);
+        const long long first = from <= to ? from : to, last = from <= to ? to : from;
+        const int sign = from <= to ? 1 : -1;
+
+        long long moved = 0;
+        CHECK(advanceChecked(first, RangeStep::months(sign * difference.totalMonths()), moved, offset) == Status::Ok);
+        moved += sign * (difference.days * 86400LL + difference.hours * 3600LL + difference.minutes * 60LL + difference.seconds);
+        CHECK_EQ(moved, last);
+
+        CHECK(sign * difference.years >= 0 && sign * difference.months >= 0 && sign * difference.months <= 11);
+        CHECK(sign * difference.days >= 0 && sign * difference.days <= 30);
+        CHECK(sign * difference.hours >= 0 && sign * difference.hours <= 23);
+        CHECK(sign * difference.minutes >= 0 && sign * difference.minutes <= 59);
+        CHECK(sign * difference.seconds >= 0 && sign * difference.seconds <= 59);
+    }
+}
+
+int main() {
+    // Month ends: 31.01 to 28.02 or 29.02 isn't a whole month yet.
+    CHECK(differs(unixOf(2024, 1, 31), unixOf(2024, 2, 29), 0, 0, 29));
+    CHECK(differs(unixOf(2023, 1, 31), unixOf(2023, 2, 28), 0, 0, 28));
+    CHECK(differs(unixOf(2024, 1, 31), unixOf(2024, 3, 31), 0, 2, 0));
+    CHECK(differs(unixOf(2024, 1, 30), unixOf(2024, 3, 1), 0, 1, 1));
+
+    // Ages: a leap day birthday, and a day borrowed for the time.
+    CHECK(differs(unixOf(2000, 2, 29), unixOf(2024, 2, 28), 23, 11, 30));
+    CHECK(differs(unixOf(2000, 2, 29), unixOf(2024, 2, 29), 24, 0, 0));
+    CHECK(differs(unixOf(2023, 3, 15, 10), unixOf(2024, 3, 14, 9), 0, 11, 27, 23));
+    CHECK(differs(unixOf(1969, 12, 31, 23, 59, 59), unixOf(1970, 1, 1), 0, 0, 0, 0, 0, 1));
+    CHECK(differs(unixOf(-1, 6, 15), unixOf(1, 6, 15, 0, 0, 1), 2, 0, 0, 0, 0, 1));
+    CHECK(differs(0, 0, 0, 0, 0));
+
+    // When `to` is first, every field is negated.
+    CHECK(differs(unixOf(2024, 3, 14, 9), unixOf(2023, 3, 15, 10), 0, -11, -27, -23));
+
+    // Both ends are read in the offset, which moves them across month boundaries.
+    const long long from = unixOf(2024, 1, 31, 22), to = unixOf(2024, 2, 29, 23);
+    CHECK(differs(from, to, 0, 0, 29, 1));
+    CHECK(differs(from, to, 0, 1, 0, 1, 0, 0, 2.0));
+
+    // Round trips over many pairs, in both directions and a few offsets.
+    const timezone_offset_t offsets[] = {0.0, 5.5, -9.75};
+    for (timezone_offset_t offset : offsets)
+        for (long long a = -5000000000LL; a < 5000000000LL; a += 376543217LL)
+            for (long long b = -3000000000LL; b < 6000000000LL; b += 412345679LL) {
+                checkRoundTrip(a, b, offset);
+                checkRoundTrip(a, a + (b % 5000000), offset);
+            }
+
+    // Whole months and years round toward zero.
+    CHECK_EQ(monthsBetween(unixOf(2024, 1, 31), unixOf(2024, 2, 29)), 0LL);
+    CHECK_EQ(monthsBetween(unixOf(2024, 1, 31), unixOf(2025, 1, 30, 23)), 11LL);
+    CHECK_EQ(monthsBetween(unixOf(2025, 1, 31), unixOf(2024, 1, 30)), -12LL);
+    CHECK_EQ(yearsBetween(unixOf(2000, 2, 29), unixOf(2024, 2, 28)), 23LL);
+    CHECK_EQ(yearsBetween(unixOf(2024, 2, 28), unixOf(2000, 2, 29)), -23LL);
+
+    // The batch forms and DateTime, which uses its own offset.
+    const long long froms[] = {unixOf(2024, 1, 31), unixOf(2000, 2, 29), 0};
+    const long long tos[] = {unixOf(2024, 3, 31), unixOf(2024, 2, 28), -86400 * 40};
+    CalendarDifference differences[3];
+    long long months[3];
+    calendarDifference(froms, tos, 3, differences);
+    monthsBetween(froms, tos, 3, months);
+    for (size_t i = 0; i < 3; ++i) {
+        CHECK(differences[i] == calendarDifference(froms[i], tos[i]));
+        CHECK_EQ(months[i], differences[i].totalMonths());
+    }
+
+    const DateTime start(from, 2.0), end(to, 2.0);
+    CHECK(start.calendarDifference(end) == calendarDifference(from, to, 2.0));
+    CHECK_EQ(start.monthsBetween(end), 1LL);
+    CHECK_EQ(DateTime(from).monthsBetween(end), 0LL);
+    CHECK_EQ(start.yearsBetween(end), 0LL);
+    CHECK_EQ(start.daysBetween(end), 29LL);
+
+    return checks::exitCode();
+}
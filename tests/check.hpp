@@ -0,0 +1,40 @@
+/*
+ * Checks shared by the tests: CHECK(condition) and CHECK_EQ(actual, expected) print the failed expression
+ * (and the values) with its line and carry on, and `main` returns `checks::exitCode()`.
+ */
+
+#pragma once
+
+#include <iostream>
+
+namespace checks {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int exitCode() {
+        if (failures() != 0)
+            std::cerr << failures() << " check(s) failed\n";
+        return failures() == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition << "\n";   \
+            ++checks::failures();                                                     \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                    \
+    do {                                                                              \
+        const auto& checkActual = (actual);                                           \
+        const auto& checkExpected = (expected);                                       \
+        if (!(checkActual == checkExpected)) {                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << #actual << " is \""   \
+                      << checkActual << "\", expected \"" << checkExpected << "\"\n"; \
+            ++checks::failures();                                                     \
+        }                                                                             \
+    } while (0)
@@ -0,0 +1,119 @@
+/*
+ * checked_arithmetic: the checked and saturating functions at the edges of `long long`,
+ * DateTime's Status functions at the edges of `year_t`, the operators throwing instead of overflowing,
+ * and daysBetween on timestamps whose difference doesn't fit in `long long`.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    using namespace beliumgl;
+
+    constexpr long long max = std::numeric_limits<long long>::max();
+    constexpr long long min = std::numeric_limits<long long>::min();
+
+    template<typename Exception, typename F>
+    bool throws(F call) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+
+    Status parse(const std::string& text, DateTime& out) {
+        return DateTime::parse(text.c_str(), text.size(), out);
+    }
+}
+
+int main() {
+    long long out = 42;
+
+    // Failures leave `out` untouched.
+    CHECK(addChecked(max, 1, out) == Status::Overflow && out == 42);
+    CHECK(addChecked(min, -1, out) == Status::Overflow && out == 42);
+    CHECK(subChecked(min, 1, out) == Status::Overflow && out == 42);
+    CHECK(subChecked(0, min, out) == Status::Overflow && out == 42);
+    CHECK(mulChecked(max / 2 + 1, 2, out) == Status::Overflow && out == 42);
+    CHECK(mulChecked(min, -1, out) == Status::Overflow && out == 42);
+    CHECK(mulChecked(-1, min, out) == Status::Overflow && out == 42);
+    CHECK(divChecked(1, 0, out) == Status::DivisionByZero && out == 42);
+    CHECK(divChecked(min, -1, out) == Status::Overflow && out == 42);
+
+    CHECK(addChecked(max, min, out) == Status::Ok && out == -1);
+    CHECK(subChecked(-1, max, out) == Status::Ok && out == min);
+    CHECK(mulChecked(min / 2, 2, out) == Status::Ok && out == min);
+    CHECK(mulChecked(-3037000499LL, 3037000499LL, out) == Status::Ok && out == -9223372030926249001LL);
+    CHECK(divChecked(-7, 2, out) == Status::Ok && out == -3);
+
+    CHECK_EQ(addSaturating(max, 1), max);
+    CHECK_EQ(addSaturating(min, -1), min);
+    CHECK_EQ(subSaturating(min, 1), min);
+    CHECK_EQ(subSaturating(max, -1), max);
+    CHECK_EQ(mulSaturating(max, -2), min);
+    CHECK_EQ(mulSaturating(min, min), max);
+    CHECK_EQ(addSaturating(5, -7), -2LL);
+
+    // DateTime results must have a year that fits in `year_t`.
+    DateTime date(0LL);
+    CHECK(DateTime::fromUnix(maxDateTimeUnix, date) == Status::Ok && date.unixTime() == maxDateTimeUnix);
+    CHECK(DateTime::fromUnix(maxDateTimeUnix + 1, date) == Status::OutOfRange && date.unixTime() == maxDateTimeUnix);
+    CHECK(DateTime::fromUnix(minDateTimeUnix, date, 0.0) == Status::Ok);
+    CHECK(DateTime::fromUnix(minDateTimeUnix, date, -1.0) == Status::OutOfRange);
+    CHECK(DateTime::fromUnix(max, date, 1.0) == Status::OutOfRange);
+    CHECK(DateTime(maxDateTimeUnix).addChecked(DateTime(1LL), date) == Status::OutOfRange);
+    CHECK(DateTime(minDateTimeUnix).subChecked(DateTime(1LL), date) == Status::OutOfRange);
+    CHECK(DateTime(1000000LL).mulChecked(DateTime(1000000LL), date) == Status::OutOfRange);
+    CHECK(DateTime(1LL).divChecked(DateTime(0LL), date) == Status::DivisionByZero);
+    CHECK(DateTime(86400LL * 3).divChecked(DateTime(3LL), date) == Status::Ok && date.unixTime() == 86400);
+    CHECK(DateTime(100LL).subChecked(DateTime(300LL), date) == Status::Ok && date.unixTime() == -200);
+
+    CHECK_EQ(DateTime(maxDateTimeUnix).addSaturating(DateTime(1000LL)).unixTime(), maxDateTimeUnix);
+    CHECK_EQ(DateTime(minDateTimeUnix).subSaturating(DateTime(1000LL)).unixTime(), minDateTimeUnix);
+    CHECK_EQ(DateTime(1LL << 40).mulSaturating(DateTime(-(1LL << 40))).unixTime(), minDateTimeUnix);
+
+    CHECK(parse("-1700000000", date) == Status::Ok && date.unixTime() == -1700000000LL);
+    CHECK(parse("+86400", date) == Status::Ok && date.unixTime() == 86400);
+    CHECK(parse("", date) == Status::InvalidArgument);
+    CHECK(parse("-", date) == Status::InvalidArgument);
+    CHECK(parse("12a", date) == Status::InvalidArgument);
+    CHECK(parse("9223372036854775808", date) == Status::Overflow);
+    CHECK(parse("-9223372036854775808", date) == Status::OutOfRange);
+    CHECK(parse("99999999999999", date) == Status::OutOfRange);
+    CHECK_EQ(date.unixTime(), 86400LL);
+
+    // The operators throw where the checked functions would report an overflow.
+    const DateTime big(1LL << 62), small(-(1LL << 62));
+    CHECK_EQ((DateTime(100LL) + DateTime(23LL)).unixTime(), 123LL);
+    CHECK_EQ((DateTime(100LL) / DateTime(-7LL)).unixTime(), -14LL);
+    CHECK(throws<std::overflow_error>([&]() { return big + big; }));
+    CHECK(throws<std::overflow_error>([&]() { return small - big - big; }));
+    CHECK(throws<std::overflow_error>([&]() { return big * DateTime(2LL); }));
+    CHECK(throws<std::domain_error>([&]() { return big / DateTime(0LL); }));
+    CHECK(!throws<std::exception>([&]() { return small + small; }));
+
+    // daysBetween rounds toward zero and doesn't overflow when `to - from` would.
+    CHECK_EQ(daysBetween(0, 86399), 0LL);
+    CHECK_EQ(daysBetween(0, -86399), 0LL);
+    CHECK_EQ(daysBetween(-86401, 86399), 2LL);
+    CHECK_EQ(daysBetween(1, -86399), -1LL);
+    CHECK_EQ(daysBetween(-1, 86400 * 3 - 2), 2LL);
+    CHECK_EQ(daysBetween(min, max), 213503982334601LL);
+    CHECK_EQ(daysBetween(max, min), -213503982334601LL);
+    CHECK_EQ(daysBetween(min, 0), 106751991167300LL);
+    CHECK_EQ(daysBetween(max, 0), -106751991167300LL);
+    CHECK_EQ(daysBetween(-1, max), 106751991167300LL);
+    CHECK_EQ(daysBetween(min + 86399, max - 86399), 213503982334599LL);
+    const long long from[] = {min, 0, max}, to[] = {max, -86400, min};
+    long long days[3];
+    daysBetween(from, to, 3, days);
+    CHECK(days[0] == 213503982334601LL && days[1] == -1 && days[2] == -213503982334601LL);
+
+    return checks::exitCode();
+}
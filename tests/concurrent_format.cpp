@@ -0,0 +1,80 @@
+/*
+ * concurrent_format: formats one shared `const DateTime&` from several threads at the same time
+ * with toString, toStringLit and toFixedString, and checks every result against the single-threaded one.
+ *
+ * Meant to be run under ThreadSanitizer, which reports any data race even if the output happens to be right:
+ *     g++ -std=c++11 -O1 -g -fsanitize=thread -pthread tests/concurrent_format.cpp -o concurrent_format
+ *     ./concurrent_format [threads] [iterations]
+ *
+ * or the whole test suite: cmake -S . -B build-tsan -DCMAKE_BUILD_TYPE=Debug -DCMAKE_CXX_FLAGS=-fsanitize=thread
+ */
+
+#include "../datepp.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    const char* const patterns[] = {
+        "W, DD/MM/YY, HH:II:SS O UTC",
+        "WW, AA DD YY HH:II:SS _ O",
+        "YY-MM-DD HH:II:SS",
+        "D.M.Y H:I:S _ O"
+    };
+    constexpr size_t patternCount = sizeof(patterns) / sizeof(patterns[0]);
+
+    struct Expected {
+        std::string pattern;
+        DateTimeFormat format;
+        std::string text;
+    };
+
+    // Every thread checks all three functions, with the format given as a string and as a shared DateTimeFormat.
+    bool check(const DateTime& dateTime, const Expected& expected) {
+        if (dateTime.toString(expected.format) != expected.text || dateTime.toString(expected.pattern) != expected.text)
+            return false;
+        if (expected.text != dateTime.toFixedString(expected.format).c_str())
+            return false;
+        std::unique_ptr<char[]> literal(dateTime.toStringLit(expected.format));
+        return expected.text == literal.get();
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t threadCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    const size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    const DateTime dateTimes[] = {DateTime(1700000000LL, 5.5), DateTime(-30000000000LL, -3.0)};
+    std::vector<Expected> expected;
+    for (const DateTime& dateTime : dateTimes)
+        for (size_t i = 0; i < patternCount; ++i) {
+            DateTimeFormat format{std::string(patterns[i])};
+            expected.push_back({patterns[i], format, dateTime.toString(format)});
+        }
+
+    std::atomic<size_t> failures{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < iterations; ++i) {
+                const size_t which = (t + i) % expected.size();
+                if (!check(dateTimes[which / patternCount], expected[which]))
+                    failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    if (failures.load() != 0) {
+        std::cerr << "concurrent_format: " << failures.load() << " of " << threadCount * iterations << " results differed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * constexpr_calendar: the calendar core in constant expressions. Built as C++11, so the checks below
+ * fail to compile if any of these functions stops being a C++11 `constexpr`;
+ * the compile-time results are then compared with the same calls at run time.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+namespace {
+    using namespace beliumgl;
+
+    static_assert(daysFromCivil(1970, 0, 0) == 0, "");
+    static_assert(daysFromCivil(2000, 0, 0) == 10957, "");
+    static_assert(daysFromCivil(1969, 11, 30) == -1, "");
+    static_assert(daysFromCivil(0, 1, 28) == -719469, "");
+    static_assert(daysFromCivil(-32768, 0, 0) * 86400 == minDateTimeUnix, "");
+
+    static_assert(civilDateFromDays(10957).year == 2000, "");
+    static_assert(civilDateFromDays(-1).year == 1969 && civilDateFromDays(-1).month == 11 && civilDateFromDays(-1).day == 30, "");
+    static_assert(civilDateFromDays(-719469).year == 0 && civilDateFromDays(-719469).month == 1, "");
+
+    static_assert(isLeapYear(2000) && isLeapYear(2024) && isLeapYear(0) && isLeapYear(-4), "");
+    static_assert(!isLeapYear(1900) && !isLeapYear(2023) && !isLeapYear(-1), "");
+
+    static_assert(daysInMonth(2024, 1) == 29 && daysInMonth(2023, 1) == 28 && daysInMonth(1900, 1) == 28, "");
+    static_assert(daysInMonth(2023, 0) == 31 && daysInMonth(2023, 3) == 30 && daysInMonth(2023, 6) == 31, "");
+    static_assert(daysInMonth(2023, 7) == 31 && daysInMonth(2023, 10) == 30 && daysInMonth(2023, 11) == 31, "");
+
+    static_assert(weekdayFromDays(0) == 4, "");
+    static_assert(weekdayFromDays(-1) == 3 && weekdayFromDays(-4) == 0 && weekdayFromDays(-5) == 6, "");
+    static_assert(weekdayFromDays(10957) == 6, "");
+
+    static_assert(floorDiv(-1, 86400) == -1 && floorDiv(86400, 86400) == 1 && floorDiv(-86400, 86400) == -1, "");
+
+    static_assert(decompose(1700000000).year == 2023 && decompose(1700000000).month == 10 && decompose(1700000000).day == 13, "");
+    static_assert(decompose(1700000000).hour == 22 && decompose(1700000000).minute == 13 && decompose(1700000000).second == 20, "");
+    static_assert(decompose(1700000000, 5.5).day == 14 && decompose(1700000000, 5.5).hour == 3, "");
+    static_assert(decompose(-1).year == 1969 && decompose(-1).second == 59 && decompose(-1).dotw == 3, "");
+    static_assert(maxDateTimeUnix > 0 && decompose(maxDateTimeUnix).year == 32767, "");
+
+    // A compile-time table: the day number of the first of every month of 2024.
+    constexpr long long monthStarts[12] = {
+        daysFromCivil(2024, 0, 0), daysFromCivil(2024, 1, 0), daysFromCivil(2024, 2, 0), daysFromCivil(2024, 3, 0),
+        daysFromCivil(2024, 4, 0), daysFromCivil(2024, 5, 0), daysFromCivil(2024, 6, 0), daysFromCivil(2024, 7, 0),
+        daysFromCivil(2024, 8, 0), daysFromCivil(2024, 9, 0), daysFromCivil(2024, 10, 0), daysFromCivil(2024, 11, 0)
+    };
+    static_assert(monthStarts[2] - monthStarts[1] == 29, "");
+    static_assert(monthStarts[11] - monthStarts[0] == 335, "");
+}
+
+int main() {
+    // The same results at run time.
+    volatile long long year = 2024;
+    for (int month = 0; month < 12; ++month) {
+        CHECK_EQ(monthStarts[month], daysFromCivil(year, static_cast<month_t>(month), 0));
+        CHECK_EQ(static_cast<int>(daysInMonth(year, static_cast<month_t>(month))),
+                 static_cast<int>((month == 11 ? daysFromCivil(year + 1, 0, 0) : monthStarts[month + 1]) - monthStarts[month]));
+    }
+
+    volatile long long days = 10957;
+    const CivilDate date = civilDateFromDays(days);
+    CHECK_EQ(date.year, 2000LL);
+    CHECK_EQ(static_cast<int>(weekdayFromDays(days)), 6);
+
+    long long civilYear;
+    month_t civilMonth;
+    day_t civilDay;
+    civilFromDays(days, civilYear, civilMonth, civilDay);
+    CHECK(civilYear == date.year && civilMonth == date.month && civilDay == date.day);
+
+    volatile long long unixTime = 1700000000;
+    constexpr CivilTime atCompileTime = decompose(1700000000, 5.5);
+    const CivilTime atRunTime = decompose(unixTime, 5.5);
+    CHECK(atCompileTime.year == atRunTime.year && atCompileTime.month == atRunTime.month && atCompileTime.day == atRunTime.day);
+    CHECK(atCompileTime.hour == atRunTime.hour && atCompileTime.minute == atRunTime.minute && atCompileTime.dotw == atRunTime.dotw);
+
+    return checks::exitCode();
+}
@@ -0,0 +1,91 @@
+/*
+ * epoch_bases: NTP, GPS, FILETIME, Excel and Julian Day conversions against known dates,
+ * round trips, and the batch forms against the single ones.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+namespace {
+    using namespace beliumgl;
+}
+
+int main() {
+    // NTP: the 1900 epoch, and the era that starts in 2036.
+    CHECK_EQ(ntpToUnix(static_cast<unsigned long long>(ntpEpochOffset) << 32), 0LL);
+    CHECK_EQ(ntpToUnix(0xFFFFFFFFULL << 32), 4294967295LL - ntpEpochOffset);
+    CHECK_EQ(ntpToUnix(0ULL), 4294967296LL - ntpEpochOffset); // 07.02.2036 06:28:16
+    CHECK_EQ(ntpToUnix(unixToNtp(1700000000LL) | 0xFFFFFFFFULL), 1700000000LL);
+    CHECK_EQ(ntpToUnix(unixToNtp(2100000000LL)), 2100000000LL);
+
+    // GPS: 06.01.1980, and week 2000 (06.05.2018).
+    CHECK_EQ(gpsToUnix(0LL), 315964800LL);
+    CHECK_EQ(gpsToUnix(2000LL, 0LL), 1525564800LL);
+    CHECK_EQ(gpsToUnix(2000LL, 86400LL), 1525651200LL);
+    CHECK_EQ(unixToGps(gpsToUnix(1234567890LL)), 1234567890LL);
+
+    // FILETIME: whole seconds are floored, the rest goes to `nanoseconds`.
+    long long nanoseconds = -1;
+    CHECK_EQ(fileTimeToUnix(116444736000000000LL, &nanoseconds), 0LL);
+    CHECK_EQ(nanoseconds, 0LL);
+    CHECK_EQ(fileTimeToUnix(116444736000000000LL - 1, &nanoseconds), -1LL);
+    CHECK_EQ(nanoseconds, 999999900LL);
+    CHECK_EQ(fileTimeToUnix(0LL), -fileTimeEpochOffset);
+    CHECK_EQ(unixToFileTime(-1LL, 999999900LL), 116444736000000000LL - 1);
+    CHECK_EQ(fileTimeToUnix(unixToFileTime(1700000000LL, 123456700LL), &nanoseconds), 1700000000LL);
+    CHECK_EQ(nanoseconds, 123456700LL);
+
+    // Excel: serial 1 is 01.01.1900, and both 60 (the nonexistent 29.02.1900) and 61 are 01.03.1900.
+    CHECK_EQ(excelToUnix(25569.0), 0LL);
+    CHECK_EQ(excelToUnix(25569.5), 43200LL);
+    CHECK_EQ(excelToUnix(25568.75), -21600LL);
+    CHECK_EQ(excelToUnix(1.0), -2208988800LL);
+    CHECK_EQ(excelToUnix(60.0), -2203891200LL);
+    CHECK_EQ(excelToUnix(61.0), -2203891200LL);
+    CHECK_EQ(excelToUnix(45244.0 + 22.0 / 24.0), 1699999200LL);
+    CHECK_EQ(unixToExcel(0LL), 25569.0);
+    CHECK_EQ(unixToExcel(-2208988800LL), 1.0);
+    CHECK_EQ(unixToExcel(-21600LL), 25568.75);
+    for (long long t = -2203891200LL; t < 4000000000LL; t += 86400LL * 37 + 3600)
+        CHECK_EQ(excelToUnix(unixToExcel(t)), t);
+
+    // Julian Day and Modified Julian Day: J2000.0 is 01.01.2000 12:00:00.
+    CHECK_EQ(julianDayToUnix(julianDayEpoch), 0LL);
+    CHECK_EQ(julianDayToUnix(2451545.0), 946728000LL);
+    CHECK_EQ(modifiedJulianDayToUnix(51544.0), 946684800LL);
+    CHECK_EQ(modifiedJulianDayToUnix(40587.0), 0LL);
+    CHECK_EQ(unixToJulianDay(946728000LL), 2451545.0);
+    CHECK_EQ(julianDayToUnix(unixToJulianDay(-1234567890LL)), -1234567890LL);
+
+    // The batch forms give the same results as the single ones.
+    const unsigned long long ntp[] = {unixToNtp(0LL), unixToNtp(1700000000LL), 0ULL};
+    const long long gps[] = {0LL, 1000000000LL, -315964800LL};
+    const long long ticks[] = {0LL, 116444736000000000LL - 1, 133444736001234567LL};
+    const double serials[] = {1.0, 60.0, 45244.25};
+    const double julianDays[] = {2451545.0, julianDayEpoch, 0.0};
+    long long out[3];
+
+    ntpToUnix(ntp, 3, out);
+    for (size_t i = 0; i < 3; ++i)
+        CHECK_EQ(out[i], ntpToUnix(ntp[i]));
+    gpsToUnix(gps, 3, out);
+    for (size_t i = 0; i < 3; ++i)
+        CHECK_EQ(out[i], gpsToUnix(gps[i]));
+    fileTimeToUnix(ticks, 3, out);
+    for (size_t i = 0; i < 3; ++i)
+        CHECK_EQ(out[i], fileTimeToUnix(ticks[i]));
+    excelToUnix(serials, 3, out);
+    for (size_t i = 0; i < 3; ++i)
+        CHECK_EQ(out[i], excelToUnix(serials[i]));
+    julianDayToUnix(julianDays, 3, out);
+    for (size_t i = 0; i < 3; ++i)
+        CHECK_EQ(out[i], julianDayToUnix(julianDays[i]));
+
+    // DateTime from an integer timestamp, without going through a string.
+    const DateTime date(gpsToUnix(2000LL, 0LL), 2.0);
+    CHECK_EQ(date.unixTime(), 1525564800LL);
+    CHECK_EQ(date.toUnix(), "1525564800");
+    CHECK_EQ(date.toString(DateTimeFormat(std::string("DD.MM.YYYY HH:II:SS"))), "06.05.2018 02:00:00 ");
+
+    return checks::exitCode();
+}
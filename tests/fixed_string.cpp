@@ -0,0 +1,77 @@
+/*
+ * fixed_string: FormattedDateTime against toString, the longest possible output fitting without truncation,
+ * truncation into smaller FixedStrings, and the string-like accessors.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+    using namespace beliumgl;
+
+    const char* const patterns[] = {
+        "W, DD/MM/YY, HH:II:SS O UTC",
+        "WW, AA DD YY HH:II:SS _ O",
+        "YY-MM-DD HH:II:SS",
+        "D.M.Y H:I:S _ O"
+    };
+}
+
+int main() {
+    // The same text as toString, for every pattern and across offsets and eras.
+    const DateTime dates[] = {
+        DateTime(0LL), DateTime(1700000000LL, 5.5), DateTime(-30000000000LL, -3.0),
+        DateTime(951782400LL, -12.75), DateTime(maxDateTimeUnix), DateTime(minDateTimeUnix)
+    };
+    for (const char* pattern : patterns) {
+        const DateTimeFormat format{std::string(pattern)};
+        for (const DateTime& date : dates) {
+            const FormattedDateTime fixed = date.toFixedString(format);
+            CHECK_EQ(fixed.str(), date.toString(format));
+            CHECK_EQ(std::strlen(fixed.c_str()), fixed.size());
+            CHECK(!fixed.truncated());
+        }
+    }
+
+    // The longest day and month names, the longest year, 12-hour time and an offset of almost 10^6 hours.
+    CivilTime longest;
+    longest.year = -32768;
+    longest.month = 8;   // September
+    longest.day = 26;
+    longest.dotw = 3;    // Wednesday
+    longest.hour = 12;
+    longest.timezoneOffset = -999999.75;
+    const DateTimeFormat longestFormat{std::string("WW, AA DD YY HH:II:SS _ O UTC")};
+    char buffer[256];
+    const size_t length = formatTo(buffer, sizeof(buffer), longest, longestFormat);
+    const FormattedDateTime fixed = FormattedDateTime::format(longest, longestFormat);
+    CHECK(length <= maxFormattedLength);
+    CHECK(!fixed.truncated());
+    CHECK_EQ(fixed.str(), std::string(buffer, length));
+
+    // Smaller strings are cut and say so, and stay null-terminated.
+    const FixedString<8> cut = FixedString<8>::format(longest, longestFormat);
+    CHECK(cut.truncated());
+    CHECK_EQ(cut.size(), 8u);
+    CHECK_EQ(cut.str(), std::string(buffer, 8));
+    CHECK_EQ(cut.c_str()[8], '\0');
+    CHECK_EQ(FixedString<8>::capacity(), 8u);
+
+    // Construction from characters copies at most the capacity.
+    const FixedString<4> a("abcdef", 6), b("abcd", 4), c("abc", 3);
+    CHECK_EQ(a.str(), "abcd");
+    CHECK(a == b);
+    CHECK(b != c);
+    CHECK(!a.truncated());
+    CHECK_EQ(std::string(c.begin(), c.end()), "abc");
+    CHECK_EQ(c[2], 'c');
+    CHECK_EQ(static_cast<std::string>(c), "abc");
+    const FixedString<4> empty;
+    CHECK(empty.empty());
+    CHECK_EQ(empty.c_str(), std::string());
+
+    return checks::exitCode();
+}
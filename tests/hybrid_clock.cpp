@@ -0,0 +1,124 @@
+/*
+ * hybrid_clock: HybridLogicalClock on a physical clock the test controls - following the wall clock,
+ * never going backwards when it does, counter overflow, receiving timestamps from ahead and behind,
+ * the `maxOffset` limit - and unique, per-thread increasing timestamps when many threads share one clock.
+ */
+
+#include "../datepp_clock.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    std::atomic<long long> physicalMilliseconds{0};
+
+    long long physical() {
+        return physicalMilliseconds.load();
+    }
+
+    template<typename Exception, typename F>
+    bool throws(F call) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    // Packing: milliseconds in the upper 48 bits, the counter in the lower 16.
+    const HybridTimestamp packed(1700000000123LL, 5);
+    CHECK_EQ(packed.packed(), (1700000000123ULL << 16) | 5);
+    CHECK_EQ(packed.milliseconds(), 1700000000123LL);
+    CHECK_EQ(packed.counter(), 5u);
+    CHECK_EQ(packed.unixTime(), 1700000000LL);
+    CHECK_EQ(packed.toDateTime(1.0).unixTime(), 1700000000LL);
+    CHECK(HybridTimestamp(1700000000123LL, 4) < packed && packed < HybridTimestamp(1700000000124LL, 0));
+    CHECK(throws<std::invalid_argument>([]() { HybridTimestamp(-1, 0); }));
+    CHECK(throws<std::invalid_argument>([]() { HybridTimestamp(0, 65536); }));
+    CHECK(throws<std::invalid_argument>([]() { HybridTimestamp(HybridTimestamp::maxMilliseconds + 1, 0); }));
+
+    // Within one millisecond the counter counts; a new millisecond starts it over.
+    physicalMilliseconds = 1700000000000LL;
+    HybridLogicalClock clock(0, physical);
+    for (unsigned i = 0; i < 5; ++i) {
+        const HybridTimestamp time = clock.now();
+        CHECK_EQ(time.milliseconds(), 1700000000000LL);
+        CHECK_EQ(time.counter(), i);
+    }
+    physicalMilliseconds = 1700000000007LL;
+    CHECK(clock.now() == HybridTimestamp(1700000000007LL, 0));
+    CHECK(clock.last() == HybridTimestamp(1700000000007LL, 0));
+
+    // The wall clock going back doesn't move the clock back.
+    physicalMilliseconds = 1699999999000LL;
+    CHECK(clock.now() == HybridTimestamp(1700000000007LL, 1));
+
+    // More than 65536 events in a millisecond carry into the next one.
+    physicalMilliseconds = 1700000001000LL;
+    HybridTimestamp previous = clock.now();
+    for (int i = 0; i < 70000; ++i) {
+        const HybridTimestamp time = clock.now();
+        CHECK(previous < time);
+        previous = time;
+    }
+    CHECK(previous == HybridTimestamp(1700000001001LL, 70000 - 65536));
+    physicalMilliseconds = 1700000001005LL;
+    CHECK(clock.now() == HybridTimestamp(1700000001005LL, 0));
+
+    // Receiving: later than the message and than everything before it here.
+    const HybridTimestamp ahead(1700000005000LL, 3);
+    CHECK(clock.receive(ahead) == HybridTimestamp(1700000005000LL, 4));
+    CHECK(clock.now() == HybridTimestamp(1700000005000LL, 5));
+    CHECK(clock.receive(HybridTimestamp(1600000000000LL, 9)) == HybridTimestamp(1700000005000LL, 6));
+    physicalMilliseconds = 1700000010000LL;
+    CHECK(clock.receive(HybridTimestamp(1700000000000LL, 0)) == HybridTimestamp(1700000010000LL, 0));
+
+    // With `maxOffset`, messages too far ahead of the wall clock are rejected and change nothing.
+    HybridLogicalClock strict(1000, physical);
+    CHECK(strict.receive(HybridTimestamp(1700000011000LL, 0)) == HybridTimestamp(1700000011000LL, 1));
+    CHECK(throws<std::runtime_error>([&]() { strict.receive(HybridTimestamp(1700000011001LL, 0)); }));
+    CHECK(strict.last() == HybridTimestamp(1700000011000LL, 1));
+
+    // Physical times outside the 48 bits are clamped.
+    physicalMilliseconds = -5;
+    HybridLogicalClock early(0, physical);
+    CHECK(early.now() == HybridTimestamp(0, 1));
+
+    // One clock shared by many threads: every timestamp is unique and every thread's are increasing.
+    physicalMilliseconds = 1700000020000LL;
+    HybridLogicalClock shared(0, physical);
+    constexpr int threadCount = 4, perThread = 20000;
+    std::vector<std::vector<unsigned long long>> stamps(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < perThread; ++i) {
+                if (i % 1000 == 0 && t == 0)
+                    physicalMilliseconds += 1;
+                stamps[t].push_back(i % 3 == 0 ? shared.receive(HybridTimestamp(1700000020000LL, 0)).packed() : shared.now().packed());
+            }
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::vector<unsigned long long> all;
+    for (const std::vector<unsigned long long>& own : stamps) {
+        for (size_t i = 1; i < own.size(); ++i)
+            CHECK(own[i - 1] < own[i]);
+        all.insert(all.end(), own.begin(), own.end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    CHECK_EQ(shared.last().packed(), all.back());
+
+    return checks::exitCode();
+}
@@ -0,0 +1,220 @@
+/*
+ * ids: UUIDv7 layout (version, variant, milliseconds), strictly increasing ids on a clock the test controls -
+ * including the counter running out and the clock going back - their text form, uniqueness across
+ * generators and threads, and the decoders; Snowflake layouts (Twitter, Discord, custom ones filling 64 bits)
+ * round trips, invalid layouts and workers, the generator's sequence running out, and its decoders.
+ */
+
+#include "../datepp_ids.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    long long physicalMilliseconds = 0;
+
+    long long physical() {
+        return physicalMilliseconds;
+    }
+
+    bool sameCivil(const CivilTime& a, const CivilTime& b) {
+        return a.year == b.year && a.month == b.month && a.day == b.day && a.hour == b.hour && a.minute == b.minute
+            && a.second == b.second && a.dotw == b.dotw && a.timezoneOffset == b.timezoneOffset;
+    }
+
+    template<typename Exception, typename F>
+    bool throws(F call) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    // Layout: 48 bits of milliseconds, version 7, the counter, then variant 10 and random bits.
+    physicalMilliseconds = 1700000000123LL;
+    UUIDv7Generator generator(physical);
+    const UUID first = generator.next();
+    CHECK_EQ(first.version(), 7);
+    CHECK_EQ(first.low >> 62, 2ULL);
+    CHECK_EQ(first.milliseconds(), 1700000000123LL);
+    CHECK_EQ(first.unixTime(), 1700000000LL);
+    CHECK_EQ(first.toDateTime(2.0).unixTime(), 1700000000LL);
+    CHECK((first.high & 0xFFF) < 0x800); // The counter starts below 2048
+
+    // In one millisecond the ids increase; when the counter runs out, the timestamp moves ahead.
+    UUID previous = first;
+    for (int i = 0; i < 5000; ++i) {
+        const UUID id = generator.next();
+        CHECK(previous < id);
+        CHECK_EQ(id.version(), 7);
+        previous = id;
+    }
+    CHECK_EQ(previous.milliseconds(), 1700000000124LL);
+
+    // The clock going back doesn't make the ids go back.
+    physicalMilliseconds = 1600000000000LL;
+    const UUID behind = generator.next();
+    CHECK(previous < behind);
+    CHECK_EQ(behind.milliseconds(), 1700000000124LL);
+    physicalMilliseconds = 1700000000200LL;
+    CHECK_EQ(generator.next().milliseconds(), 1700000000200LL);
+
+    // Text: 36 lowercase characters, read back in either case; like snprintf for short buffers.
+    const UUID known(0x01890a5dac96774bULL, 0xbcceb302099a8057ULL);
+    char text[37];
+    CHECK_EQ(writeUUID(text, sizeof(text), known), 36u);
+    CHECK_EQ(std::string(text), std::string("01890a5d-ac96-774b-bcce-b302099a8057"));
+    char shortText[9];
+    CHECK_EQ(writeUUID(shortText, sizeof(shortText), known), 36u);
+    CHECK_EQ(std::string(shortText), std::string("01890a5d"));
+    UUID parsed;
+    CHECK(parseUUID("01890A5D-AC96-774B-BCCE-B302099A8057", 36, parsed) && parsed == known);
+    CHECK(!parseUUID("01890a5d-ac96-774b-bcce-b302099a805", 35, parsed));
+    CHECK(!parseUUID("01890a5d_ac96-774b-bcce-b302099a8057", 36, parsed));
+    CHECK(!parseUUID("01890a5d-ac96-774b-bcce-b302099a805g", 36, parsed));
+    for (int i = 0; i < 100; ++i) {
+        const UUID id = generator.next();
+        writeUUID(text, sizeof(text), id);
+        CHECK(parseUUID(text, std::strlen(text), parsed) && parsed == id);
+    }
+
+    // Batches are increasing, from one read of the clock, and continue from the ids before them.
+    std::vector<UUID> batch(10000);
+    generator.next(batch.data(), batch.size());
+    CHECK(previous < batch[0]);
+    for (size_t i = 1; i < batch.size(); ++i)
+        CHECK(batch[i - 1] < batch[i]);
+    CHECK(generator.next() > batch.back());
+
+    // Generators made together and in different threads don't make the same ids.
+    UUIDv7Generator other(physical);
+    CHECK(other.next().low != generator.next().low);
+    constexpr int threadCount = 4, perThread = 20000;
+    std::vector<std::vector<UUID>> made(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            UUIDv7Generator& local = UUIDv7Generator::local();
+            for (int i = 0; i < perThread; ++i)
+                made[t].push_back(local.next());
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    std::vector<UUID> all;
+    for (const std::vector<UUID>& own : made) {
+        for (size_t i = 1; i < own.size(); ++i)
+            CHECK(own[i - 1] < own[i]);
+        all.insert(all.end(), own.begin(), own.end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+    // Decoders against decomposing each timestamp, over more than one block and across day ends.
+    std::vector<UUID> spread;
+    for (long long milliseconds = 1699999000000LL; milliseconds < 1700000000000LL + 3 * 86400000LL; milliseconds += 777777)
+        spread.push_back(UUID(static_cast<unsigned long long>(milliseconds) << 16 | 0x7000, 0x8000000000000000ULL));
+    const size_t count = spread.size();
+    CHECK(count > 256);
+    std::vector<long long> unixTimes(count);
+    std::vector<CivilTime> inOffset(count), inZone(count);
+    const TimeZone zone = TimeZone::fixed(-3.5);
+    unixTimesOfUUIDv7(spread.data(), count, unixTimes.data());
+    decomposeUUIDv7(spread.data(), count, inOffset.data(), 5.75);
+    decomposeUUIDv7(spread.data(), count, inZone.data(), zone);
+    for (size_t i = 0; i < count; ++i) {
+        CHECK_EQ(unixTimes[i], spread[i].milliseconds() / 1000);
+        CHECK(sameCivil(inOffset[i], decompose(unixTimes[i], 5.75)));
+        CHECK(sameCivil(inZone[i], zone.decompose(unixTimes[i])));
+    }
+
+    // Snowflake layouts: the fields come back out, and the timestamps count from the epoch.
+    const SnowflakeLayout twitter = SnowflakeLayout::twitter(), discord = SnowflakeLayout::discord();
+    const unsigned long long tweet = twitter.make(1ULL << 40, 1023, 4095);
+    CHECK_EQ(twitter.ticks(tweet), 1ULL << 40);
+    CHECK_EQ(twitter.worker(tweet), 1023ULL);
+    CHECK_EQ(twitter.sequence(tweet), 4095ULL);
+    CHECK_EQ(twitter.milliseconds(twitter.make(0, 0, 0)), 1288834974657LL);
+    CHECK_EQ(twitter.unixTime(twitter.make(0, 0, 0)), 1288834974LL);
+    // A known Discord id: 175928847299117063 was made at 1462015105796.
+    CHECK_EQ(discord.milliseconds(175928847299117063ULL), 1462015105796LL);
+    CHECK_EQ(discord.toDateTime(175928847299117063ULL).unixTime(), 1462015105LL);
+
+    const SnowflakeLayout wide(-86400000LL, 40, 0, 24, 1000); // Seconds since 31.12.1969, all 64 bits
+    const unsigned long long wideId = wide.make(wide.maxTicks(), 0, wide.maxSequence());
+    CHECK_EQ(wideId, ~0ULL);
+    CHECK_EQ(wide.ticks(wideId), wide.maxTicks());
+    CHECK_EQ(wide.sequence(wideId), wide.maxSequence());
+    CHECK_EQ(wide.unixTime(wide.make(0, 0, 0)), -86400LL);
+    CHECK_EQ(wide.unixTime(wide.make(86399, 0, 0)), -1LL);
+    CHECK(throws<std::invalid_argument>([]() { SnowflakeLayout(0, 41, 11, 13); }));
+    CHECK(throws<std::invalid_argument>([]() { SnowflakeLayout(0, 0, 10, 12); }));
+    CHECK(throws<std::invalid_argument>([]() { SnowflakeLayout(0, 41, -1, 12); }));
+    CHECK(throws<std::invalid_argument>([]() { SnowflakeLayout(0, 41, 10, 0); }));
+    CHECK(throws<std::invalid_argument>([]() { SnowflakeLayout(0, 41, 10, 12, 0); }));
+    CHECK(throws<std::invalid_argument>([&]() { SnowflakeGenerator(twitter, 1024, physical); }));
+
+    // The generator: sequences in a tick, borrowing the next tick when they run out, never going back.
+    physicalMilliseconds = 1700000000000LL;
+    const SnowflakeLayout small(1600000000000LL, 41, 4, 3, 10); // 8 ids per 10 milliseconds
+    SnowflakeGenerator snowflakes(small, 9, physical);
+    CHECK_EQ(snowflakes.getWorker(), 9ULL);
+    CHECK_EQ(snowflakes.getLayout().getSequenceBits(), 3);
+    std::vector<unsigned long long> ids;
+    for (int i = 0; i < 20; ++i)
+        ids.push_back(snowflakes.next());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        CHECK_EQ(small.ticks(ids[i]), 10000000000ULL + i / 8);
+        CHECK_EQ(small.sequence(ids[i]), static_cast<unsigned long long>(i % 8));
+        CHECK_EQ(small.worker(ids[i]), 9ULL);
+        if (i > 0)
+            CHECK(ids[i - 1] < ids[i]);
+    }
+    physicalMilliseconds = 1690000000000LL;
+    CHECK(snowflakes.next() > ids.back());
+    physicalMilliseconds = 1700000001000LL;
+    CHECK_EQ(snowflakes.next(), small.make(10000000100ULL, 9, 0));
+
+    std::vector<unsigned long long> snowflakeBatch(100);
+    snowflakes.next(snowflakeBatch.data(), snowflakeBatch.size());
+    CHECK_EQ(snowflakeBatch[0], small.make(10000000100ULL, 9, 1));
+    for (size_t i = 1; i < snowflakeBatch.size(); ++i)
+        CHECK(snowflakeBatch[i - 1] < snowflakeBatch[i]);
+
+    // Before the epoch and past the last tick, the generator throws.
+    physicalMilliseconds = 1599999999999LL;
+    CHECK(throws<std::runtime_error>([&]() { snowflakes.next(); }));
+    const SnowflakeLayout tiny(0, 2, 0, 1);
+    SnowflakeGenerator full(tiny, 0, physical);
+    physicalMilliseconds = 3;
+    full.next();
+    full.next();
+    CHECK(throws<std::runtime_error>([&]() { full.next(); }));
+
+    // Snowflake decoders against decomposing each timestamp.
+    std::vector<unsigned long long> flakes;
+    for (unsigned long long ticks = 0; ticks < 600; ++ticks)
+        flakes.push_back(discord.make(ticks * 987654321ULL, ticks % 1024, ticks % 4096));
+    std::vector<long long> flakeTimes(flakes.size());
+    std::vector<CivilTime> flakeOffset(flakes.size()), flakeZone(flakes.size());
+    discord.unixTimes(flakes.data(), flakes.size(), flakeTimes.data());
+    discord.decompose(flakes.data(), flakes.size(), flakeOffset.data(), -9.5);
+    discord.decompose(flakes.data(), flakes.size(), flakeZone.data(), zone);
+    for (size_t i = 0; i < flakes.size(); ++i) {
+        CHECK_EQ(flakeTimes[i], discord.unixTime(flakes[i]));
+        CHECK(sameCivil(flakeOffset[i], decompose(flakeTimes[i], -9.5)));
+        CHECK(sameCivil(flakeZone[i], zone.decompose(flakeTimes[i])));
+    }
+
+    return checks::exitCode();
+}
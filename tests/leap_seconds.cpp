@@ -0,0 +1,115 @@
+/*
+ * leap_seconds: UTC <-> TAI <-> GPS round trips with the built-in LeapSecondTable, the leap second
+ * at the end of 2016, the batch forms, and tables built from entries and from a leap-seconds.list file.
+ */
+
+#include "../datepp_leapseconds.hpp"
+#include "check.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    bool throwsInvalidArgument(std::vector<LeapSecondTable::Entry> entries) {
+        try {
+            LeapSecondTable table(std::move(entries));
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    const LeapSecondTable& table = LeapSecondTable::builtin();
+    CHECK_EQ(table.getEntries().size(), 28u);
+
+    // Before 1972 the first offset is used; the 2017 offset stays in effect.
+    CHECK_EQ(table.offsetAt(0LL), 10);
+    CHECK_EQ(table.offsetAt(63072000LL), 10);
+    CHECK_EQ(table.offsetAt(78796799LL), 10);
+    CHECK_EQ(table.offsetAt(78796800LL), 11);
+    CHECK_EQ(table.offsetAt(1483228799LL), 36);
+    CHECK_EQ(table.offsetAt(1483228800LL), 37);
+    CHECK_EQ(table.offsetAt(1700000000LL), 37);
+
+    // 31.12.2016 23:59:60 exists in TAI only, and maps to the start of the next day.
+    bool leapSecond = true;
+    CHECK_EQ(table.utcToTai(1483228799LL), 1483228835LL);
+    CHECK_EQ(table.taiToUtc(1483228835LL, &leapSecond), 1483228799LL);
+    CHECK(!leapSecond);
+    CHECK_EQ(table.taiToUtc(1483228836LL, &leapSecond), 1483228800LL);
+    CHECK(leapSecond);
+    CHECK_EQ(table.taiToUtc(1483228837LL, &leapSecond), 1483228800LL);
+    CHECK(!leapSecond);
+
+    // GPS time is 19 seconds behind TAI, so 18 seconds ahead of UTC since 2017.
+    CHECK_EQ(table.utcToGps(gpsEpochOffset), 0LL);
+    CHECK_EQ(table.utcToGps(1700000000LL), 1700000000LL + 18 - gpsEpochOffset);
+    CHECK_EQ(table.gpsToUtc(1700000000LL + 18 - gpsEpochOffset), 1700000000LL);
+
+    // Every second around every leap second survives both round trips, in any order of lookups.
+    for (const LeapSecondTable::Entry& entry : table.getEntries())
+        for (long long utc = entry.utc - 3; utc <= entry.utc + 3; ++utc) {
+            CHECK_EQ(table.taiToUtc(table.utcToTai(utc), &leapSecond), utc);
+            CHECK(!leapSecond);
+            CHECK_EQ(table.gpsToUtc(table.utcToGps(utc)), utc);
+        }
+    for (long long utc = 1700000000LL; utc > -100000000LL; utc -= 9999991LL)
+        CHECK_EQ(table.taiToUtc(table.utcToTai(utc)), utc);
+
+    // The batch forms give the same results as the single ones.
+    const long long utc[] = {1483228800LL, 0LL, 1483228799LL, 915148800LL, 78796799LL};
+    constexpr size_t count = sizeof(utc) / sizeof(utc[0]);
+    long long tai[count], gps[count], back[count];
+    table.utcToTai(utc, count, tai);
+    table.utcToGps(utc, count, gps);
+    for (size_t i = 0; i < count; ++i) {
+        CHECK_EQ(tai[i], table.utcToTai(utc[i]));
+        CHECK_EQ(gps[i], table.utcToGps(utc[i]));
+    }
+    table.taiToUtc(tai, count, back);
+    for (size_t i = 0; i < count; ++i)
+        CHECK_EQ(back[i], utc[i]);
+    table.gpsToUtc(gps, count, back);
+    for (size_t i = 0; i < count; ++i)
+        CHECK_EQ(back[i], utc[i]);
+
+    // Tables from entries must be sorted and not empty.
+    CHECK(throwsInvalidArgument({}));
+    CHECK(throwsInvalidArgument({{78796800LL, 11}, {63072000LL, 10}}));
+    LeapSecondTable custom({{63072000LL, 10}, {78796800LL, 11}});
+    CHECK_EQ(custom.utcToTai(1700000000LL), 1700000011LL);
+
+    // leap-seconds.list uses NTP timestamps; comments and blank lines are skipped.
+    const char* const path = "leap_seconds_test.list";
+    {
+        std::ofstream file(path);
+        file << "#\tUpdated through IERS Bulletin C\n"
+             << "#$\t 3676924800\n"
+             << "\n"
+             << "2272060800\t10\t# 1 Jan 1972\n"
+             << "2287785600\t11\t# 1 Jul 1972\n"
+             << "3692217600\t37\t# 1 Jan 2017\n";
+    }
+    LeapSecondTable fromFile = LeapSecondTable::fromFile(path);
+    CHECK_EQ(fromFile.getEntries().size(), 3u);
+    CHECK_EQ(fromFile.getEntries()[1].utc, 78796800LL);
+    CHECK_EQ(fromFile.offsetAt(78796800LL), 11);
+    CHECK_EQ(fromFile.utcToTai(1483228800LL), table.utcToTai(1483228800LL));
+    std::remove(path);
+
+    bool threw = false;
+    try {
+        LeapSecondTable::fromFile("no/such/leap-seconds.list");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    return checks::exitCode();
+}
@@ -0,0 +1,23 @@
+/*
+ * linkage: checks that datepp.hpp can be included from several translation units,
+ * both header-only and with DATEPP_SEPARATE_COMPILATION against libdatepp.
+ *
+ * Built twice by tests/CMakeLists.txt, together with linkage_other.cpp.
+ */
+
+#include "../datepp.hpp"
+
+#include <iostream>
+
+std::string formatInOtherUnit(long long _unix);
+
+int main() {
+    const beliumgl::DateTime dateTime(1700000000LL);
+    const std::string here = dateTime.toString(beliumgl::DateTimeFormat(std::string("DD.MM.YYYY HH:II:SS")));
+    const std::string there = formatInOtherUnit(1700000000LL);
+    if (here.compare(0, 19, "14.11.2023 22:13:20") != 0 || here != there) {
+        std::cerr << "linkage: got \"" << here << "\" and \"" << there << "\"\n";
+        return 1;
+    }
+    return 0;
+}
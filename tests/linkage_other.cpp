@@ -0,0 +1,7 @@
+// Second translation unit of the linkage test.
+
+#include "../datepp.hpp"
+
+std::string formatInOtherUnit(long long _unix) {
+    return beliumgl::DateTime(_unix).toString(beliumgl::DateTimeFormat(std::string("DD.MM.YYYY HH:II:SS")));
+}
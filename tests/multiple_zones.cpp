@@ -0,0 +1,94 @@
+/*
+ * multiple_zones: decomposeInOffsets and decomposeInZones against decomposing in each offset or zone on its own,
+ * around day, month and year ends; formatInOffsets and formatInZones against formatTo, including the
+ * positions in `ends` and buffers too small for the result.
+ */
+
+#include "../datepp_zones.hpp"
+#include "check.hpp"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    bool sameCivil(const CivilTime& a, const CivilTime& b) {
+        return a.year == b.year && a.month == b.month && a.day == b.day && a.hour == b.hour && a.minute == b.minute
+            && a.second == b.second && a.dotw == b.dotw && a.timezoneOffset == b.timezoneOffset;
+    }
+
+    std::string formatted(const CivilTime& time, const DateTimeFormat& format) {
+        char buffer[128];
+        return std::string(buffer, formatTo(buffer, sizeof(buffer), time, format));
+    }
+}
+
+int main() {
+    const timezone_offset_t offsets[] = {0.0, 1.0, -1.0, 5.5, -3.5, 5.75, 12.75, 14.0, -12.0, -9.5, 23.5, -23.5};
+    constexpr size_t offsetCount = sizeof(offsets) / sizeof(offsets[0]);
+
+    // Instants near the ends of days, months (28, 29, 30 and 31 days) and years, before and after 1970.
+    std::vector<long long> instants;
+    const long long days[] = {
+        daysFromCivil(2023, 11, 30), daysFromCivil(2024, 1, 28), daysFromCivil(2023, 1, 27), daysFromCivil(2024, 3, 29),
+        daysFromCivil(1969, 11, 30), daysFromCivil(1600, 1, 28), daysFromCivil(-1, 0, 0), 0
+    };
+    for (long long day : days)
+        for (long long seconds = -2 * 86400; seconds <= 2 * 86400; seconds += 1789)
+            instants.push_back(day * 86400 + seconds);
+
+    const DateTimeFormat format{std::string("WW, DD.MM.YYYY HH:II:SS O")};
+    for (long long instant : instants) {
+        CivilTime out[offsetCount];
+        decomposeInOffsets(instant, offsets, offsetCount, out);
+        for (size_t i = 0; i < offsetCount; ++i)
+            CHECK(sameCivil(out[i], decompose(instant, offsets[i])));
+
+        char buffer[2048];
+        size_t ends[offsetCount];
+        const size_t length = formatInOffsets(buffer, sizeof(buffer), instant, offsets, offsetCount, format, ends);
+        std::string expected;
+        for (size_t i = 0; i < offsetCount; ++i) {
+            expected += (i > 0 ? "\n" : "") + formatted(decompose(instant, offsets[i]), format);
+            CHECK_EQ(ends[i], expected.size());
+        }
+        CHECK_EQ(std::string(buffer, length), expected);
+    }
+
+    // Like formatTo, a short buffer gets the start of the result and the full length is returned.
+    char small[20];
+    size_t ends[offsetCount];
+    const size_t fullLength = formatInOffsets(nullptr, 0, 1700000000LL, offsets, offsetCount, format, nullptr, '\0');
+    CHECK_EQ(formatInOffsets(small, sizeof(small), 1700000000LL, offsets, offsetCount, format, ends, '\0'), fullLength);
+    CHECK_EQ(ends[offsetCount - 1], fullLength);
+    CHECK_EQ(std::string(small), formatted(decompose(1700000000LL, 0.0), format).substr(0, sizeof(small) - 1));
+
+    // Zones: one with transitions on both sides of the instants, and fixed ones.
+    const TimeZone custom("Custom", {
+        {std::numeric_limits<long long>::min(), 3600}, {daysFromCivil(2024, 1, 28) * 86400 + 3600, 7200},
+        {daysFromCivil(2024, 3, 29) * 86400, -34200}
+    });
+    const TimeZone halfHour = TimeZone::fixed(5.5), west = TimeZone::fixed(-11.0), utc;
+    const TimeZone* const zones[] = {&custom, &halfHour, &west, &utc};
+    constexpr size_t zoneCount = sizeof(zones) / sizeof(zones[0]);
+    for (long long instant : instants) {
+        CivilTime out[zoneCount];
+        decomposeInZones(instant, zones, zoneCount, out);
+        for (size_t i = 0; i < zoneCount; ++i)
+            CHECK(sameCivil(out[i], zones[i]->decompose(instant)));
+
+        char buffer[1024];
+        size_t zoneEnds[zoneCount];
+        const size_t length = formatInZones(buffer, sizeof(buffer), instant, zones, zoneCount, format, zoneEnds, '|');
+        std::string expected;
+        for (size_t i = 0; i < zoneCount; ++i) {
+            expected += (i > 0 ? "|" : "") + formatted(zones[i]->decompose(instant), format);
+            CHECK_EQ(zoneEnds[i], expected.size());
+        }
+        CHECK_EQ(std::string(buffer, length), expected);
+    }
+
+    return checks::exitCode();
+}
@@ -0,0 +1,146 @@
+/*
+ * ranges: DateTimeRange steps against decompose, month and year steps clamping the day,
+ * chunks, random access, step lengths, and ranges or steps that can't be represented.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    bool sameCivil(const CivilTime& a, const CivilTime& b) {
+        return a.year == b.year && a.month == b.month && a.day == b.day && a.hour == b.hour
+            && a.minute == b.minute && a.second == b.second && a.dotw == b.dotw;
+    }
+
+    // Every point of a fixed step range is `begin + index * step` and matches decompose.
+    void checkFixed(long long begin, long long end, RangeStep step, timezone_offset_t offset) {
+        long long expected = 0;
+        for (const RangePoint& point : DateTimeRange(begin, end, step, offset)) {
+            CHECK_EQ(point.index, expected);
+            CHECK_EQ(point.unixTime, begin + expected * step.lengthInSeconds());
+            CHECK(sameCivil(point.civil, decompose(point.unixTime, offset)));
+            ++expected;
+        }
+        CHECK_EQ(expected, DateTimeRange(begin, end, step, offset).size());
+        CHECK(begin + expected * step.lengthInSeconds() >= end);
+    }
+
+    template<typename Exception>
+    bool throwsOnRange(long long begin, long long end, RangeStep step) {
+        try {
+            DateTimeRange range(begin, end, step);
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+
+    long long unixOf(long long year, month_t month, day_t day) {
+        return daysFromCivil(year, month, day) * 86400;
+    }
+}
+
+int main() {
+    // Fixed steps, across leap days, year ends and negative timestamps.
+    checkFixed(1700000000LL, 1700000000LL + 400 * 86400LL, RangeStep::days(1), 5.5);
+    checkFixed(-2208988800LL, -2208988800LL + 3 * 31536000LL, RangeStep::seconds(7777), -3.0);
+    checkFixed(946684799LL, 946684799LL + 86400LL * 800, RangeStep::hours(13), 0.0);
+    checkFixed(-1LL, 86400LL * 365 * 9, RangeStep::weeks(3), 14.0);
+    checkFixed(0LL, 86400LL * 365 * 500, RangeStep::days(367), 1.0);
+    checkFixed(1700000000LL, 1700000000LL + 7200, RangeStep::minutes(1), 0.0);
+
+    // Month steps keep the day of the first date where the month has it: 31.01, 29.02, 31.03, 30.04, ...
+    const long long january31 = unixOf(2024, 0, 30) + 3600;
+    std::vector<RangePoint> points;
+    for (const RangePoint& point : DateTimeRange(january31, unixOf(2025, 1, 0), RangeStep::months(1)))
+        points.push_back(point);
+    CHECK_EQ(points.size(), 13u);
+    const day_t lastDays[13] = {30, 28, 30, 29, 30, 29, 30, 30, 29, 30, 29, 30, 30};
+    for (size_t i = 0; i < points.size() && i < 13; ++i) {
+        CHECK_EQ(points[i].civil.month, static_cast<month_t>(i % 12));
+        CHECK_EQ(static_cast<int>(points[i].civil.day), static_cast<int>(lastDays[i]));
+        CHECK_EQ(points[i].civil.hour, 1);
+        CHECK(sameCivil(points[i].civil, decompose(points[i].unixTime)));
+    }
+
+    // Year steps from a leap day: 29.02 only in leap years.
+    const long long leapDay = unixOf(2024, 1, 28);
+    DateTimeRange years(leapDay, unixOf(2033, 0, 0), RangeStep::years(1));
+    CHECK_EQ(years.size(), 9);
+    CHECK_EQ(years.at(1).unixTime(), unixOf(2025, 1, 27));
+    CHECK_EQ(years.at(4).unixTime(), leapDay + (366 + 365 * 3) * 86400LL);
+    CHECK_EQ(static_cast<int>(years.at(4).civil().day), 28);
+    CHECK_EQ(years.at(-4).unixTime(), unixOf(2020, 1, 28));
+
+    // In another offset, the calendar steps follow the local date.
+    DateTime localBegin(unixOf(2024, 0, 30) - 3600, 2.0); // 31.01.2024 01:00 at +02:00
+    DateTimeRange local = DateTime::range(localBegin, DateTime(unixOf(2024, 3, 0), 2.0), RangeStep::months(1));
+    const DateTimeRange::iterator february = local.at(1);
+    CHECK_EQ(local.size(), 3);
+    CHECK_EQ(february.civil().month, 1);
+    CHECK_EQ(static_cast<int>(february.civil().day), 28);
+    CHECK_EQ(february.unixTime(), unixOf(2024, 1, 28) - 3600);
+    CHECK_EQ(local.begin()->toDateTime().unixTime(), localBegin.unixTime());
+
+    // Empty ranges.
+    CHECK(DateTimeRange(100, 100, RangeStep::seconds(1)).empty());
+    CHECK(DateTimeRange(100, 0, RangeStep::months(1)).empty());
+    CHECK_EQ(DateTimeRange(0, 1, RangeStep::years(5)).size(), 1);
+
+    // Chunks iterate exactly like the full range, whatever the number of chunks.
+    DateTimeRange full(1700000000LL, 1700000000LL + 86400LL * 1000, RangeStep::hours(7));
+    for (size_t chunks = 1; chunks <= 7; ++chunks) {
+        long long index = 0;
+        for (size_t c = 0; c < chunks; ++c)
+            for (const RangePoint& point : full.chunk(c, chunks)) {
+                CHECK_EQ(point.index, index);
+                CHECK(sameCivil(point.civil, full.at(index).civil()));
+                ++index;
+            }
+        CHECK_EQ(index, full.size());
+    }
+
+    // Steps and spans that can't be represented.
+    CHECK(throwsOnRange<std::invalid_argument>(0, 10, RangeStep::days(0)));
+    CHECK(throwsOnRange<std::invalid_argument>(0, 10, RangeStep::months(-1)));
+    CHECK(throwsOnRange<std::out_of_range>(0, 10, RangeStep::seconds(std::numeric_limits<long long>::max())));
+    CHECK(throwsOnRange<std::out_of_range>(0, 10, RangeStep::weeks(std::numeric_limits<long long>::max() / 2)));
+    CHECK(throwsOnRange<std::out_of_range>(0, 10, RangeStep::years(std::numeric_limits<long long>::max() / 6)));
+    CHECK(throwsOnRange<std::out_of_range>(std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max(), RangeStep::days(1)));
+    CHECK(throwsOnRange<std::out_of_range>(maxDateTimeUnix - 10, maxDateTimeUnix + 86400LL * 400, RangeStep::days(1)));
+    bool threw = false;
+    try {
+        full.at(std::numeric_limits<long long>::max() / 1000);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    // Step lengths: only the fixed steps have one.
+    long long length = -1;
+    CHECK_EQ(RangeStep::weeks(2).lengthInSeconds(), 1209600LL);
+    CHECK(lengthInSecondsChecked(RangeStep::minutes(3), length) == Status::Ok && length == 180);
+    CHECK(lengthInSecondsChecked(RangeStep::months(1), length) == Status::InvalidArgument);
+    CHECK(lengthInSecondsChecked(RangeStep::years(1), length) == Status::InvalidArgument);
+    CHECK(lengthInSecondsChecked(RangeStep::hours(std::numeric_limits<long long>::max()), length) == Status::Overflow);
+    CHECK_EQ(length, 180LL);
+
+    // One step at a time, like the ranges.
+    long long out = 0;
+    CHECK(advanceChecked(january31, RangeStep::months(1), out) == Status::Ok && out == unixOf(2024, 1, 28) + 3600);
+    CHECK(advanceChecked(january31, RangeStep::months(-2), out) == Status::Ok && out == unixOf(2023, 10, 29) + 3600);
+    CHECK(advanceChecked(january31, RangeStep::days(-1), out) == Status::Ok && out == january31 - 86400);
+    CHECK(advanceChecked(std::numeric_limits<long long>::max() - 10, RangeStep::seconds(11), out) == Status::Overflow);
+    CHECK(advanceChecked(0, RangeStep::years(std::numeric_limits<long long>::max() / 2), out) == Status::Overflow);
+    DateTime moved(0LL);
+    CHECK(DateTime(january31).advanceChecked(RangeStep::years(1), moved) == Status::Ok);
+    CHECK_EQ(moved.unixTime(), unixOf(2025, 0, 30) + 3600);
+
+    return checks::exitCode();
+}
@@ -0,0 +1,112 @@
+/*
+ * serialization: RFC 3339, epoch number, JSON and protobuf Timestamp writers and parsers;
+ * round trips, the exact text, and inputs that would overflow.
+ */
+
+#include "../datepp.hpp"
+#include "check.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace {
+    using namespace beliumgl;
+
+    std::string rfc3339(long long seconds, int nanoseconds = 0, timezone_offset_t offset = 0.0) {
+        char buffer[64];
+        size_t length = writeRFC3339(buffer, sizeof(buffer), seconds, nanoseconds, offset);
+        return length == 0 ? std::string() : std::string(buffer, length);
+    }
+
+    bool parsesRFC3339(const std::string& text, long long& seconds, int& nanoseconds) {
+        return parseRFC3339(text.c_str(), text.size(), seconds, nanoseconds);
+    }
+
+    bool parsesJSON(const std::string& text) {
+        long long seconds;
+        int nanoseconds;
+        return parseJSONTimestamp(text.c_str(), text.size(), seconds, nanoseconds);
+    }
+}
+
+int main() {
+    long long seconds = 0;
+    int nanoseconds = 0;
+
+    CHECK_EQ(rfc3339(0), "1970-01-01T00:00:00Z");
+    CHECK_EQ(rfc3339(1700000000, 250000000, 1.0), "2023-11-14T23:13:20.250+01:00");
+    CHECK_EQ(rfc3339(-2, 500000000), "1969-12-31T23:59:58.500Z");
+    CHECK_EQ(rfc3339(-62167219200 - 86400), "-0001-12-31T00:00:00Z");
+    CHECK_EQ(rfc3339(253402300800), "+10000-01-01T00:00:00Z");
+    CHECK_EQ(rfc3339(0, 1), "1970-01-01T00:00:00.000000001Z");
+    CHECK_EQ(rfc3339(0, 0, -3.5), "1969-12-31T20:30:00-03:30");
+    CHECK_EQ(rfc3339(0, 0, 99.99), "1970-01-05T03:59:00+99:59");
+
+    // Offsets that don't fit "+HH:MM", invalid fractions and instants that can't be shifted by the offset.
+    CHECK_EQ(rfc3339(0, 0, 100.0), "");
+    CHECK_EQ(rfc3339(0, 0, -150.0), "");
+    CHECK_EQ(rfc3339(0, 0, std::nan("")), "");
+    CHECK_EQ(rfc3339(0, 1000000000), "");
+    CHECK_EQ(rfc3339(std::numeric_limits<long long>::max(), 0, 1.0), "");
+    CHECK_EQ(rfc3339(std::numeric_limits<long long>::min(), 0, -1.0), "");
+
+    // Round trips, with every kind of fraction and offset.
+    const timezone_offset_t offsets[] = {0.0, 1.0, -3.5, 5.75, 14.0, -12.0};
+    const int fractions[] = {0, 1, 500000000, 123456000, 999999999};
+    for (long long t = -70000000000LL; t < 300000000000LL; t += 987654321LL)
+        for (timezone_offset_t offset : offsets)
+            for (int fraction : fractions) {
+                std::string text = rfc3339(t, fraction, offset);
+                CHECK(parsesRFC3339(text, seconds, nanoseconds));
+                CHECK_EQ(seconds, t);
+                CHECK_EQ(nanoseconds, fraction);
+            }
+
+    CHECK(parsesRFC3339("2024-03-10t12:00:00.5z", seconds, nanoseconds) && seconds == 1710072000 && nanoseconds == 500000000);
+    CHECK(parsesRFC3339("2016-12-31T23:59:60Z", seconds, nanoseconds) && seconds == 1483228800);
+    CHECK(!parsesRFC3339("2023-02-29T00:00:00Z", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("2023-01-01T00:00:00", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("2023-01-01T00:00:00+24:00", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("+123-01-01T00:00:00Z", seconds, nanoseconds));
+
+    // Expanded years are bounded, so the result can't overflow.
+    CHECK(parsesRFC3339("+1000000000-12-31T23:59:59Z", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("+1000000001-01-01T00:00:00Z", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("+999999999999-12-31T23:59:59Z", seconds, nanoseconds));
+    CHECK(!parsesRFC3339("-999999999999-01-01T00:00:00Z", seconds, nanoseconds));
+    CHECK(!parsesJSON("\"+999999999999-12-31T23:59:59Z\""));
+
+    // Epoch numbers and JSON values.
+    char buffer[64];
+    CHECK_EQ(std::string(buffer, writeEpochNumber(buffer, sizeof(buffer), -2, 500000000)), "-1.500");
+    CHECK_EQ(std::string(buffer, writeEpochNumber(buffer, sizeof(buffer), 1700000000, 123456789)), "1700000000.123456789");
+    CHECK(parseEpochNumber("-1.5", 4, seconds, nanoseconds) && seconds == -2 && nanoseconds == 500000000);
+    CHECK_EQ(std::string(buffer, writeJSONString(buffer, sizeof(buffer), 0, 0, 2.0)), "\"1970-01-01T02:00:00+02:00\"");
+    CHECK_EQ(writeJSONString(buffer, sizeof(buffer), 0, 0, 100.0), 0u);
+    CHECK(parsesJSON(" \"1970-01-01T00:00:00Z\" "));
+    CHECK(parsesJSON("1700000000.25"));
+    CHECK(!parsesJSON("\"1970-01-01\""));
+
+    // Writers report the full length even if the buffer is too small, and still null-terminate.
+    CHECK_EQ(writeRFC3339(buffer, 5, 0), std::strlen("1970-01-01T00:00:00Z"));
+    CHECK_EQ(std::string(buffer), "1970");
+
+    // Protobuf Timestamp messages.
+    unsigned char message[32];
+    const long long messageSeconds[] = {0, 1, -1, 1700000000, -62135596800LL, 253402300799LL};
+    for (long long t : messageSeconds)
+        for (int fraction : fractions) {
+            size_t length = writeTimestampMessage(message, sizeof(message), t, fraction);
+            CHECK(length <= sizeof(message)); // The all-zero message is empty
+            CHECK(parseTimestampMessage(message, length, seconds, nanoseconds));
+            CHECK_EQ(seconds, t);
+            CHECK_EQ(nanoseconds, fraction);
+        }
+    CHECK_EQ(writeTimestampMessage(message, sizeof(message), 0, 0), 0u);
+    CHECK(parseTimestampMessage(message, 0, seconds, nanoseconds) && seconds == 0 && nanoseconds == 0);
+    CHECK_EQ(writeTimestampMessage(message, sizeof(message), 0, -1), 0u);
+
+    return checks::exitCode();
+}
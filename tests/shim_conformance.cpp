@@ -0,0 +1,305 @@
+/*
+ * shim_conformance: compares the LD_PRELOAD shim (libdatepp_shim.so) with glibc.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 tests/shim_conformance.cpp -o shim_conformance -ldl
+ *
+ * Usage:
+ *     shim_conformance [-n count] [-s seed] path/to/libdatepp_shim.so
+ *
+ *     -n  Random values checked per function (default: 200000)
+ *     -s  Seed (default: 1)
+ *
+ * The shim is loaded with dlopen and its `gmtime_r`, `gmtime`, `timegm` and `strftime` are called
+ * side by side with glibc's, found with dlsym(RTLD_NEXT). Checked are random timestamps over the whole
+ * `int` range of `tm_year`, edge timestamps (epoch, 32-bit limits, year and century boundaries, values
+ * that don't fit in a `tm`), denormalized `tm`s for `timegm`, and every `strftime` conversion, including
+ * the ones the shim forwards to glibc (flags, widths, E/O modifiers, %s, names, years outside 1000..9999),
+ * with buffers from 0 bytes up to the exact length of the result.
+ *
+ * Prints the first mismatches and exits with 1 if there were any.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <string>
+#include <dlfcn.h>
+#include <unistd.h>
+
+namespace {
+    using gmtime_r_t = struct tm* (*)(const time_t*, struct tm*);
+    using gmtime_t = struct tm* (*)(const time_t*);
+    using timegm_t = time_t (*)(struct tm*);
+    using strftime_t = size_t (*)(char*, size_t, const char*, const struct tm*);
+
+    struct Functions {
+        gmtime_r_t gmtime_r;
+        gmtime_t gmtime;
+        timegm_t timegm;
+        strftime_t strftime;
+    };
+
+    struct Options {
+        size_t count = 200000;
+        unsigned long long seed = 1;
+        const char* shim = nullptr;
+    };
+
+    constexpr size_t maxReports = 20;
+    size_t failures = 0;
+
+    [[noreturn]] void usage() {
+        std::cerr << "Usage: shim_conformance [-n count] [-s seed] path/to/libdatepp_shim.so\n";
+        std::exit(2);
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "n:s:h")) != -1) {
+            switch (option) {
+                case 'n': options.count = std::strtoul(optarg, nullptr, 10); break;
+                case 's': options.seed = std::strtoull(optarg, nullptr, 10); break;
+                default: usage();
+            }
+        }
+        if (optind + 1 != argc)
+            usage();
+        options.shim = argv[optind];
+        return options;
+    }
+
+    template<typename T>
+    T lookup(void* handle, const char* name) {
+        void* symbol = dlsym(handle, name);
+        if (symbol == nullptr) {
+            std::cerr << "shim_conformance: " << name << " not found: " << dlerror() << "\n";
+            std::exit(2);
+        }
+        return reinterpret_cast<T>(symbol);
+    }
+
+    void fail(const std::string& what) {
+        if (++failures <= maxReports)
+            std::cerr << "mismatch: " << what << "\n";
+    }
+
+    std::string describe(const struct tm& tm) {
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer), "{year %d mon %d mday %d hour %d min %d sec %d wday %d yday %d isdst %d gmtoff %ld zone %s}",
+                      tm.tm_year, tm.tm_mon, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, tm.tm_wday, tm.tm_yday, tm.tm_isdst,
+                      tm.tm_gmtoff, tm.tm_zone != nullptr ? tm.tm_zone : "(null)");
+        return buffer;
+    }
+
+    bool sameTm(const struct tm& a, const struct tm& b) {
+        return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour
+            && a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday
+            && a.tm_isdst == b.tm_isdst && a.tm_gmtoff == b.tm_gmtoff
+            && (a.tm_zone == nullptr) == (b.tm_zone == nullptr) && (a.tm_zone == nullptr || std::strcmp(a.tm_zone, b.tm_zone) == 0);
+    }
+
+    /*
+     * ------
+     * GMTIME
+     * ------
+     */
+    void checkGmtime(const Functions& shim, const Functions& libc, time_t timer) {
+        struct tm expected, actual;
+        std::memset(&expected, 0x5A, sizeof(expected));
+        std::memset(&actual, 0x5A, sizeof(actual));
+        errno = 0;
+        const bool expectedOk = libc.gmtime_r(&timer, &expected) != nullptr;
+        const int expectedErrno = errno;
+        errno = 0;
+        const bool actualOk = shim.gmtime_r(&timer, &actual) != nullptr;
+        const int actualErrno = errno;
+
+        const std::string name = "gmtime_r(" + std::to_string(static_cast<long long>(timer)) + ")";
+        if (expectedOk != actualOk || (!expectedOk && expectedErrno != actualErrno)) {
+            fail(name + ": glibc " + (expectedOk ? "succeeds" : "fails with " + std::to_string(expectedErrno))
+                 + ", shim " + (actualOk ? "succeeds" : "fails with " + std::to_string(actualErrno)));
+            return;
+        }
+        if (expectedOk && !sameTm(expected, actual))
+            fail(name + ": glibc " + describe(expected) + ", shim " + describe(actual));
+
+        // gmtime returns a static buffer of each library, so copy the first result before the second call.
+        struct tm* staticResult = libc.gmtime(&timer);
+        if (staticResult != nullptr)
+            expected = *staticResult;
+        const bool expectedStaticOk = staticResult != nullptr;
+        staticResult = shim.gmtime(&timer);
+        if ((staticResult != nullptr) != expectedStaticOk || (staticResult != nullptr && !sameTm(expected, *staticResult)))
+            fail("gmtime(" + std::to_string(static_cast<long long>(timer)) + ") differs");
+    }
+
+    /*
+     * ------
+     * TIMEGM
+     * ------
+     */
+    void checkTimegm(const Functions& shim, const Functions& libc, const struct tm& input) {
+        struct tm expected = input, actual = input;
+        errno = 0;
+        const time_t expectedResult = libc.timegm(&expected);
+        const int expectedErrno = errno;
+        errno = 0;
+        const time_t actualResult = shim.timegm(&actual);
+        const int actualErrno = errno;
+
+        // -1 is both a valid result and the error value; errno tells them apart.
+        const bool expectedOk = expectedResult != -1 || expectedErrno == 0;
+        const bool actualOk = actualResult != -1 || actualErrno == 0;
+        const std::string name = "timegm(" + describe(input) + ")";
+        if (expectedOk != actualOk) {
+            fail(name + ": glibc " + (expectedOk ? "succeeds" : "fails") + ", shim " + (actualOk ? "succeeds" : "fails"));
+            return;
+        }
+        if (!expectedOk)
+            return;
+        if (expectedResult != actualResult)
+            fail(name + ": glibc " + std::to_string(static_cast<long long>(expectedResult)) + ", shim "
+                 + std::to_string(static_cast<long long>(actualResult)));
+        else if (!sameTm(expected, actual))
+            fail(name + ": normalized to " + describe(expected) + " by glibc, " + describe(actual) + " by shim");
+    }
+
+    /*
+     * --------
+     * STRFTIME
+     * --------
+     */
+    const char* const formats[] = {
+        // Handled by the shim
+        "%Y-%m-%d %H:%M:%S", "%F %T", "%D %R", "%C %y %e %j", "%I %l %k", "%u %w %U %W", "%G-W%V-%u %g",
+        "%z %Z", "%n%t%%", "literal text only", "", "%Y%m%dT%H%M%SZ",
+        // Forwarded to glibc
+        "%a %A %b %B %h", "%p %P", "%c", "%x %X", "%r", "%s", "%Ec %EC %Ex %EX %Ey %EY", "%Od %Oe %OH %OI %Om %OM %OS %Ou %OU %OV %Ow %OW %Oy",
+        "%-d %-m %_H %05Y %10F", "%^a %#b", "%+", "%", "%Q"
+    };
+
+    void checkStrftime(const Functions& shim, const Functions& libc, const char* format, const struct tm& tm) {
+        char expected[512], actual[512];
+        const size_t expectedLength = libc.strftime(expected, sizeof(expected), format, &tm);
+        const size_t actualLength = shim.strftime(actual, sizeof(actual), format, &tm);
+        const std::string name = std::string("strftime(\"") + format + "\", " + describe(tm) + ")";
+        if (expectedLength != actualLength || std::strcmp(expected, actual) != 0) {
+            fail(name + ": glibc \"" + expected + "\" (" + std::to_string(expectedLength) + "), shim \"" + actual + "\" ("
+                 + std::to_string(actualLength) + ")");
+            return;
+        }
+
+        // Small buffers: 0 if the result and its null terminator don't fit, the result otherwise.
+        size_t sizes[] = {0, 1, 2, 3, 5, 8, expectedLength / 2, expectedLength, expectedLength + 1};
+        for (size_t size : sizes) {
+            if (size > expectedLength + 1)
+                continue;
+            char small[512];
+            const size_t smallLength = shim.strftime(small, size, format, &tm);
+            const size_t fits = expectedLength < size ? expectedLength : 0;
+            if (smallLength != fits || (fits > 0 && std::strcmp(small, expected) != 0)) {
+                fail(name + " with a buffer of " + std::to_string(size) + " bytes returns " + std::to_string(smallLength));
+                return;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    setenv("TZ", "UTC", 1); // %s and the forwarded conversions mustn't depend on the machine's zone
+    tzset();
+
+    void* handle = dlopen(options.shim, RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        std::cerr << "shim_conformance: " << dlerror() << "\n";
+        return 2;
+    }
+    const Functions shim = {lookup<gmtime_r_t>(handle, "gmtime_r"), lookup<gmtime_t>(handle, "gmtime"),
+                            lookup<timegm_t>(handle, "timegm"), lookup<strftime_t>(handle, "strftime")};
+    const Functions libc = {lookup<gmtime_r_t>(RTLD_NEXT, "gmtime_r"), lookup<gmtime_t>(RTLD_NEXT, "gmtime"),
+                            lookup<timegm_t>(RTLD_NEXT, "timegm"), lookup<strftime_t>(RTLD_NEXT, "strftime")};
+    if (shim.strftime == libc.strftime) {
+        std::cerr << "shim_conformance: " << options.shim << " doesn't define its own strftime\n";
+        return 2;
+    }
+
+    std::mt19937_64 random(options.seed);
+    size_t checks = 0;
+
+    // Edge timestamps: the epoch, 32-bit limits, leap days, century boundaries and the limits of `tm_year`.
+    const long long maxTm = (static_cast<long long>(INT_MAX) + 1900 - 1970) * 31556952LL;
+    const long long edges[] = {
+        0, -1, 1, 86399, 86400, -86400, -86401, INT_MAX, INT_MIN, static_cast<long long>(INT_MAX) + 1, static_cast<long long>(INT_MIN) - 1,
+        951782400, 951868800, 4107456000LL, 4107542400LL, 253402300799LL, 253402300800LL, -62135596800LL, -62135596801LL,
+        -2208988800LL, -12219292800LL, 67767976233532799LL, 67767976233532800LL, -67768040609740800LL, -67768040609740801LL,
+        maxTm, -maxTm, LLONG_MAX, LLONG_MIN, LLONG_MAX / 2, LLONG_MIN / 2
+    };
+    for (long long edge : edges)
+        for (long long delta = -1; delta <= 1; ++delta) {
+            if ((delta > 0 && edge > LLONG_MAX - delta) || (delta < 0 && edge < LLONG_MIN - delta))
+                continue;
+            checkGmtime(shim, libc, static_cast<time_t>(edge + delta));
+            ++checks;
+        }
+
+    // Random timestamps: most within a few thousand years, some anywhere `tm_year` can hold.
+    std::uniform_int_distribution<long long> nearby(-200000000000LL, 200000000000LL), anywhere(-maxTm - 86400000, maxTm + 86400000);
+    for (size_t i = 0; i < options.count; ++i) {
+        checkGmtime(shim, libc, static_cast<time_t>(i % 8 == 0 ? anywhere(random) : nearby(random)));
+        ++checks;
+    }
+
+    // timegm with fields out of their ranges, which both have to normalize the same way.
+    std::uniform_int_distribution<int> year(-3000, 10000), month(-30, 40), day(-70, 100), hour(-50, 80), minute(-150, 200), second(-200, 300);
+    for (size_t i = 0; i < options.count; ++i) {
+        struct tm tm;
+        std::memset(&tm, 0, sizeof(tm));
+        const bool normal = i % 2 == 0;
+        tm.tm_year = year(random);
+        tm.tm_mon = normal ? static_cast<int>(random() % 12) : month(random);
+        tm.tm_mday = normal ? static_cast<int>(random() % 28) + 1 : day(random);
+        tm.tm_hour = normal ? static_cast<int>(random() % 24) : hour(random);
+        tm.tm_min = normal ? static_cast<int>(random() % 60) : minute(random);
+        tm.tm_sec = normal ? static_cast<int>(random() % 61) : second(random);
+        tm.tm_wday = static_cast<int>(random() % 7); // Ignored and recomputed by both
+        tm.tm_yday = static_cast<int>(random() % 366);
+        checkTimegm(shim, libc, tm);
+        ++checks;
+    }
+    struct tm limits;
+    std::memset(&limits, 0, sizeof(limits));
+    for (int y : {INT_MAX, INT_MAX - 1900, INT_MIN, INT_MIN + 1900, 8099, 8100, -1900, -1901}) {
+        limits.tm_year = y;
+        limits.tm_mon = 11;
+        limits.tm_mday = 31;
+        limits.tm_hour = 23;
+        limits.tm_min = 59;
+        limits.tm_sec = 59;
+        checkTimegm(shim, libc, limits);
+        ++checks;
+    }
+
+    // strftime on dates from gmtime_r, including years below 1000 and above 9999 which the shim forwards.
+    std::uniform_int_distribution<long long> formatted(-62167219200LL - 1000LL * 31556952, 253402300800LL + 1000LL * 31556952);
+    for (size_t i = 0; i < options.count / 10 + sizeof(edges) / sizeof(edges[0]); ++i) {
+        time_t timer = static_cast<time_t>(i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : formatted(random));
+        struct tm tm;
+        if (libc.gmtime_r(&timer, &tm) == nullptr)
+            continue;
+        for (const char* format : formats) {
+            checkStrftime(shim, libc, format, tm);
+            ++checks;
+        }
+    }
+
+    std::cout << "shim_conformance: " << checks << " checks, " << failures << " mismatches\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/*
+ * time_zones: TimeZone against libc's localtime_r (with TZ set to the same zone) from 1900 to 2150,
+ * so both the transitions of the TZif files and the rules expanded after them are covered;
+ * the batch functions against single lookups on sorted and unsorted input; and invalid zones.
+ * Exits with 77 (skipped) if the system has no zoneinfo database.
+ */
+
+#include "../datepp_zones.hpp"
+#include "check.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    // Zones with half-hour DST (Lord_Howe), skipped days (Apia), southern DST, and no DST at all.
+    const char* const zoneNames[] = {
+        "Europe/Berlin", "America/New_York", "Australia/Lord_Howe", "Asia/Kolkata",
+        "America/Sao_Paulo", "Pacific/Apia", "Europe/London", "America/St_Johns", "UTC"
+    };
+
+    bool sameAsLibc(const TimeZone& zone, long long utc) {
+        const time_t time = static_cast<time_t>(utc);
+        std::tm tm;
+        if (localtime_r(&time, &tm) == nullptr)
+            return true; // Nothing to compare with
+        const CivilTime civil = zone.decompose(utc);
+        return zone.offsetAt(utc) == tm.tm_gmtoff && civil.year == tm.tm_year + 1900LL && civil.month == tm.tm_mon
+            && civil.day + 1 == tm.tm_mday && civil.hour == tm.tm_hour && civil.minute == tm.tm_min
+            && civil.second == tm.tm_sec && civil.dotw == tm.tm_wday;
+    }
+
+    template<typename Exception, typename F>
+    bool throws(F call) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    if (throws<std::exception>([]() { TimeZone::locate("Europe/Berlin"); })) {
+        std::cerr << "time_zones: no zoneinfo database, skipped\n";
+        return 77;
+    }
+
+    const long long first = -2208988800LL;  // 01.01.1900
+    const long long last = 5680281600LL;    // 01.01.2150
+    for (const char* name : zoneNames) {
+        const TimeZone zone = TimeZone::locate(name);
+        CHECK_EQ(zone.getName(), std::string(name));
+        setenv("TZ", (std::string(":") + name).c_str(), 1);
+        tzset();
+
+        // Every transition (and the seconds around it), then a stride through the whole span.
+        size_t mismatches = 0;
+        for (const TimeZone::Transition& transition : zone.getTransitions())
+            if (transition.utc >= first && transition.utc <= last)
+                for (long long utc = transition.utc - 2; utc <= transition.utc + 1; ++utc)
+                    mismatches += !sameAsLibc(zone, utc);
+        for (long long utc = first; utc < last; utc += 86400 * 3 + 4567)
+            mismatches += !sameAsLibc(zone, utc);
+        if (mismatches != 0)
+            std::cerr << name << ": " << mismatches << " timestamps differ from localtime_r\n";
+        CHECK_EQ(mismatches, 0u);
+    }
+    unsetenv("TZ");
+    tzset();
+
+    // The batch functions give the same results as single lookups, whether the input is sorted or not.
+    const TimeZone berlin = TimeZone::locate("Europe/Berlin");
+    std::vector<long long> sorted, shuffled;
+    for (long long utc = 1600000000LL; utc < 1800000000LL; utc += 7777777LL / 13)
+        sorted.push_back(utc);
+    for (size_t i = 0; i < sorted.size(); ++i)
+        shuffled.push_back(sorted[(i * 7919) % sorted.size()]);
+    for (const std::vector<long long>* input : {&sorted, &shuffled}) {
+        const size_t count = input->size();
+        std::vector<int> offsets(count);
+        std::vector<long long> local(count);
+        std::vector<CivilTime> civil(count);
+        berlin.offsetAt(input->data(), count, offsets.data());
+        berlin.toLocal(input->data(), count, local.data());
+        berlin.decompose(input->data(), count, civil.data());
+        for (size_t i = 0; i < count; ++i) {
+            const long long utc = (*input)[i];
+            const CivilTime expected = berlin.decompose(utc);
+            CHECK_EQ(offsets[i], berlin.offsetAt(utc));
+            CHECK_EQ(local[i], berlin.toLocal(utc));
+            CHECK(civil[i].year == expected.year && civil[i].month == expected.month && civil[i].day == expected.day
+                  && civil[i].hour == expected.hour && civil[i].second == expected.second
+                  && civil[i].timezoneOffset == expected.timezoneOffset);
+        }
+    }
+
+    // Zones built by hand, and fixed ones.
+    const TimeZone custom("Custom", {{0, 3600}, {86400, 7200}});
+    CHECK_EQ(custom.offsetAt(-1), 3600);
+    CHECK_EQ(custom.offsetAt(86399), 3600);
+    CHECK_EQ(custom.offsetAt(86400), 7200);
+    CHECK_EQ(TimeZone::fixed(-3.5).offsetAt(1700000000LL), -12600);
+    CHECK_EQ(TimeZone().offsetAt(1700000000LL), 0);
+    CHECK(throws<std::invalid_argument>([]() { TimeZone("Empty", {}); }));
+    CHECK(throws<std::invalid_argument>([]() { TimeZone("Unsorted", {{10, 0}, {10, 3600}}); }));
+
+    // Names that aren't zones, and data that isn't TZif.
+    CHECK(throws<std::invalid_argument>([]() { TimeZone::locate("../etc/passwd"); }));
+    CHECK(throws<std::invalid_argument>([]() { TimeZone::locate("/etc/localtime"); }));
+    CHECK(throws<std::runtime_error>([]() { TimeZone::locate("No/Such_Zone"); }));
+    const std::string garbage(100, 'x');
+    CHECK(throws<std::runtime_error>([&]() { TimeZone::fromTZif("Garbage", garbage.data(), garbage.size()); }));
+    CHECK(throws<std::runtime_error>([&]() { TimeZone::fromTZif("Short", "TZif2", 5); }));
+
+    return checks::exitCode();
+}
@@ -0,0 +1,119 @@
+/*
+ * timestamp_parser: the single-format parsers (epoch numbers, ISO 8601, RFC 2822) on valid and invalid
+ * input, and TimestampParser locking in the format of a stream, detecting again when it changes.
+ */
+
+#include "../datepp_parser.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    bool epoch(const char* text, long long& out, size_t& digits) {
+        return parseEpoch(text, std::strlen(text), out, digits);
+    }
+
+    bool iso(const char* text, long long& out) {
+        return parseISO8601(text, std::strlen(text), out);
+    }
+
+    bool rfc2822(const char* text, long long& out) {
+        return parseRFC2822(text, std::strlen(text), out);
+    }
+}
+
+int main() {
+    long long out = 0;
+    size_t digits = 0;
+
+    // Epoch numbers: the unit follows from the number of digits, and fractions of a second are floored.
+    CHECK(epoch("1700000000", out, digits) && out == 1700000000LL && digits == 10);
+    CHECK(epoch("1700000000123", out, digits) && out == 1700000000LL && digits == 13);
+    CHECK(epoch("1700000000123456", out, digits) && out == 1700000000LL && digits == 16);
+    CHECK(epoch("1700000000123456789", out, digits) && out == 1700000000LL && digits == 19);
+    CHECK(epoch("-1500", out, digits) && out == -1500LL);
+    CHECK(epoch("-100000000001", out, digits) && out == -100000001LL);
+    CHECK(!epoch("", out, digits));
+    CHECK(!epoch("-", out, digits));
+    CHECK(!epoch("17000000x0", out, digits));
+    CHECK(!epoch("9999999999999999999", out, digits));
+    CHECK(!epoch("12345678901234567890", out, digits));
+
+    // ISO 8601.
+    CHECK(iso("2023-11-14", out) && out == 1699920000LL);
+    CHECK(iso("2023-11-14T22:13", out) && out == 1699999980LL);
+    CHECK(iso("2023-11-14T22:13:20Z", out) && out == 1700000000LL);
+    CHECK(iso("2023-11-14 23:13:20.999+01:00", out) && out == 1700000000LL);
+    CHECK(iso("2023-11-14T16:43:20-0530", out) && out == 1700000000LL);
+    CHECK(iso("2023-11-15T01:13:20+03", out) && out == 1700000000LL);
+    CHECK(iso("1969-12-31T23:59:59Z", out) && out == -1LL);
+    CHECK(iso("2024-02-29", out));
+    CHECK(!iso("2023-02-29", out));
+    CHECK(!iso("2023-13-01", out));
+    CHECK(!iso("2023-11-14T24:00:00Z", out));
+    CHECK(!iso("2023-11-14T22:13:20+24:00", out));
+    CHECK(!iso("2023-11-14T22:13:20.Z", out));
+    CHECK(!iso("2023-11-14X22:13:20", out));
+    CHECK(!iso("2023-11-14T22:13:20Z ", out));
+
+    // RFC 2822.
+    CHECK(rfc2822("Tue, 14 Nov 2023 22:13:20 +0000", out) && out == 1700000000LL);
+    CHECK(rfc2822("14 Nov 2023 17:13:20 EST", out) && out == 1700000000LL);
+    CHECK(rfc2822("tue,  14 nov 2023 23:13:20 +0100", out) && out == 1700000000LL);
+    CHECK(rfc2822("1 Jan 1970 00:00 GMT", out) && out == 0LL);
+    CHECK(!rfc2822("Tue 14 Nov 2023 22:13:20 +0000", out));
+    CHECK(!rfc2822("Xyz, 14 Nov 2023 22:13:20 +0000", out));
+    CHECK(!rfc2822("31 Nov 2023 22:13:20 +0000", out));
+    CHECK(!rfc2822("14 Nov 2023 22:13:20 +0060", out));
+    CHECK(!rfc2822("14 Nov 2023 22:13:20 XYZ", out));
+
+    // A single-format stream is detected once.
+    TimestampParser parser;
+    const char* const isoStream[] = {"2023-11-14T22:13:20Z", "2023-11-14T22:13:21Z", "2023-11-14T22:13:22.5Z"};
+    for (size_t i = 0; i < 3; ++i) {
+        CHECK(parser.parse(isoStream[i], std::strlen(isoStream[i]), out));
+        CHECK_EQ(out, 1700000000LL + static_cast<long long>(i));
+    }
+    CHECK(parser.lockedFormat() == TimestampParser::Format::ISO8601);
+    CHECK_EQ(parser.getDetections(), 1u);
+    CHECK_EQ(parser.getCount(TimestampParser::Format::ISO8601), 3u);
+
+    // A value in another format moves the lock; one that matches nothing is a failure and keeps it.
+    CHECK(parser.parse(std::string("1700000000000"), out) && out == 1700000000LL);
+    CHECK(parser.lockedFormat() == TimestampParser::Format::EpochMilliseconds);
+    CHECK(!parser.parse(std::string("yesterday"), out));
+    CHECK(parser.lockedFormat() == TimestampParser::Format::EpochMilliseconds);
+    CHECK(parser.parse(std::string("1700000001000"), out) && out == 1700000001LL);
+    CHECK_EQ(parser.getDetections(), 3u);
+    CHECK_EQ(parser.getFailures(), 1u);
+    CHECK_EQ(parser.getCount(TimestampParser::Format::Unknown), 1u);
+    CHECK_EQ(parser.getCount(TimestampParser::Format::EpochMilliseconds), 2u);
+
+    // DateTimeFormat layouts are tried after the built-in formats, in their order, with the parser's offset.
+    TimestampParser layouts({DateTimeFormat(std::string("YY-MM-DD")), DateTimeFormat(std::string("DD.MM.YYYY HH:II:SS"))}, 1.0);
+    CHECK(layouts.parse(std::string("14.11.2023 23:13:20"), out) && out == 1700000000LL);
+    CHECK(layouts.lockedFormat() == TimestampParser::Format::Layout);
+    CHECK_EQ(layouts.lockedLayoutIndex(), 1u);
+    CHECK(layouts.parse(std::string("2023-11-14T22:13:20Z"), out) && out == 1700000000LL);
+    CHECK(layouts.lockedFormat() == TimestampParser::Format::ISO8601);
+    CHECK_EQ(layouts.getLayoutCount(1), 1u);
+    CHECK_EQ(layouts.getLayoutCount(0), 0u);
+
+    // Batches: failed strings give 0 and a false `ok`.
+    const std::string data = "1700000000not a date2023-11-14T22:13:20Z";
+    const size_t offsets[] = {0, 10, 20, data.size()};
+    long long results[3];
+    bool ok[3];
+    TimestampParser batch;
+    CHECK_EQ(batch.parse(data.c_str(), offsets, 3, results, ok), 1u);
+    CHECK(ok[0] && !ok[1] && ok[2]);
+    CHECK_EQ(results[0], 1700000000LL);
+    CHECK_EQ(results[1], 0LL);
+    CHECK_EQ(results[2], 1700000000LL);
+
+    return checks::exitCode();
+}
@@ -0,0 +1,140 @@
+/*
+ * timing_wheel: TimingWheel against a simple model (a map of pending deadlines) under random scheduling,
+ * cancelling and advancing over seconds to years, checking that every timer expires exactly once,
+ * at its deadline (or the second after it was scheduled); timers scheduled from callbacks;
+ * and ConcurrentTimingWheel with timers scheduled and cancelled from several threads.
+ */
+
+#include "../datepp_timers.hpp"
+#include "check.hpp"
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace beliumgl;
+
+    // Second at which a timer is due: its deadline, but not before the second after it was scheduled.
+    struct Pending {
+        long long due;
+        long long deadline;
+    };
+}
+
+int main() {
+    const long long start = 1700000000LL;
+    std::mt19937_64 random(7);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    TimingWheel<long long> wheel(start);
+    std::map<TimingWheel<long long>::TimerId, Pending> model;
+    std::vector<TimingWheel<long long>::TimerId> ids;
+    size_t mismatches = 0, expiredTotal = 0;
+
+    for (int round = 0; round < 3000; ++round) {
+        // Deadlines in the past, within the next minutes, hours and days, and beyond the 64 days of the wheels.
+        const int schedules = percent(random) % 8;
+        for (int i = 0; i < schedules; ++i) {
+            static const long long ranges[] = {5, 120, 7200, 86400 * 3, 86400 * 200, 86400LL * 365 * 3};
+            const long long range = ranges[percent(random) % 6];
+            const long long deadline = wheel.now() - 5 + static_cast<long long>(random() % static_cast<unsigned long long>(range + 5));
+            const TimingWheel<long long>::TimerId id = wheel.schedule(deadline, deadline);
+            model[id] = Pending{std::max(deadline, wheel.now() + 1), deadline};
+            ids.push_back(id);
+        }
+
+        // Cancelling pending timers succeeds once; cancelling expired or cancelled ones fails.
+        if (!ids.empty() && percent(random) < 30) {
+            const TimingWheel<long long>::TimerId id = ids[random() % ids.size()];
+            const bool pending = model.erase(id) != 0;
+            CHECK_EQ(wheel.isPending(id), pending);
+            CHECK_EQ(wheel.cancel(id), pending);
+            CHECK(!wheel.cancel(id));
+        }
+
+        // Small and large steps, so idle stretches of the wheels are skipped.
+        static const long long steps[] = {1, 37, 3600, 86400, 86400 * 30, 86400LL * 400};
+        const long long to = wheel.now() + 1 + static_cast<long long>(random() % static_cast<unsigned long long>(steps[percent(random) % 6]));
+        const size_t expired = wheel.advance(to, [&](TimingWheel<long long>::TimerId id, long long deadline, long long& value) {
+            auto found = model.find(id);
+            if (found == model.end() || found->second.due != wheel.now() || found->second.deadline != deadline || value != deadline) {
+                ++mismatches;
+                return;
+            }
+            model.erase(found);
+        });
+        expiredTotal += expired;
+        CHECK_EQ(wheel.now(), to);
+        CHECK_EQ(wheel.size(), model.size());
+        // Nothing that was due is still pending.
+        for (const auto& timer : model)
+            CHECK(timer.second.due > to);
+    }
+    CHECK_EQ(mismatches, 0u);
+    CHECK(expiredTotal > 1000);
+
+    // Going back in time does nothing.
+    const long long now = wheel.now();
+    CHECK_EQ(wheel.advance(now - 100, [](TimingWheel<long long>::TimerId, long long, long long&) {}), 0u);
+    CHECK_EQ(wheel.now(), now);
+
+    // A callback may reschedule: a periodic timer every 90 seconds for an hour, on DateTimes.
+    TimingWheel<int> periodic{DateTime(start)};
+    periodic.schedule(DateTime(start + 90), 0);
+    std::vector<long long> firings;
+    periodic.advance(DateTime(start + 3600), [&](TimingWheel<int>::TimerId, long long deadline, int& count) {
+        firings.push_back(deadline);
+        periodic.schedule(deadline + 90, count + 1);
+    });
+    CHECK_EQ(firings.size(), 40u);
+    for (size_t i = 0; i < firings.size(); ++i)
+        CHECK_EQ(firings[i], start + 90 * static_cast<long long>(i + 1));
+    CHECK_EQ(periodic.size(), 1u);
+
+    std::vector<int> values;
+    CHECK_EQ(periodic.advance(start + 3690, values), 1u);
+    CHECK(values.size() == 1 && values[0] == 40);
+
+    // Several threads schedule into their own shards; every other timer is cancelled from another thread.
+    ConcurrentTimingWheel<int> concurrent(start, 4);
+    constexpr int threadCount = 4, perThread = 2000;
+    std::vector<std::vector<ConcurrentTimingWheel<int>::TimerId>> scheduled(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < perThread; ++i)
+                scheduled[t].push_back(concurrent.schedule(start + 1 + (i * 7919) % 100000, t * perThread + i));
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    threads.clear();
+    CHECK_EQ(concurrent.size(), static_cast<size_t>(threadCount * perThread));
+
+    std::atomic<int> cancelled{0};
+    for (int t = 0; t < threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            const std::vector<ConcurrentTimingWheel<int>::TimerId>& other = scheduled[(t + 1) % threadCount];
+            for (size_t i = 0; i < other.size(); i += 2)
+                cancelled += concurrent.cancel(other[i]);
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    CHECK_EQ(cancelled.load(), threadCount * perThread / 2);
+
+    std::vector<bool> fired(threadCount * perThread, false);
+    size_t firedCount = 0;
+    const size_t expired = concurrent.advance(start + 100000, [&](ConcurrentTimingWheel<int>::TimerId, long long, int& value) {
+        fired[value] = true;
+        ++firedCount;
+    });
+    CHECK_EQ(expired, static_cast<size_t>(threadCount * perThread / 2));
+    CHECK_EQ(firedCount, expired);
+    for (int i = 0; i < threadCount * perThread; ++i)
+        CHECK_EQ(fired[i], i % perThread % 2 == 1);
+    CHECK_EQ(concurrent.size(), 0u);
+
+    return checks::exitCode();
+}
@@ -0,0 +1,930 @@
+/*
+ * datepp-bench: compares datepp with libc, std::chrono and the original algorithms.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 -pthread tools/datepp-bench.cpp -o datepp-bench
+ *     g++ -std=c++20 -O2 -pthread tools/datepp-bench.cpp -o datepp-bench   # adds the std::chrono calendar types
+ *
+ * Usage:
+ *     datepp-bench [-n count] [-s seed] [-b filter] [-t] [-z zone] [-T timers] [-j threads] [-i corpus]...
+ *
+ *     -n  Timestamps per distribution (default: 1000000)
+ *     -s  Seed of the generated timestamps (default: 1)
+ *     -b  Only run benchmarks whose name contains `filter`
+ *     -t  Print tab-separated values instead of a table
+ *     -z  Time zone of the zone group (default: Europe/Berlin)
+ *     -T  Timers of the timers group (default: 10000000)
+ *     -j  Threads of the concurrent timing wheel and clock benchmarks (default: 4)
+ *     -i  Use the unix timestamps (one per line) of a corpus file instead; can be repeated
+ *
+ * Every benchmark runs over the same timestamps, drawn from three distributions:
+ *
+ *     recent      2010-2030
+ *     pre-1970    1900-1970 (negative timestamps)
+ *     historical  years 1-1900
+ *
+ * or read from corpora made by `datepp-corpus` (sorted streams, day locality, etc.),
+ * and reports nanoseconds and heap allocations per operation. The groups are:
+ *
+ *     decompose   epoch -> fields
+ *     zone        epoch -> fields in a named time zone, in the input order and sorted
+ *     compose     fields -> epoch
+ *     format      fields -> text
+ *     arithmetic  checked and saturating arithmetic against the plain operators, calendar differences
+ *     serialize   RFC 3339, JSON and protobuf Timestamp writers and parsers (with throughput in GB/s)
+ *     parse       text -> epoch
+ *     timers      scheduling, cancelling and expiring `-T` timers due in the next 30 days (once, not per distribution)
+ *     clock       `-n` hybrid logical clock events on 1, 2, 4, ... `-j` threads sharing one clock (once)
+ *     ids         generating UUIDv7 and Snowflake ids, decomposing the timestamps of sorted ids (once)
+ *
+ * "legacy" rows are the algorithms DateTime used before the O(1) calendar core (copied here),
+ * "loop" is the naive year-by-year reference for the other direction.
+ *
+ * The DayCache rows also print the hits and misses of the cache, which depend on how many timestamps
+ * share a day. A Zipf-skewed corpus shows the cache on repeated days:
+ *     datepp-corpus -k zipf -o zipf.txt && datepp-bench -i zipf.txt -b DayCache
+ */
+
+#define DATEPP_ALLOCATION_TRACKING
+#include "../datepp.hpp"
+#include "../datepp_clock.hpp"
+#include "../datepp_ids.hpp"
+#include "../datepp_timers.hpp"
+#include "../datepp_zones.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#if __cplusplus >= 202002L && (__cpp_lib_chrono >= 201907L || _GLIBCXX_RELEASE >= 11)
+#define DATEPP_BENCH_CHRONO
+#endif
+
+namespace {
+    using namespace beliumgl;
+
+    struct Options {
+        size_t count = 1000000;
+        unsigned long long seed = 1;
+        std::string filter;
+        bool tsv = false;
+        std::string zone = "Europe/Berlin";
+        size_t timers = 10000000;
+        size_t threads = 4;
+        std::vector<std::string> corpora;
+    };
+
+    [[noreturn]] void usage() {
+        std::cerr << "Usage: datepp-bench [-n count] [-s seed] [-b filter] [-t] [-z zone] [-T timers] [-j threads] [-i corpus]...\n";
+        std::exit(2);
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "n:s:b:tz:T:j:i:h")) != -1) {
+            switch (option) {
+                case 'n': options.count = std::strtoul(optarg, nullptr, 10); break;
+                case 's': options.seed = std::strtoull(optarg, nullptr, 10); break;
+                case 'b': options.filter = optarg; break;
+                case 't': options.tsv = true; break;
+                case 'z': options.zone = optarg; break;
+                case 'T': options.timers = std::strtoul(optarg, nullptr, 10); break;
+                case 'j': options.threads = std::strtoul(optarg, nullptr, 10); break;
+                case 'i': options.corpora.push_back(optarg); break;
+                default: usage();
+            }
+        }
+        if (optind != argc || options.count == 0 || options.timers == 0 || options.threads == 0)
+            usage();
+        return options;
+    }
+
+    /*
+     * ------
+     * LEGACY
+     * ------
+     *
+     * DateTime::parseUnix and dotwByDate before the calendar core, as free functions.
+     */
+    bool legacyIsLeapYear(year_t year) {
+        return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+    }
+
+    day_t legacyDaysInMonth(year_t year, month_t month) {
+        static constexpr std::array<day_t, 12> days = {31,28,31,30,31,30,31,31,30,31,30,31};
+        return (month == 1 && legacyIsLeapYear(year)) ? 29 : days[month];
+    }
+
+    unsigned char legacyDotwByDate(year_t year, month_t month, day_t day) {
+        int m = month;
+        int y = year;
+        if (m < 3) {
+            m += 12;
+            y -= 1;
+        }
+        int q = day;
+        int K = y % 100;
+        int J = y / 100;
+        int h = (q + 13*(m + 1)/5 + K + K/4 + J/4 + 5*J) % 7;
+        return static_cast<unsigned char>((h - 1 + 7) % 7);
+    }
+
+    CivilTime legacyDecompose(long long _unix, timezone_offset_t timezoneOffset) {
+        long long adjustedUnix = _unix + static_cast<long long>(timezoneOffset * 3600);
+        long long days = adjustedUnix / 86400;
+        int remainderSeconds = static_cast<int>(adjustedUnix % 86400);
+        if (remainderSeconds < 0) {
+            remainderSeconds += 86400;
+            days -= 1;
+        }
+
+        year_t year = 1970;
+        if (days >= 0) {
+            while (true) {
+                unsigned short daysInYear = legacyIsLeapYear(year) ? 366 : 365;
+                if (days >= daysInYear) {
+                    days -= daysInYear;
+                    ++year;
+                } else break;
+            }
+        } else {
+            while (days < 0) {
+                days += legacyIsLeapYear(static_cast<year_t>(year - 1)) ? 366 : 365;
+                --year;
+            }
+        }
+
+        month_t month = 0;
+        while (days >= legacyDaysInMonth(year, month))
+            days -= legacyDaysInMonth(year, month++);
+
+        CivilTime time;
+        time.year = year;
+        time.month = month;
+        time.day = static_cast<day_t>(days);
+        time.hour = static_cast<hour_t>(remainderSeconds / 3600);
+        time.minute = static_cast<minute_t>(remainderSeconds % 3600 / 60);
+        time.second = static_cast<second_t>(remainderSeconds % 60);
+        time.dotw = legacyDotwByDate(year, static_cast<month_t>(month + 1), static_cast<day_t>(days + 1));
+        time.timezoneOffset = timezoneOffset;
+        return time;
+    }
+
+    long long loopCompose(const CivilTime& time) {
+        long long days = 0;
+        for (long long y = 1970; y < time.year; ++y) days += isLeapYear(y) ? 366 : 365;
+        for (long long y = time.year; y < 1970; ++y) days -= isLeapYear(y) ? 366 : 365;
+        for (month_t m = 0; m < time.month; ++m) days += daysInMonth(time.year, m);
+        days += time.day;
+        return days * 86400 + time.hour * 3600 + time.minute * 60 + time.second;
+    }
+
+    /*
+     * -------
+     * HARNESS
+     * -------
+     */
+    struct Distribution {
+        const char* name;
+        long long first, last; // Unix timestamps
+    };
+
+    const Distribution distributions[] = {
+        {"recent", 1262304000LL, 1924991999LL},
+        {"pre-1970", -2208988800LL, -1LL},
+        {"historical", -62135596800LL, -2208988801LL}
+    };
+
+    // Inputs of one distribution, prepared before timing.
+    struct Input {
+        std::vector<long long> unixTimes;
+        std::vector<CivilTime> civil;
+        std::vector<std::string> formatted, iso, unixStrings;
+        std::vector<std::tm> tms;
+    };
+
+    std::vector<long long> generate(const Distribution& distribution, size_t count, unsigned long long seed) {
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<long long> uniform(distribution.first, distribution.last);
+        std::vector<long long> unixTimes(count);
+        for (long long& _unix : unixTimes)
+            _unix = uniform(random);
+        return unixTimes;
+    }
+
+    std::vector<long long> readCorpus(const std::string& path) {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("Can't open " + path + ".");
+        std::vector<long long> unixTimes;
+        std::string line;
+        while (std::getline(file, line))
+            if (!line.empty())
+                unixTimes.push_back(std::strtoll(line.c_str(), nullptr, 10));
+        if (unixTimes.empty())
+            throw std::runtime_error(path + " has no timestamps.");
+        return unixTimes;
+    }
+
+    Input prepare(std::vector<long long> unixTimes, const DateTimeFormat& format) {
+        Input input;
+        char buffer[128];
+        for (long long _unix : unixTimes) {
+            CivilTime time = decompose(_unix);
+            std::tm tm;
+            unixToTm(_unix, tm);
+            std::snprintf(buffer, sizeof(buffer), "%04lld-%02d-%02dT%02d:%02d:%02dZ",
+                          time.year, time.month + 1, time.day + 1, time.hour, time.minute, time.second);
+
+            input.civil.push_back(time);
+            input.tms.push_back(tm);
+            input.iso.push_back(buffer);
+            input.unixStrings.push_back(std::to_string(_unix));
+            formatTo(buffer, sizeof(buffer), time, format);
+            input.formatted.push_back(buffer);
+        }
+        input.unixTimes = std::move(unixTimes);
+        return input;
+    }
+
+    volatile long long sink;
+
+    struct Result {
+        double nanoseconds;
+        double allocations;
+        double gigabytesPerSecond; // Results summed per second, for benchmarks that return the bytes they processed
+    };
+
+    // `run(i)` is one operation on the i-th input; its results are summed, so they can't be optimized away.
+    template<typename F>
+    Result measure(size_t count, F run) {
+        long long warmup = 0;
+        for (size_t i = 0; i < count / 10; ++i) // Warm up
+            warmup += run(i);
+
+        long long measured = 0;
+        instrumentation::AllocationScope scope;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+            measured += run(i);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        unsigned long long allocations = scope.allocations();
+        sink = warmup + measured;
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+        return Result{nanoseconds / static_cast<double>(count), static_cast<double>(allocations) / static_cast<double>(count),
+                      static_cast<double>(measured) / nanoseconds};
+    }
+
+    // Hits and misses of a cache since its last `resetStats()` (including the warm-up of the benchmark).
+    template<size_t Size>
+    std::string cacheStats(const DayCache<Size>& cache) {
+        char text[96];
+        std::snprintf(text, sizeof(text), "hits %zu, misses %zu (%.1f%%)", cache.getHits(), cache.getMisses(), cache.hitRate() * 100.0);
+        return text;
+    }
+
+    class Bench {
+    public:
+        explicit Bench(const Options& options) : options(options) {
+            if (options.tsv)
+                std::cout << "group\tbenchmark\tdistribution\tns/op\tallocs/op\tGB/s\tnotes\n";
+            else
+                std::printf("%-10s %-34s %-12s %10s %10s %8s  %s\n", "group", "benchmark", "distribution", "ns/op", "allocs/op", "GB/s", "notes");
+        }
+
+        // Following benchmarks run on `count` inputs of `distribution`.
+        void setInput(const std::string& distribution, size_t count) {
+            this->distribution = distribution;
+            this->count = count;
+        }
+
+        /*
+         * With `bytes`, `operation` returns the number of bytes it wrote or read, and the throughput is shown.
+         * `note` is called after the measurement, for statistics the operation gathered (e.g. cache hits).
+         */
+        template<typename F>
+        void run(const char* group, const char* name, F operation, bool bytes = false,
+                 const std::function<std::string()>& note = nullptr) {
+            if (enabled(group, name)) {
+                Result result = measure(this->count, operation);
+                report(group, name, result, bytes, note ? note() : std::string());
+            }
+        }
+
+        bool enabled(const char* group, const char* name) const {
+            std::string fullName = std::string(group) + "/" + name;
+            return this->options.filter.empty() || fullName.find(this->options.filter) != std::string::npos;
+        }
+
+        // Prints a result measured by the caller, for benchmarks that aren't one operation per input.
+        void report(const char* group, const char* name, const Result& result, bool bytes = false, const std::string& note = "") {
+            if (!enabled(group, name))
+                return;
+            const char* distribution = this->distribution.c_str();
+            char throughput[32] = "-";
+            if (bytes)
+                std::snprintf(throughput, sizeof(throughput), "%.2f", result.gigabytesPerSecond);
+            if (this->options.tsv)
+                std::cout << group << '\t' << name << '\t' << distribution << '\t' << result.nanoseconds << '\t' << result.allocations
+                          << '\t' << throughput << '\t' << note << '\n';
+            else
+                std::printf("%-10s %-34s %-12s %10.1f %10.2f %8s  %s\n", group, name, distribution, result.nanoseconds, result.allocations,
+                            throughput, note.c_str());
+            std::fflush(stdout);
+        }
+    private:
+        const Options& options;
+        std::string distribution;
+        size_t count = 0;
+    };
+
+    /*
+     * ------
+     * TIMERS
+     * ------
+     *
+     * TimingWheel against std::multimap<DateTime, ...> (the usual way to keep timers sorted):
+     * schedule all timers, cancel every 10th one and expire the rest. The timings are per timer.
+     */
+    template<typename F>
+    Result measurePhase(size_t count, F phase) {
+        instrumentation::AllocationScope scope;
+        auto start = std::chrono::steady_clock::now();
+        phase();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return Result{std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count),
+                      static_cast<double>(scope.allocations()) / static_cast<double>(count), 0.0};
+    }
+
+    void benchTimers(Bench& bench, const Options& options) {
+        // A block of benchmarks runs if the filter picks any of its phases.
+        auto wanted = [&](const std::string& prefix, const char* first, const char* second, const char* third) {
+            return bench.enabled("timers", (prefix + first).c_str()) || bench.enabled("timers", (prefix + second).c_str())
+                || bench.enabled("timers", (prefix + third).c_str());
+        };
+        const size_t threads = options.threads;
+        char concurrent[64];
+        std::snprintf(concurrent, sizeof(concurrent), "datepp ConcurrentTimingWheel x%zu", threads);
+        if (!wanted("datepp TimingWheel", " schedule", " cancel", " expire") && !wanted(concurrent, " schedule", " cancel", " expire")
+            && !wanted("std::multimap<DateTime>", " insert", " erase", " expire"))
+            return;
+
+        const size_t count = options.timers;
+        const long long now = 1700000000LL;
+        std::mt19937_64 random(options.seed);
+        std::uniform_int_distribution<long long> inMonth(1, 30 * 86400LL);
+        std::vector<long long> deadlines(count);
+        for (long long& deadline : deadlines)
+            deadline = now + inMonth(random);
+        const size_t cancelled = (count + 9) / 10;
+        long long expired = 0;
+        bench.setInput(std::to_string(count) + " timers", count);
+
+        if (wanted("datepp TimingWheel", " schedule", " cancel", " expire")) {
+            TimingWheel<size_t> wheel(now);
+            std::vector<TimingWheel<size_t>::TimerId> ids(count);
+            bench.report("timers", "datepp TimingWheel schedule", measurePhase(count, [&]() {
+                for (size_t i = 0; i < count; ++i)
+                    ids[i] = wheel.schedule(deadlines[i], i);
+            }));
+            bench.report("timers", "datepp TimingWheel cancel", measurePhase(cancelled, [&]() {
+                for (size_t i = 0; i < count; i += 10)
+                    wheel.cancel(ids[i]);
+            }));
+            bench.report("timers", "datepp TimingWheel expire", measurePhase(count - cancelled, [&]() {
+                expired += static_cast<long long>(wheel.advance(now + 31 * 86400LL, [&](TimingWheel<size_t>::TimerId, long long, size_t& i) {
+                    expired += static_cast<long long>(i);
+                }));
+            }));
+        }
+
+        if (wanted(concurrent, " schedule", " cancel", " expire")) {
+            // Every thread schedules its part into its own shard, then all shards expire together.
+            ConcurrentTimingWheel<size_t> wheel(now, threads);
+            std::vector<ConcurrentTimingWheel<size_t>::TimerId> ids(count);
+            const std::string name = concurrent;
+            auto run = [&](std::function<void(size_t, size_t)> part) {
+                std::vector<std::thread> workers;
+                for (size_t t = 0; t < threads; ++t)
+                    workers.emplace_back([&, t]() { part(count * t / threads, count * (t + 1) / threads); });
+                for (std::thread& worker : workers)
+                    worker.join();
+            };
+            bench.report("timers", (name + " schedule").c_str(), measurePhase(count, [&]() {
+                run([&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
+                        ids[i] = wheel.schedule(deadlines[i], i);
+                });
+            }));
+            bench.report("timers", (name + " cancel").c_str(), measurePhase(cancelled, [&]() {
+                run([&](size_t begin, size_t end) {
+                    for (size_t i = (begin + 9) / 10 * 10; i < end; i += 10)
+                        wheel.cancel(ids[i]);
+                });
+            }));
+            bench.report("timers", (name + " expire").c_str(), measurePhase(count - cancelled, [&]() {
+                expired += static_cast<long long>(wheel.advance(now + 31 * 86400LL, [&](ConcurrentTimingWheel<size_t>::TimerId, long long, size_t& i) {
+                    expired += static_cast<long long>(i);
+                }));
+            }));
+        }
+
+        if (wanted("std::multimap<DateTime>", " insert", " erase", " expire")) {
+            std::multimap<DateTime, size_t> timers;
+            std::vector<std::multimap<DateTime, size_t>::iterator> ids(count);
+            bench.report("timers", "std::multimap<DateTime> insert", measurePhase(count, [&]() {
+                for (size_t i = 0; i < count; ++i)
+                    ids[i] = timers.emplace(DateTime(deadlines[i]), i);
+            }));
+            bench.report("timers", "std::multimap<DateTime> erase", measurePhase(cancelled, [&]() {
+                for (size_t i = 0; i < count; i += 10)
+                    timers.erase(ids[i]);
+            }));
+            bench.report("timers", "std::multimap<DateTime> expire", measurePhase(count - cancelled, [&]() {
+                const DateTime end(now + 31 * 86400LL);
+                while (!timers.empty() && timers.begin()->first <= end) {
+                    expired += static_cast<long long>(timers.begin()->second);
+                    timers.erase(timers.begin());
+                }
+            }));
+        }
+        sink = expired;
+    }
+
+    /*
+     * -----
+     * CLOCK
+     * -----
+     *
+     * One HybridLogicalClock shared by 1, 2, 4, ... `-j` threads, against the same algorithm behind
+     * a std::mutex and the bare wall clock. ns/op is the wall time divided by the operations of all threads,
+     * so it shows the throughput under contention.
+     */
+    class LockedHybridClock {
+    public:
+        HybridTimestamp now() {
+            const unsigned long long physical = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count()) << HybridTimestamp::counterBits;
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->state = std::max(this->state + 1, physical);
+            return HybridTimestamp(this->state);
+        }
+    private:
+        std::mutex mutex;
+        unsigned long long state = 0;
+    };
+
+    void benchClock(Bench& bench, const Options& options) {
+        if (!bench.enabled("clock", "datepp HybridLogicalClock now") && !bench.enabled("clock", "datepp HybridLogicalClock receive")
+            && !bench.enabled("clock", "std::mutex hybrid clock now") && !bench.enabled("clock", "system_clock::now"))
+            return;
+
+        const size_t count = options.count;
+        std::vector<size_t> threadCounts;
+        for (size_t threads = 1; threads < options.threads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(options.threads);
+
+        for (size_t threads : threadCounts) {
+            // Every thread does its share of `count` operations; the results are summed so they can't be optimized away.
+            std::atomic<unsigned long long> total{0};
+            auto parallel = [&](std::function<unsigned long long(size_t)> part) {
+                return measurePhase(count, [&]() {
+                    std::vector<std::thread> workers;
+                    for (size_t t = 0; t < threads; ++t)
+                        workers.emplace_back([&, t]() { total += part(count * (t + 1) / threads - count * t / threads); });
+                    for (std::thread& worker : workers)
+                        worker.join();
+                });
+            };
+            bench.setInput(std::to_string(threads) + (threads == 1 ? " thread" : " threads"), count);
+
+            if (bench.enabled("clock", "datepp HybridLogicalClock now")) {
+                HybridLogicalClock clock;
+                bench.report("clock", "datepp HybridLogicalClock now", parallel([&](size_t operations) {
+                    unsigned long long sum = 0;
+                    for (size_t i = 0; i < operations; ++i)
+                        sum += clock.now().packed();
+                    return sum;
+                }));
+            }
+            if (bench.enabled("clock", "datepp HybridLogicalClock receive")) {
+                // Messages from a peer whose clock is a little ahead, so most of them move this clock.
+                HybridLogicalClock clock;
+                bench.report("clock", "datepp HybridLogicalClock receive", parallel([&](size_t operations) {
+                    unsigned long long sum = 0;
+                    HybridTimestamp remote(detail::systemMilliseconds() + 5, 0);
+                    for (size_t i = 0; i < operations; ++i) {
+                        remote = HybridTimestamp(remote.packed() + 7);
+                        sum += clock.receive(remote).packed();
+                    }
+                    return sum;
+                }));
+            }
+            if (bench.enabled("clock", "std::mutex hybrid clock now")) {
+                LockedHybridClock clock;
+                bench.report("clock", "std::mutex hybrid clock now", parallel([&](size_t operations) {
+                    unsigned long long sum = 0;
+                    for (size_t i = 0; i < operations; ++i)
+                        sum += clock.now().packed();
+                    return sum;
+                }));
+            }
+            if (bench.enabled("clock", "system_clock::now")) {
+                bench.report("clock", "system_clock::now", parallel([&](size_t operations) {
+                    unsigned long long sum = 0;
+                    for (size_t i = 0; i < operations; ++i)
+                        sum += static_cast<unsigned long long>(std::chrono::system_clock::now().time_since_epoch().count());
+                    return sum;
+                }));
+            }
+            sink = static_cast<long long>(total.load());
+        }
+    }
+
+    long long sum(const CivilTime& time) {
+        return time.year + time.month + time.day + time.hour + time.minute + time.second + time.dotw;
+    }
+
+    long long sum(const std::tm& tm) {
+        return tm.tm_year + tm.tm_mon + tm.tm_mday + tm.tm_hour + tm.tm_min + tm.tm_sec + tm.tm_wday;
+    }
+
+    /*
+     * ---
+     * IDS
+     * ---
+     *
+     * Generating UUIDv7 and Snowflake ids (one at a time and in batches of 256, which read the clock once),
+     * and decomposing the timestamps of `-n` sorted ids from the recent distribution, against one DateTime per id.
+     */
+    void benchIds(Bench& bench, const Options& options, const TimeZone& zone) {
+        if (!bench.enabled("ids", "datepp UUIDv7Generator") && !bench.enabled("ids", "datepp SnowflakeGenerator")
+            && !bench.enabled("ids", "std::mt19937_64 UUIDv4") && !bench.enabled("ids", "decompose") && !bench.enabled("ids", "DateTime per id"))
+            return;
+
+        const size_t count = options.count;
+        constexpr size_t block = 256;
+        bench.setInput("generated", count);
+        {
+            UUIDv7Generator generator;
+            UUID ids[block];
+            bench.run("ids", "datepp UUIDv7Generator next", [&](size_t) {
+                return static_cast<long long>(generator.next().low);
+            });
+            bench.run("ids", "datepp UUIDv7Generator (batch)", [&](size_t i) {
+                if (i % block == 0)
+                    generator.next(ids, block);
+                return static_cast<long long>(ids[i % block].low);
+            });
+        }
+        {
+            SnowflakeGenerator generator(SnowflakeLayout::twitter(), 1);
+            unsigned long long ids[block];
+            bench.run("ids", "datepp SnowflakeGenerator next", [&](size_t) {
+                return static_cast<long long>(generator.next());
+            });
+            bench.run("ids", "datepp SnowflakeGenerator (batch)", [&](size_t i) {
+                if (i % block == 0)
+                    generator.next(ids, block);
+                return static_cast<long long>(ids[i % block]);
+            });
+        }
+        {
+            // Random UUIDs without a timestamp, for the cost of the random bits alone.
+            std::mt19937_64 random(options.seed);
+            bench.run("ids", "std::mt19937_64 UUIDv4", [&](size_t) {
+                UUID id((random() & ~0xF000ULL) | 0x4000ULL, (random() >> 2) | 0x8000000000000000ULL);
+                return static_cast<long long>(id.high ^ id.low);
+            });
+        }
+
+        // Ids made in time order, so they're sorted, like a partition of a table.
+        std::vector<long long> milliseconds = generate(distributions[0], count, options.seed);
+        for (long long& value : milliseconds)
+            value = value * 1000 + static_cast<long long>(static_cast<unsigned long long>(value) % 1000);
+        std::sort(milliseconds.begin(), milliseconds.end());
+        const SnowflakeLayout layout = SnowflakeLayout::twitter();
+        std::vector<UUID> uuids(count);
+        std::vector<unsigned long long> snowflakes(count);
+        for (size_t i = 0; i < count; ++i) {
+            uuids[i] = UUID(static_cast<unsigned long long>(milliseconds[i]) << 16 | 0x7000ULL, 0x8000000000000000ULL | i);
+            snowflakes[i] = layout.make(static_cast<unsigned long long>(milliseconds[i] - layout.getEpoch()), 1, i & layout.maxSequence());
+        }
+        std::vector<CivilTime> fields(count);
+        bench.setInput("recent", count);
+        bench.run("ids", "datepp decomposeUUIDv7", [&](size_t i) {
+            if (i == 0)
+                decomposeUUIDv7(uuids.data(), count, fields.data(), 2.0);
+            return sum(fields[i]);
+        });
+        bench.run("ids", "datepp decomposeUUIDv7 (zone)", [&](size_t i) {
+            if (i == 0)
+                decomposeUUIDv7(uuids.data(), count, fields.data(), zone);
+            return sum(fields[i]);
+        });
+        bench.run("ids", "datepp SnowflakeLayout::decompose", [&](size_t i) {
+            if (i == 0)
+                layout.decompose(snowflakes.data(), count, fields.data(), 2.0);
+            return sum(fields[i]);
+        });
+        bench.run("ids", "datepp SnowflakeLayout::decompose (zone)", [&](size_t i) {
+            if (i == 0)
+                layout.decompose(snowflakes.data(), count, fields.data(), zone);
+            return sum(fields[i]);
+        });
+        bench.run("ids", "UUIDv7 -> DateTime per id", [&](size_t i) {
+            DateTime dateTime(uuids[i].unixTime(), 2.0);
+            return static_cast<long long>(dateTime.year() + dateTime.day() + dateTime.second());
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    const DateTimeFormat format(std::string("W, DD/MM/YY, HH:II:SS O UTC"));
+    Bench bench(options);
+
+    std::vector<std::pair<std::string, std::vector<long long>>> inputs;
+    TimeZone zone;
+    try {
+        zone = TimeZone::locate(options.zone);
+        setenv("TZ", options.zone.c_str(), 1); // For localtime_r
+        tzset();
+    } catch (const std::exception& e) {
+        std::cerr << "datepp-bench: " << e.what() << " (" << options.zone << "), the zone group uses UTC\n";
+    }
+    try {
+        for (const std::string& path : options.corpora)
+            inputs.emplace_back(path, readCorpus(path));
+    } catch (const std::exception& e) {
+        std::cerr << "datepp-bench: " << e.what() << "\n";
+        return 1;
+    }
+    if (inputs.empty())
+        for (const Distribution& distribution : distributions)
+            inputs.emplace_back(distribution.name, generate(distribution, options.count, options.seed));
+
+    for (auto& named : inputs) {
+        const Input input = prepare(std::move(named.second), format);
+        bench.setInput(named.first, input.unixTimes.size());
+        const std::vector<long long>& unixTimes = input.unixTimes;
+        const std::vector<CivilTime>& civil = input.civil;
+        char buffer[128];
+
+        // epoch -> fields
+        bench.run("decompose", "datepp decompose", [&](size_t i) { return sum(decompose(unixTimes[i])); });
+        bench.run("decompose", "datepp DateTime(long long)", [&](size_t i) {
+            DateTime dateTime(unixTimes[i]);
+            return static_cast<long long>(dateTime.year() + dateTime.day() + dateTime.second());
+        });
+        DayCache<> cache;
+        bench.run("decompose", "datepp DayCache", [&](size_t i) { return sum(cache.decompose(unixTimes[i])); },
+                  false, [&]() { return cacheStats(cache); });
+        bench.run("decompose", "legacy parseUnix", [&](size_t i) { return sum(legacyDecompose(unixTimes[i], 0.0)); });
+        bench.run("decompose", "libc gmtime_r", [&](size_t i) {
+            std::tm tm;
+            time_t timer = static_cast<time_t>(unixTimes[i]);
+            gmtime_r(&timer, &tm);
+            return sum(tm);
+        });
+#ifdef DATEPP_BENCH_CHRONO
+        bench.run("decompose", "std::chrono year_month_day", [&](size_t i) {
+            using namespace std::chrono;
+            sys_seconds time{seconds{unixTimes[i]}};
+            sys_days day = floor<days>(time);
+            year_month_day date{day};
+            hh_mm_ss<seconds> timeOfDay{time - day};
+            return static_cast<long long>(static_cast<int>(date.year()) + static_cast<unsigned>(date.month()) + static_cast<unsigned>(date.day())
+                 + timeOfDay.hours().count() + timeOfDay.minutes().count() + timeOfDay.seconds().count()
+                 + weekday{day}.c_encoding());
+        });
+#endif
+
+        // epoch -> fields in a named zone, in blocks like a column store would convert them
+        std::vector<long long> sorted(unixTimes);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<CivilTime> zoned(unixTimes.size());
+        constexpr size_t zoneBlock = 4096;
+        auto zoneBatch = [&](const std::vector<long long>& times, size_t i) {
+            if (i % zoneBlock == 0)
+                zone.decompose(&times[i], std::min(zoneBlock, times.size() - i), &zoned[i]);
+            return sum(zoned[i]);
+        };
+        bench.run("zone", "datepp TimeZone::decompose", [&](size_t i) { return sum(zone.decompose(unixTimes[i])); });
+        bench.run("zone", "datepp TimeZone (batch)", [&](size_t i) { return zoneBatch(unixTimes, i); });
+        bench.run("zone", "datepp TimeZone (batch, sorted)", [&](size_t i) { return zoneBatch(sorted, i); });
+        bench.run("zone", "datepp decompose (fixed, sorted)", [&](size_t i) {
+            if (i % zoneBlock == 0)
+                decompose(&sorted[i], std::min(zoneBlock, sorted.size() - i), &zoned[i], 1.0);
+            return sum(zoned[i]);
+        });
+        bench.run("zone", "libc localtime_r (sorted)", [&](size_t i) {
+            std::tm tm;
+            time_t timer = static_cast<time_t>(sorted[i]);
+            localtime_r(&timer, &tm);
+            return sum(tm);
+        });
+
+        // fields -> epoch
+        bench.run("compose", "datepp daysFromCivil", [&](size_t i) {
+            const CivilTime& time = civil[i];
+            return daysFromCivil(time.year, time.month, time.day) * 86400 + time.hour * 3600 + time.minute * 60 + time.second;
+        });
+        bench.run("compose", "loop (reference)", [&](size_t i) { return loopCompose(civil[i]); });
+        bench.run("compose", "libc timegm", [&](size_t i) {
+            std::tm tm = input.tms[i];
+            return static_cast<long long>(timegm(&tm));
+        });
+#ifdef DATEPP_BENCH_CHRONO
+        bench.run("compose", "std::chrono sys_days", [&](size_t i) {
+            using namespace std::chrono;
+            const CivilTime& time = civil[i];
+            sys_days day{year{static_cast<int>(time.year)} / month{time.month + 1u} / std::chrono::day{time.day + 1u}};
+            return (day + hours{time.hour} + minutes{time.minute} + seconds{time.second}).time_since_epoch().count();
+        });
+#endif
+
+        // fields -> text
+        bench.run("format", "datepp formatTo", [&](size_t i) {
+            return static_cast<long long>(formatTo(buffer, sizeof(buffer), civil[i], format));
+        });
+        bench.run("format", "datepp DateTime::toString", [&](size_t i) {
+            return static_cast<long long>(DateTime(unixTimes[i]).toString(format).size());
+        });
+        bench.run("format", "datepp DateTime::toFixedString", [&](size_t i) {
+            return static_cast<long long>(DateTime(unixTimes[i]).toFixedString(format).size());
+        });
+        cache.resetStats();
+        bench.run("format", "datepp DayCache::formatTo", [&](size_t i) {
+            return static_cast<long long>(cache.formatTo(buffer, sizeof(buffer), unixTimes[i], format));
+        }, false, [&]() { return cacheStats(cache); });
+        bench.run("format", "libc strftime", [&](size_t i) {
+            return static_cast<long long>(std::strftime(buffer, sizeof(buffer), "%a, %d/%m/%Y %H:%M:%S +00 UTC", &input.tms[i]));
+        });
+
+        // One instant in 50 offsets (the viewer and the attendees of an event), per operation
+        std::vector<timezone_offset_t> offsets;
+        for (int j = 0; j < 50; ++j)
+            offsets.push_back((j * 37 % 105 - 48) * 0.25);
+        std::vector<CivilTime> inOffsets(offsets.size());
+        bench.run("format", "datepp decomposeInOffsets (x50)", [&](size_t i) {
+            decomposeInOffsets(unixTimes[i], offsets.data(), offsets.size(), inOffsets.data());
+            return sum(inOffsets[i % offsets.size()]);
+        });
+        bench.run("format", "datepp decompose per offset (x50)", [&](size_t i) {
+            for (size_t j = 0; j < offsets.size(); ++j)
+                inOffsets[j] = decompose(unixTimes[i], offsets[j]);
+            return sum(inOffsets[i % offsets.size()]);
+        });
+        char offsetsBuffer[50 * 64];
+        bench.run("format", "datepp formatInOffsets (x50)", [&](size_t i) {
+            return static_cast<long long>(formatInOffsets(offsetsBuffer, sizeof(offsetsBuffer), unixTimes[i], offsets.data(), offsets.size(), format));
+        });
+        bench.run("format", "datepp DateTime per offset (x50)", [&](size_t i) {
+            long long length = 0;
+            for (timezone_offset_t offset : offsets)
+                length += static_cast<long long>(DateTime(unixTimes[i], offset).toString(format).size());
+            return length;
+        });
+
+        // Overflow-checked arithmetic against the plain operators, on pairs of timestamps
+        const size_t last = unixTimes.size() - 1;
+        bench.run("arithmetic", "long long a + b (unchecked)", [&](size_t i) { return unixTimes[i] + unixTimes[last - i]; });
+        bench.run("arithmetic", "datepp addChecked", [&](size_t i) {
+            long long out = 0;
+            addChecked(unixTimes[i], unixTimes[last - i], out);
+            return out;
+        });
+        bench.run("arithmetic", "datepp addSaturating", [&](size_t i) { return addSaturating(unixTimes[i], unixTimes[last - i]); });
+        bench.run("arithmetic", "long long a * b (unchecked)", [&](size_t i) { return unixTimes[i] * (unixTimes[last - i] & 0xffff); });
+        bench.run("arithmetic", "datepp mulChecked", [&](size_t i) {
+            long long out = 0;
+            mulChecked(unixTimes[i], unixTimes[last - i] & 0xffff, out);
+            return out;
+        });
+        bench.run("arithmetic", "datepp advanceChecked (months)", [&](size_t i) {
+            long long out = 0;
+            advanceChecked(unixTimes[i], RangeStep::months(static_cast<long long>(i & 0xff)), out);
+            return out;
+        });
+        bench.run("arithmetic", "datepp DateTime operator-", [&](size_t i) {
+            return (DateTime(unixTimes[i]) - DateTime(unixTimes[last - i])).unixTime();
+        });
+        bench.run("arithmetic", "datepp DateTime::subChecked", [&](size_t i) {
+            DateTime out(0LL);
+            DateTime(unixTimes[i]).subChecked(DateTime(unixTimes[last - i]), out);
+            return out.unixTime();
+        });
+        // Calendar differences over spans of up to a century, like ages
+        std::vector<long long> ends(unixTimes.size()), months(unixTimes.size());
+        for (size_t i = 0; i < unixTimes.size(); ++i)
+            ends[i] = unixTimes[i] + static_cast<long long>(i * 2654435761ULL % 3155760000ULL);
+        bench.run("arithmetic", "datepp calendarDifference", [&](size_t i) {
+            return calendarDifference(unixTimes[i], ends[i]).totalMonths();
+        });
+        bench.run("arithmetic", "datepp monthsBetween", [&](size_t i) { return monthsBetween(unixTimes[i], ends[i]); });
+        bench.run("arithmetic", "datepp monthsBetween (batch)", [&](size_t i) {
+            if (i % 1024 == 0)
+                monthsBetween(&unixTimes[i], &ends[i], std::min<size_t>(1024, unixTimes.size() - i), &months[i]);
+            return months[i];
+        });
+        bench.run("arithmetic", "loop monthsBetween", [&](size_t i) {
+            // Month by month over daysInMonth, as user code had to do it
+            const CivilTime start = decompose(unixTimes[i]);
+            long long year = start.year, count = 0, next = unixTimes[i];
+            int month = start.month;
+            while (true) {
+                next += daysInMonth(year, static_cast<month_t>(month)) * 86400LL;
+                if (next > ends[i])
+                    break;
+                ++count;
+                if (++month == 12) {
+                    month = 0;
+                    ++year;
+                }
+            }
+            return count;
+        });
+
+        // Wire formats; the lambdas return bytes, for the throughput
+        std::vector<std::string> rfc3339, epochNumbers;
+        std::vector<std::string> messages;
+        for (size_t i = 0; i < unixTimes.size(); ++i) {
+            int nanoseconds = static_cast<int>(i * 7919 % 1000) * 1000000;
+            size_t length = writeRFC3339(buffer, sizeof(buffer), unixTimes[i], nanoseconds);
+            rfc3339.emplace_back(buffer, length);
+            length = writeEpochNumber(buffer, sizeof(buffer), unixTimes[i], nanoseconds);
+            epochNumbers.emplace_back(buffer, length);
+            length = writeTimestampMessage(reinterpret_cast<unsigned char*>(buffer), sizeof(buffer), unixTimes[i], nanoseconds);
+            messages.emplace_back(buffer, length);
+        }
+        auto nanosecondsOf = [](size_t i) { return static_cast<int>(i * 7919 % 1000) * 1000000; };
+        bench.run("serialize", "datepp writeRFC3339", [&](size_t i) {
+            return static_cast<long long>(writeRFC3339(buffer, sizeof(buffer), unixTimes[i], nanosecondsOf(i)));
+        }, true);
+        bench.run("serialize", "datepp writeEpochNumber", [&](size_t i) {
+            return static_cast<long long>(writeEpochNumber(buffer, sizeof(buffer), unixTimes[i], nanosecondsOf(i)));
+        }, true);
+        bench.run("serialize", "datepp writeTimestampMessage", [&](size_t i) {
+            return static_cast<long long>(writeTimestampMessage(reinterpret_cast<unsigned char*>(buffer), sizeof(buffer), unixTimes[i], nanosecondsOf(i)));
+        }, true);
+        bench.run("serialize", "datepp parseRFC3339", [&](size_t i) {
+            long long seconds;
+            int nanoseconds;
+            return parseRFC3339(rfc3339[i].data(), rfc3339[i].size(), seconds, nanoseconds) ? static_cast<long long>(rfc3339[i].size()) : 0LL;
+        }, true);
+        bench.run("serialize", "datepp parseEpochNumber", [&](size_t i) {
+            long long seconds;
+            int nanoseconds;
+            return parseEpochNumber(epochNumbers[i].data(), epochNumbers[i].size(), seconds, nanoseconds) ? static_cast<long long>(epochNumbers[i].size()) : 0LL;
+        }, true);
+        bench.run("serialize", "datepp parseTimestampMessage", [&](size_t i) {
+            long long seconds;
+            int nanoseconds;
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(messages[i].data());
+            return parseTimestampMessage(data, messages[i].size(), seconds, nanoseconds) ? static_cast<long long>(messages[i].size()) : 0LL;
+        }, true);
+        bench.run("serialize", "libc strftime (RFC 3339, seconds)", [&](size_t i) {
+            return static_cast<long long>(std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &input.tms[i]));
+        }, true);
+
+        // text -> epoch
+        bench.run("parse", "datepp parseFormatted", [&](size_t i) {
+            long long out = 0;
+            parseFormatted(input.formatted[i].data(), input.formatted[i].size(), format, out);
+            return out;
+        });
+        bench.run("parse", "datepp parseISO8601", [&](size_t i) {
+            long long out = 0;
+            parseISO8601(input.iso[i].data(), input.iso[i].size(), out);
+            return out;
+        });
+        bench.run("parse", "datepp DateTime(std::string)", [&](size_t i) {
+            return DateTime(input.unixStrings[i]).unixTime();
+        });
+        bench.run("parse", "libc strptime + timegm", [&](size_t i) {
+            std::tm tm{};
+            if (strptime(input.iso[i].c_str(), "%Y-%m-%dT%H:%M:%SZ", &tm) == nullptr)
+                return 0LL;
+            return static_cast<long long>(timegm(&tm));
+        });
+    }
+
+    benchTimers(bench, options);
+    benchClock(bench, options);
+    benchIds(bench, options, zone);
+    return 0;
+}
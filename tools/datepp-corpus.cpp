@@ -0,0 +1,262 @@
+/*
+ * datepp-corpus: generates reproducible timestamp corpora for benchmarks.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 tools/datepp-corpus.cpp -o datepp-corpus
+ *
+ * Usage:
+ *     datepp-corpus [-k kind] [-n count] [-s seed] [-y from:to] [-r rate] [-J jitter] [-Z skew] [-p far-past]
+ *                   [-f format] [-z offset] [-m] [-o file]
+ *
+ *     -k  Kind of corpus (default: sorted):
+ *             uniform   uniformly distributed over the years
+ *             sorted    increasing stream with exponential gaps (`rate` events per second on average), like a log
+ *             jitter    sorted stream where every timestamp is moved by up to `jitter` seconds, like merged logs
+ *             zipf      days picked with Zipf's law (the last day is the most frequent one), uniform seconds in the day
+ *             negative  uniformly distributed over 1900-1970
+ *     -n  Number of timestamps (default: 1000000)
+ *     -s  Seed (default: 1)
+ *     -y  Range of years, inclusive (default: 2020:2024)
+ *     -r  Average events per second of sorted streams (default: 100)
+ *     -J  Maximum jitter in seconds (default: 5)
+ *     -Z  Exponent of the Zipf distribution (default: 1.1)
+ *     -p  Fraction of timestamps replaced with far-past ones from the whole `year_t` range (default: 0)
+ *     -f  Write dates in this DateTimeFormat pattern instead of unix timestamps
+ *     -z  UTC offset in hours for -f (default: 0)
+ *     -m  Write unix timestamps in milliseconds
+ *     -o  Output file (default: stdout)
+ *
+ * One timestamp is written per line. The random numbers come from splitmix64 and are mapped to
+ * distributions by this program (not by <random>, whose distributions differ between standard libraries),
+ * so the same options give the same corpus whichever standard library the tool is built with.
+ *
+ * Unix timestamp corpora can be passed to `datepp-bench -i` and `datepp-rewrite`.
+ */
+
+#include "../datepp.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    using namespace beliumgl;
+
+    enum class Kind { Uniform, Sorted, Jitter, Zipf, Negative };
+
+    struct Options {
+        Kind kind = Kind::Sorted;
+        size_t count = 1000000;
+        unsigned long long seed = 1;
+        long long firstYear = 2020;
+        long long lastYear = 2024;
+        double rate = 100.0;
+        long long jitter = 5;
+        double skew = 1.1;
+        double farPast = 0.0;
+        std::string format;
+        timezone_offset_t timezoneOffset = 0.0;
+        bool milliseconds = false;
+        const char* output = nullptr;
+    };
+
+    [[noreturn]] void usage() {
+        std::cerr << "Usage: datepp-corpus [-k uniform|sorted|jitter|zipf|negative] [-n count] [-s seed] [-y from:to] [-r rate]\n"
+                     "                     [-J jitter] [-Z skew] [-p far-past] [-f format] [-z offset] [-m] [-o file]\n";
+        std::exit(2);
+    }
+
+    Kind parseKind(const std::string& name) {
+        if (name == "uniform") return Kind::Uniform;
+        if (name == "sorted") return Kind::Sorted;
+        if (name == "jitter") return Kind::Jitter;
+        if (name == "zipf") return Kind::Zipf;
+        if (name == "negative") return Kind::Negative;
+        usage();
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "k:n:s:y:r:J:Z:p:f:z:mo:h")) != -1) {
+            switch (option) {
+                case 'k': options.kind = parseKind(optarg); break;
+                case 'n': options.count = std::strtoul(optarg, nullptr, 10); break;
+                case 's': options.seed = std::strtoull(optarg, nullptr, 10); break;
+                case 'y': {
+                    char* end;
+                    options.firstYear = std::strtoll(optarg, &end, 10);
+                    if (*end != ':')
+                        usage();
+                    options.lastYear = std::strtoll(end + 1, nullptr, 10);
+                    break;
+                }
+                case 'r': options.rate = std::strtod(optarg, nullptr); break;
+                case 'J': options.jitter = std::strtoll(optarg, nullptr, 10); break;
+                case 'Z': options.skew = std::strtod(optarg, nullptr); break;
+                case 'p': options.farPast = std::strtod(optarg, nullptr); break;
+                case 'f': options.format = optarg; break;
+                case 'z': options.timezoneOffset = std::strtod(optarg, nullptr); break;
+                case 'm': options.milliseconds = true; break;
+                case 'o': options.output = optarg; break;
+                default: usage();
+            }
+        }
+        if (optind != argc || options.firstYear > options.lastYear || options.rate <= 0 || options.jitter < 0
+            || options.skew <= 0 || options.farPast < 0 || options.farPast > 1
+            || options.firstYear < std::numeric_limits<year_t>::min() || options.lastYear > std::numeric_limits<year_t>::max())
+            usage();
+        return options;
+    }
+
+    /*
+     * ------
+     * RANDOM
+     * ------
+     */
+    class Random {
+    public:
+        explicit Random(unsigned long long seed) : state(seed) {}
+
+        // splitmix64
+        unsigned long long next() {
+            unsigned long long x = (this->state += 0x9E3779B97F4A7C15ULL);
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+
+        // [0, 1) with 53 random bits.
+        double real() {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // [first, last]
+        long long between(long long first, long long last) {
+            unsigned long long range = static_cast<unsigned long long>(last - first) + 1;
+            return range == 0 ? static_cast<long long>(next()) : first + static_cast<long long>(next() % range);
+        }
+    private:
+        unsigned long long state;
+    };
+
+    /*
+     * ----------
+     * GENERATORS
+     * ----------
+     */
+    class Generator {
+    public:
+        explicit Generator(const Options& options)
+        : options(options), random(options.seed),
+        first(daysFromCivil(options.firstYear, 0, 0) * 86400),
+        last(daysFromCivil(options.lastYear + 1, 0, 0) * 86400 - 1),
+        current(first) {
+            if (options.kind == Kind::Zipf)
+                buildZipf();
+        }
+
+        long long next() {
+            long long _unix = generate();
+            if (this->options.farPast > 0 && this->random.real() < this->options.farPast)
+                _unix = this->random.between(daysFromCivil(std::numeric_limits<year_t>::min(), 0, 0) * 86400, this->first - 1);
+            return _unix;
+        }
+    private:
+        const Options& options;
+        Random random;
+        long long first, last, current;
+        double fraction = 0.0; // Of a second, carried between the gaps of sorted streams
+        std::vector<double> zipfCdf; // Cumulative weights of the days, the most frequent one first
+
+        long long generate() {
+            switch (this->options.kind) {
+                case Kind::Uniform:
+                    return this->random.between(this->first, this->last);
+                case Kind::Sorted:
+                    return nextSorted();
+                case Kind::Jitter:
+                    return nextSorted() + this->random.between(-this->options.jitter, this->options.jitter);
+                case Kind::Zipf: {
+                    double u = this->random.real() * this->zipfCdf.back();
+                    long long rank = std::upper_bound(this->zipfCdf.begin(), this->zipfCdf.end(), u) - this->zipfCdf.begin();
+                    long long lastDay = floorDiv(this->last, 86400);
+                    return (lastDay - rank) * 86400 + this->random.between(0, 86399);
+                }
+                case Kind::Negative:
+                    return this->random.between(-2208988800LL, -1);
+            }
+            return 0;
+        }
+
+        // Exponential gaps, so the stream has quiet seconds and bursts of events in the same second.
+        long long nextSorted() {
+            double gap = -std::log(1.0 - this->random.real()) / this->options.rate;
+            this->fraction += gap;
+            long long whole = static_cast<long long>(this->fraction);
+            this->fraction -= static_cast<double>(whole);
+            this->current += whole;
+            return this->current;
+        }
+
+        void buildZipf() {
+            long long days = floorDiv(this->last, 86400) - floorDiv(this->first, 86400) + 1;
+            double total = 0.0;
+            for (long long k = 1; k <= days; ++k) {
+                total += 1.0 / std::pow(static_cast<double>(k), this->options.skew);
+                this->zipfCdf.push_back(total);
+            }
+        }
+    };
+
+    bool writeAll(std::FILE* file, const char* data, size_t size) {
+        return std::fwrite(data, 1, size, file) == size;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
+    try {
+        const bool formatted = !options.format.empty();
+        DateTimeFormat format(formatted ? options.format : std::string("W, DD/MM/YY, HH:II:SS O UTC"));
+
+        std::FILE* file = options.output == nullptr ? stdout : std::fopen(options.output, "wb");
+        if (file == nullptr) {
+            std::cerr << "datepp-corpus: can't open " << options.output << "\n";
+            return 1;
+        }
+
+        Generator generator(options);
+        std::string out;
+        char buffer[256];
+        for (size_t i = 0; i < options.count; ++i) {
+            long long _unix = generator.next();
+            if (formatted) {
+                size_t length = formatTo(buffer, sizeof(buffer), decompose(_unix, options.timezoneOffset), format);
+                out.append(buffer, std::min(length, sizeof(buffer) - 1));
+            } else {
+                int length = std::snprintf(buffer, sizeof(buffer), "%lld", options.milliseconds ? _unix * 1000 : _unix);
+                out.append(buffer, static_cast<size_t>(length));
+            }
+            out.push_back('\n');
+
+            if (out.size() >= (1 << 20)) {
+                if (!writeAll(file, out.data(), out.size()))
+                    throw std::runtime_error("Failed to write the output.");
+                out.clear();
+            }
+        }
+        if (!writeAll(file, out.data(), out.size()) || std::fflush(file) != 0)
+            throw std::runtime_error("Failed to write the output.");
+        if (file != stdout)
+            std::fclose(file);
+    } catch (const std::exception& e) {
+        std::cerr << "datepp-corpus: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * datepp-rewrite: replaces unix timestamps in log files with formatted dates.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 -pthread tools/datepp-rewrite.cpp -o datepp-rewrite
+ *
+ * Usage:
+ *     datepp-rewrite [-c column] [-d delimiter] [-e regex] [-f format] [-z offset] [-m] [-j threads] [file]
+ *
+ *     -c  Column with the timestamp, counted from 1 (default: 1)
+ *     -d  Column delimiter; ' ' splits on runs of spaces and tabs (default: ' ')
+ *     -e  Find the timestamp with a regular expression instead; its first group (or the whole match) is replaced
+ *     -f  DateTimeFormat pattern (default: "W, DD/MM/YY, HH:II:SS O UTC")
+ *     -z  UTC offset in hours (default: 0)
+ *     -m  Timestamps are in milliseconds
+ *     -j  Number of threads (default: all cores)
+ *
+ * The input (a file, or stdin if none is given) is memory-mapped when possible and split into chunks
+ * at line boundaries. Chunks are rewritten by a pool of threads started once for the whole run,
+ * and written out in their original order.
+ */
+
+#include "../datepp.hpp"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <regex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    struct Options {
+        size_t column = 1;
+        char delimiter = ' ';
+        std::string regex;
+        std::string format = "W, DD/MM/YY, HH:II:SS O UTC";
+        timezone_offset_t timezoneOffset = 0.0;
+        bool milliseconds = false;
+        size_t threads = 0;
+        const char* path = nullptr;
+    };
+
+    constexpr size_t chunkSize = 4 << 20;
+
+    [[noreturn]] void usage() {
+        std::cerr << "Usage: datepp-rewrite [-c column] [-d delimiter] [-e regex] [-f format] [-z offset] [-m] [-j threads] [file]\n";
+        std::exit(2);
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "c:d:e:f:z:mj:h")) != -1) {
+            switch (option) {
+                case 'c':
+                    options.column = std::strtoul(optarg, nullptr, 10);
+                    if (options.column < 1) // Columns are counted from 1
+                        usage();
+                    break;
+                case 'd': options.delimiter = optarg[0] == '\\' && optarg[1] == 't' ? '\t' : optarg[0]; break;
+                case 'e': options.regex = optarg; break;
+                case 'f': options.format = optarg; break;
+                case 'z': options.timezoneOffset = std::strtod(optarg, nullptr); break;
+                case 'm': options.milliseconds = true; break;
+                case 'j': options.threads = std::strtoul(optarg, nullptr, 10); break;
+                default: usage();
+            }
+        }
+        if (optind + 1 < argc)
+            usage();
+        if (optind < argc)
+            options.path = argv[optind];
+        if (options.threads == 0)
+            options.threads = std::max(1u, std::thread::hardware_concurrency());
+        return options;
+    }
+
+    // Rewrites one chunk of complete lines; every thread has its own instance.
+    class Worker {
+    public:
+        Worker(const Options& options, const beliumgl::DateTimeFormat& format)
+        : rewriter(format, options.column, options.delimiter, options.timezoneOffset, options.milliseconds),
+        useRegex(!options.regex.empty()) {
+            if (this->useRegex)
+                this->regex = std::regex(options.regex);
+        }
+
+        void run(const char* begin, const char* end, std::string& out) {
+            out.clear();
+            if (!this->useRegex) {
+                this->rewriter.rewrite(begin, end, out);
+                return;
+            }
+
+            while (begin != end) {
+                const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+                if (lineEnd == nullptr) lineEnd = end;
+
+                std::cmatch match;
+                if (std::regex_search(begin, lineEnd, match, this->regex)) {
+                    size_t group = match.size() > 1 && match[1].matched ? 1 : 0;
+                    out.append(begin, match[group].first);
+                    this->rewriter.rewriteField(match[group].first, match[group].second, out);
+                    out.append(match[group].second, lineEnd);
+                } else {
+                    out.append(begin, lineEnd);
+                }
+
+                if (lineEnd != end) {
+                    out.push_back('\n');
+                    ++lineEnd;
+                }
+                begin = lineEnd;
+            }
+        }
+    private:
+        beliumgl::EpochRewriter rewriter;
+        bool useRegex;
+        std::regex regex;
+    };
+
+    /*
+     * One thread per worker but the first, kept for the whole run. `round` gives chunk i to worker i
+     * (the calling thread runs worker 0) and returns when all of them are done.
+     */
+    class Pool {
+    public:
+        using Chunks = std::vector<std::pair<const char*, const char*>>;
+
+        Pool(std::vector<Worker>& workers, std::vector<std::string>& outputs) : workers(workers), outputs(outputs) {
+            for (size_t i = 1; i < workers.size(); ++i)
+                this->threads.emplace_back([this, i]() { this->loop(i); });
+        }
+
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->stopping = true;
+            }
+            this->started.notify_all();
+            for (std::thread& thread : this->threads)
+                thread.join();
+        }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        size_t size() const { return this->workers.size(); }
+
+        void round(const Chunks& chunks) {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->chunks = &chunks;
+                this->pending = chunks.size() - 1;
+                ++this->generation;
+            }
+            this->started.notify_all();
+            this->workers[0].run(chunks[0].first, chunks[0].second, this->outputs[0]);
+
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->finished.wait(lock, [this]() { return this->pending == 0; });
+        }
+    private:
+        std::vector<Worker>& workers;
+        std::vector<std::string>& outputs;
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable started, finished;
+        const Chunks* chunks = nullptr;
+        size_t pending = 0;
+        unsigned long long generation = 0;
+        bool stopping = false;
+
+        void loop(size_t index) {
+            unsigned long long seen = 0;
+            while (true) {
+                const Chunks* current;
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->started.wait(lock, [&]() { return this->stopping || this->generation != seen; });
+                    if (this->stopping)
+                        return;
+                    seen = this->generation;
+                    current = this->chunks;
+                }
+                // Rounds with fewer chunks than workers leave the rest idle.
+                if (index >= current->size())
+                    continue;
+
+                this->workers[index].run((*current)[index].first, (*current)[index].second, this->outputs[index]);
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (--this->pending == 0)
+                    this->finished.notify_one();
+            }
+        }
+    };
+
+    // End of the chunk starting at `begin`: `chunkSize` bytes, extended to the end of the line.
+    const char* chunkEnd(const char* begin, const char* end) {
+        if (static_cast<size_t>(end - begin) <= chunkSize)
+            return end;
+        const char* newline = static_cast<const char*>(std::memchr(begin + chunkSize, '\n', static_cast<size_t>(end - begin) - chunkSize));
+        return newline == nullptr ? end : newline + 1;
+    }
+
+    bool writeAll(const std::string& data) {
+        const char* p = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+            ssize_t written = write(STDOUT_FILENO, p, left);
+            if (written < 0)
+                return false;
+            p += written;
+            left -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    /*
+     * Processes [begin, end) in rounds of one chunk per thread and writes the results in order.
+     * Returns the position after the last complete line that was processed.
+     */
+    const char* process(const char* begin, const char* end, bool final, Pool& pool, std::vector<std::string>& outputs) {
+        while (begin != end) {
+            Pool::Chunks chunks;
+            for (size_t i = 0; i < pool.size() && begin != end; ++i) {
+                const char* stop = chunkEnd(begin, end);
+                if (stop == end && !final) {
+                    // Keep the incomplete last line for the next read.
+                    const char* lastNewline = begin;
+                    for (const char* p = end; p != begin; --p) {
+                        if (p[-1] == '\n') {
+                            lastNewline = p;
+                            break;
+                        }
+                    }
+                    stop = lastNewline;
+                    if (stop == begin)
+                        break;
+                }
+                chunks.emplace_back(begin, stop);
+                begin = stop;
+            }
+            if (chunks.empty())
+                break;
+
+            pool.round(chunks);
+            for (size_t i = 0; i < chunks.size(); ++i)
+                if (!writeAll(outputs[i]))
+                    throw std::runtime_error("Failed to write the output.");
+        }
+        return begin;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
+    try {
+        beliumgl::DateTimeFormat format(options.format);
+        std::vector<Worker> workers;
+        for (size_t i = 0; i < options.threads; ++i)
+            workers.emplace_back(options, format);
+        std::vector<std::string> outputs(options.threads);
+        Pool pool(workers, outputs);
+
+        int fd = STDIN_FILENO;
+        if (options.path != nullptr && (fd = open(options.path, O_RDONLY)) < 0) {
+            std::cerr << "datepp-rewrite: can't open " << options.path << "\n";
+            return 1;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                const char* begin = static_cast<const char*>(data);
+                process(begin, begin + info.st_size, true, pool, outputs);
+                munmap(data, static_cast<size_t>(info.st_size));
+                return 0;
+            }
+        }
+
+        // Pipes and other inputs that can't be mapped are read in large blocks.
+        std::vector<char> buffer(chunkSize * options.threads + chunkSize);
+        size_t filled = 0;
+        while (true) {
+            ssize_t count = read(fd, buffer.data() + filled, buffer.size() - filled);
+            if (count < 0) {
+                std::cerr << "datepp-rewrite: read error\n";
+                return 1;
+            }
+            filled += static_cast<size_t>(count);
+            bool final = count == 0;
+            if (!final && filled < buffer.size())
+                continue;
+
+            const char* begin = buffer.data();
+            const char* rest = process(begin, begin + filled, final, pool, outputs);
+            if (final)
+                break;
+
+            filled = static_cast<size_t>(begin + filled - rest);
+            std::memmove(buffer.data(), rest, filled);
+            if (filled == buffer.size())
+                buffer.resize(buffer.size() * 2); // A single line longer than the buffer
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "datepp-rewrite: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
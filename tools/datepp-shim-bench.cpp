@@ -0,0 +1,225 @@
+/*
+ * datepp-shim-bench: measures what LD_PRELOAD of the libc shim gains an unmodified program.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 tools/datepp-shim-bench.cpp -o datepp-shim-bench -ldl
+ *
+ * Usage:
+ *     datepp-shim-bench [-n iterations] path/to/libdatepp_shim.so
+ *
+ *     -n  Calls per benchmark (default: 1000000)
+ *
+ * The program doesn't include datepp: it only calls libc's gmtime_r, timegm and strftime, like any
+ * legacy caller would. It runs itself twice, once plainly and once with LD_PRELOAD set to the shim,
+ * and prints ns/op of both runs side by side. A warning is printed if the preloaded run didn't
+ * actually resolve the functions to the shim (e.g. because the path is wrong).
+ */
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    struct Options {
+        unsigned long iterations = 1000000;
+        const char* shim = nullptr;
+        bool child = false;
+    };
+
+    struct Run {
+        bool interposed = false;
+        std::vector<std::string> names;
+        std::map<std::string, double> nsPerOp;
+    };
+
+    [[noreturn]] void usage() {
+        std::fprintf(stderr, "Usage: datepp-shim-bench [-n iterations] path/to/libdatepp_shim.so\n");
+        std::exit(2);
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "n:ch")) != -1) {
+            switch (option) {
+                case 'n': options.iterations = std::strtoul(optarg, nullptr, 10); break;
+                case 'c': options.child = true; break;
+                default: usage();
+            }
+        }
+        if (!options.child) {
+            if (optind + 1 != argc)
+                usage();
+            options.shim = argv[optind];
+        }
+        if (options.iterations == 0)
+            usage();
+        return options;
+    }
+
+    /*
+     * -----
+     * CHILD
+     * -----
+     */
+
+    // Timestamps between 1970 and 2038, from a fixed LCG so both runs see the same ones.
+    std::vector<time_t> makeTimes(size_t count) {
+        std::vector<time_t> times(count);
+        unsigned long long state = 1;
+        for (auto& t : times) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            t = static_cast<time_t>((state >> 33) % 2147483648ULL);
+        }
+        return times;
+    }
+
+    template <typename F>
+    void measure(const char* name, unsigned long iterations, F body) {
+        auto start = std::chrono::steady_clock::now();
+        unsigned long long sink = 0;
+        for (unsigned long i = 0; i < iterations; ++i)
+            sink += body(i);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        std::printf("%s\t%.2f\t%llu\n", name, ns / static_cast<double>(iterations), sink);
+    }
+
+    int runChild(const Options& options) {
+        // The first definition in the lookup order is the shim's only if the preload worked.
+        void* libc = dlopen("libc.so.6", RTLD_NOW | RTLD_NOLOAD);
+        void* ours = dlsym(RTLD_DEFAULT, "strftime");
+        std::printf("interposed\t%d\n", libc != nullptr && ours != dlsym(libc, "strftime"));
+
+        const size_t count = 4096;
+        std::vector<time_t> times = makeTimes(count);
+        std::vector<struct tm> tms(count);
+        for (size_t i = 0; i < count; ++i)
+            gmtime_r(&times[i], &tms[i]);
+        char buffer[128];
+
+        measure("gmtime_r", options.iterations, [&](unsigned long i) {
+            struct tm tm;
+            gmtime_r(&times[i % count], &tm);
+            return static_cast<unsigned long long>(tm.tm_mday);
+        });
+        measure("timegm", options.iterations, [&](unsigned long i) {
+            struct tm tm = tms[i % count];
+            return static_cast<unsigned long long>(timegm(&tm));
+        });
+        measure("strftime %Y-%m-%d %H:%M:%S", options.iterations, [&](unsigned long i) {
+            return static_cast<unsigned long long>(std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tms[i % count]));
+        });
+        measure("strftime %FT%T%z", options.iterations, [&](unsigned long i) {
+            return static_cast<unsigned long long>(std::strftime(buffer, sizeof(buffer), "%FT%T%z", &tms[i % count]));
+        });
+        measure("strftime %c (forwarded)", options.iterations, [&](unsigned long i) {
+            return static_cast<unsigned long long>(std::strftime(buffer, sizeof(buffer), "%c", &tms[i % count]));
+        });
+        return 0;
+    }
+
+    /*
+     * ------
+     * PARENT
+     * ------
+     */
+
+    bool runSelf(const Options& options, const char* preload, Run& run) {
+        int fds[2];
+        if (pipe(fds) != 0)
+            return false;
+
+        std::string iterations = std::to_string(options.iterations);
+        pid_t pid = fork();
+        if (pid < 0)
+            return false;
+        if (pid == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+            if (preload != nullptr)
+                setenv("LD_PRELOAD", preload, 1);
+            else
+                unsetenv("LD_PRELOAD");
+            char* const args[] = {
+                const_cast<char*>("datepp-shim-bench"), const_cast<char*>("-c"),
+                const_cast<char*>("-n"), const_cast<char*>(iterations.c_str()), nullptr
+            };
+            execv("/proc/self/exe", args);
+            _exit(127);
+        }
+
+        close(fds[1]);
+        std::string output;
+        char chunk[4096];
+        ssize_t read;
+        while ((read = ::read(fds[0], chunk, sizeof(chunk))) > 0)
+            output.append(chunk, static_cast<size_t>(read));
+        close(fds[0]);
+
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            return false;
+
+        size_t begin = 0;
+        while (begin < output.size()) {
+            size_t end = output.find('\n', begin);
+            if (end == std::string::npos)
+                end = output.size();
+            std::string line = output.substr(begin, end - begin);
+            begin = end + 1;
+
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos)
+                continue;
+            std::string name = line.substr(0, tab);
+            double value = std::strtod(line.c_str() + tab + 1, nullptr);
+            if (name == "interposed") {
+                run.interposed = value != 0.0;
+            } else {
+                run.names.push_back(name);
+                run.nsPerOp[name] = value;
+            }
+        }
+        return true;
+    }
+
+    int runParent(const Options& options) {
+        char shim[PATH_MAX];
+        if (realpath(options.shim, shim) == nullptr) {
+            std::perror(options.shim);
+            return 2;
+        }
+
+        Run libc, preloaded;
+        if (!runSelf(options, nullptr, libc) || !runSelf(options, shim, preloaded)) {
+            std::fprintf(stderr, "datepp-shim-bench: a benchmark run failed\n");
+            return 1;
+        }
+        if (!preloaded.interposed)
+            std::fprintf(stderr, "datepp-shim-bench: warning: %s was not interposed, both runs measured libc\n", shim);
+
+        std::printf("%-30s %12s %12s %8s\n", "benchmark", "libc ns/op", "shim ns/op", "speedup");
+        for (const auto& name : libc.names) {
+            double before = libc.nsPerOp[name];
+            double after = preloaded.nsPerOp[name];
+            std::printf("%-30s %12.2f %12.2f %7.2fx\n", name.c_str(), before, after, after > 0.0 ? before / after : 0.0);
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    return options.child ? runChild(options) : runParent(options);
+}
@@ -0,0 +1,325 @@
+/*
+ * datepp-verify: checks the conversion kernels against slow reference implementations and libc.
+ *
+ * Build:
+ *     g++ -std=c++11 -O2 -pthread tools/datepp-verify.cpp -o datepp-verify
+ *
+ * Usage:
+ *     datepp-verify [-y from:to] [-n samples] [-s seed] [-j threads]
+ *
+ *     -y  Range of years to check, inclusive (default: -32768:32767, the full `year_t` range)
+ *     -n  Random seconds checked per day (default: 1)
+ *     -s  Seed for the random seconds (default: 1)
+ *     -j  Number of threads (default: all cores)
+ *
+ * Every day of the range is visited by walking the calendar one day at a time (so the reference
+ * needs nothing but month lengths), and compared with:
+ *
+ *     - civilFromDays, daysFromCivil, weekdayFromDays and daysInMonth,
+ *     - decompose and the DateTime constructors at random seconds of the day, in several UTC offsets,
+ *     - gmtime_r (for UTC),
+ *     - formatTo against a copy of the original `std::string` based formatter, cycling through several formats,
+ *     - parseFormatted, which has to read back what formatTo wrote.
+ *
+ * The random seconds depend only on the seed and the day, so a run can be repeated with any number of threads.
+ * Prints the first mismatches and exits with 1 if there were any.
+ */
+
+#include "../datepp.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    using namespace beliumgl;
+
+    struct Options {
+        long long firstYear = -32768;
+        long long lastYear = 32767;
+        unsigned samples = 1;
+        unsigned long long seed = 1;
+        size_t threads = 0;
+    };
+
+    const timezone_offset_t offsets[] = {0.0, 1.0, -1.0, 5.5, -3.5, 9.75, 14.0, -12.0};
+    const char* const patterns[] = {
+        "W, DD/MM/YY, HH:II:SS O UTC",
+        "WW, AA DD YY HH:II:SS _ O",
+        "YY-MM-DD HH:II:SS",
+        "D.M.Y H:I:S _ O",
+        "W A D Y"
+    };
+    constexpr size_t maxReports = 20;
+
+    [[noreturn]] void usage() {
+        std::cerr << "Usage: datepp-verify [-y from:to] [-n samples] [-s seed] [-j threads]\n";
+        std::exit(2);
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        int option;
+        while ((option = getopt(argc, argv, "y:n:s:j:h")) != -1) {
+            switch (option) {
+                case 'y': {
+                    char* end;
+                    options.firstYear = std::strtoll(optarg, &end, 10);
+                    if (*end != ':')
+                        usage();
+                    options.lastYear = std::strtoll(end + 1, nullptr, 10);
+                    break;
+                }
+                case 'n': options.samples = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+                case 's': options.seed = std::strtoull(optarg, nullptr, 10); break;
+                case 'j': options.threads = std::strtoul(optarg, nullptr, 10); break;
+                default: usage();
+            }
+        }
+        if (optind != argc || options.firstYear > options.lastYear
+            || options.firstYear < std::numeric_limits<year_t>::min() || options.lastYear > std::numeric_limits<year_t>::max())
+            usage();
+        if (options.threads == 0)
+            options.threads = std::max(1u, std::thread::hardware_concurrency());
+        return options;
+    }
+
+    // splitmix64, so the samples of a day don't depend on which thread checks it.
+    unsigned long long mix(unsigned long long x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /*
+     * ---------
+     * REFERENCE
+     * ---------
+     */
+    bool refIsLeapYear(long long year) {
+        return year % 400 == 0 || (year % 100 != 0 && year % 4 == 0);
+    }
+
+    int refDaysInMonth(long long year, int month) {
+        switch (month) {
+            case 1: return refIsLeapYear(year) ? 29 : 28;
+            case 3: case 5: case 8: case 10: return 30;
+            default: return 31;
+        }
+    }
+
+    // Days from 01.01.1970 to 01.01 of `year`, one year at a time.
+    long long refDaysBeforeYear(long long year) {
+        long long days = 0;
+        for (long long y = 1970; y < year; ++y) days += refIsLeapYear(y) ? 366 : 365;
+        for (long long y = year; y < 1970; ++y) days -= refIsLeapYear(y) ? 366 : 365;
+        return days;
+    }
+
+    // The formatter DateTime::toString had before formatTo, built from `std::string`s.
+    template<typename T>
+    std::string refPadZeros(T num) {
+        if (num >= 0)
+            return (num < 10 ? "0" : "") + std::to_string(static_cast<T>(num));
+        else
+            return (num > -10 ? "-0" : "") + std::to_string(static_cast<T>(num * -1));
+    }
+
+    std::string refFormat(const CivilTime& time, const DateTimeFormat& format) {
+        const char* const dotwNames[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+        const char* const monthNames[] = {"January", "February", "March", "April", "May", "June",
+                                          "July", "August", "September", "October", "November", "December"};
+        auto number = [&](int num) { return format.getFillZeros() ? refPadZeros(num) : std::to_string(num); };
+        auto name = [&](const char* str) { return format.getFullNames() ? std::string(str) : std::string(str).substr(0, 3); };
+        std::string result;
+
+        if (format.getShowDotw())
+            result += name(dotwNames[time.dotw]) + ", ";
+
+        for (char token : format.getOrder()) {
+            switch (token) {
+                case 'd': result += number(time.day + 1); break;
+                case 'm': result += number(time.month + 1); break;
+                case 'a': result += name(monthNames[time.month]); break;
+                case 'y': result += std::to_string(static_cast<year_t>(time.year)); break;
+            }
+            result += format.getDelimiter();
+        }
+        result[result.length() - 1] = ' ';
+
+        if (format.getShowTime()) {
+            int hours12 = time.hour % 12;
+            if (hours12 == 0) hours12 = 12;
+
+            result += number(format.get12HourFormat() ? hours12 : time.hour) + ":";
+            result += number(time.minute) + ":";
+            result += number(time.second) + " ";
+            if (format.get12HourFormat())
+                result += time.hour < 12 ? "AM " : "PM ";
+        }
+
+        if (format.getShowUTCoffset()) {
+            result += time.timezoneOffset >= 0 ? "+" : "";
+            result += (format.getFillZeros() ? refPadZeros(time.timezoneOffset) : std::to_string(time.timezoneOffset)) + " UTC";
+        }
+        return result;
+    }
+
+    /*
+     * -------
+     * CHECKER
+     * -------
+     */
+    struct Results {
+        std::atomic<unsigned long long> days{0};
+        std::atomic<unsigned long long> samples{0};
+        std::atomic<unsigned long long> mismatches{0};
+        std::mutex reportMutex;
+        size_t reported = 0;
+
+        void report(long long _unix, const char* what, const std::string& got, const std::string& expected) {
+            this->mismatches.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(this->reportMutex);
+            if (this->reported++ < maxReports)
+                std::cerr << "mismatch at " << _unix << " (" << what << "): got \"" << got << "\", expected \"" << expected << "\"\n";
+        }
+    };
+
+    std::string fields(long long year, int month, int day, int hour = 0, int minute = 0, int second = 0, int dotw = -1) {
+        char buffer[96];
+        std::snprintf(buffer, sizeof(buffer), "%lld-%d-%d %d:%d:%d dotw %d", year, month, day, hour, minute, second, dotw);
+        return buffer;
+    }
+
+    class Checker {
+    public:
+        Checker(const Options& options, Results& results) : options(options), results(results) {
+            for (const char* pattern : patterns)
+                this->formats.emplace_back(pattern);
+        }
+
+        // Checks every day of the years [firstYear, lastYear].
+        void run(long long firstYear, long long lastYear) {
+            long long days = refDaysBeforeYear(firstYear);
+            int dotw = static_cast<int>(((days % 7) + 7 + 4) % 7); // 01.01.1970 was a Thursday
+
+            for (long long year = firstYear; year <= lastYear; ++year) {
+                for (int month = 0; month < 12; ++month) {
+                    int monthLength = refDaysInMonth(year, month);
+                    if (daysInMonth(year, static_cast<month_t>(month)) != monthLength)
+                        this->results.report(days * 86400, "daysInMonth", std::to_string(daysInMonth(year, static_cast<month_t>(month))),
+                                             std::to_string(monthLength));
+
+                    for (int day = 0; day < monthLength; ++day) {
+                        checkDay(days, year, month, day, dotw);
+                        ++days;
+                        dotw = (dotw + 1) % 7;
+                    }
+                }
+                this->results.days.fetch_add(refIsLeapYear(year) ? 366 : 365, std::memory_order_relaxed);
+            }
+        }
+    private:
+        const Options& options;
+        Results& results;
+        std::vector<DateTimeFormat> formats;
+        char buffer[256];
+
+        void checkDay(long long days, long long year, int month, int day, int dotw) {
+            long long gotYear;
+            month_t gotMonth;
+            day_t gotDay;
+            civilFromDays(days, gotYear, gotMonth, gotDay);
+            if (gotYear != year || gotMonth != month || gotDay != day)
+                this->results.report(days * 86400, "civilFromDays", fields(gotYear, gotMonth, gotDay), fields(year, month, day));
+            if (daysFromCivil(year, static_cast<month_t>(month), static_cast<day_t>(day)) != days)
+                this->results.report(days * 86400, "daysFromCivil", std::to_string(daysFromCivil(year, static_cast<month_t>(month), static_cast<day_t>(day))),
+                                     std::to_string(days));
+            if (weekdayFromDays(days) != dotw)
+                this->results.report(days * 86400, "weekdayFromDays", std::to_string(weekdayFromDays(days)), std::to_string(dotw));
+
+            unsigned long long random = mix(this->options.seed ^ static_cast<unsigned long long>(days));
+            for (unsigned i = 0; i < this->options.samples; ++i) {
+                random = mix(random);
+                int secondsOfDay = static_cast<int>(random % 86400);
+                timezone_offset_t offset = offsets[(random >> 32) % (sizeof(offsets) / sizeof(offsets[0]))];
+                const DateTimeFormat& format = this->formats[(random >> 40) % this->formats.size()];
+                checkSample(days, year, month, day, dotw, secondsOfDay, offset, format);
+            }
+        }
+
+        void checkSample(long long days, long long year, int month, int day, int dotw, int secondsOfDay,
+                         timezone_offset_t offset, const DateTimeFormat& format) {
+            const int hour = secondsOfDay / 3600, minute = secondsOfDay % 3600 / 60, second = secondsOfDay % 60;
+            const long long _unix = days * 86400 + secondsOfDay - static_cast<long long>(offset * 3600);
+            const std::string expected = fields(year, month, day, hour, minute, second, dotw);
+            this->results.samples.fetch_add(1, std::memory_order_relaxed);
+
+            CivilTime time = decompose(_unix, offset);
+            std::string got = fields(time.year, time.month, time.day, time.hour, time.minute, time.second, time.dotw);
+            if (got != expected)
+                this->results.report(_unix, "decompose", got, expected);
+
+            DateTime dateTime(_unix, offset);
+            got = fields(dateTime.year(), dateTime.month(), dateTime.day(), dateTime.hour(), dateTime.minute(), dateTime.second(),
+                         static_cast<int>(dateTime.dotwEnum()));
+            if (got != expected)
+                this->results.report(_unix, "DateTime(long long)", got, expected);
+            if (DateTime(std::to_string(_unix), offset).toString(format) != dateTime.toString(format))
+                this->results.report(_unix, "DateTime(std::string)", DateTime(std::to_string(_unix), offset).toString(format),
+                                     dateTime.toString(format));
+
+            if (offset == 0.0) {
+                std::tm tm;
+                time_t timer = static_cast<time_t>(_unix);
+                if (gmtime_r(&timer, &tm) == nullptr)
+                    this->results.report(_unix, "gmtime_r", "failure", expected);
+                got = fields(tm.tm_year + 1900LL, tm.tm_mon, tm.tm_mday - 1, tm.tm_hour, tm.tm_min, tm.tm_sec, tm.tm_wday);
+                if (got != expected)
+                    this->results.report(_unix, "gmtime_r", expected, got); // libc is the reference here
+            }
+
+            const std::string reference = refFormat(time, format);
+            size_t length = formatTo(this->buffer, sizeof(this->buffer), time, format);
+            if (length != reference.length() || reference.compare(0, std::string::npos, this->buffer, length) != 0)
+                this->results.report(_unix, "formatTo", std::string(this->buffer, std::min(length, sizeof(this->buffer) - 1)), reference);
+
+            // With zeros filled, offsets from -10 on lose their sign ("12.000000" for -12), like they always did.
+            if (format.getShowUTCoffset() && format.getFillZeros() && offset <= -10)
+                return;
+            long long parsed = 0;
+            const long long parseExpected = format.getShowTime() ? _unix : _unix - secondsOfDay;
+            if (!parseFormatted(this->buffer, length, format, parsed, offset) || parsed != parseExpected)
+                this->results.report(_unix, "parseFormatted", std::to_string(parsed), std::to_string(parseExpected));
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    Results results;
+
+    long long years = options.lastYear - options.firstYear + 1;
+    size_t threadCount = static_cast<size_t>(std::min<long long>(static_cast<long long>(options.threads), years));
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        long long first = options.firstYear + years * static_cast<long long>(i) / static_cast<long long>(threadCount);
+        long long last = options.firstYear + years * static_cast<long long>(i + 1) / static_cast<long long>(threadCount) - 1;
+        threads.emplace_back([&options, &results, first, last]() {
+            Checker(options, results).run(first, last);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::cout << "days: " << results.days << ", samples: " << results.samples
+              << ", mismatches: " << results.mismatches << "\n";
+    return results.mismatches == 0 ? 0 : 1;
+}